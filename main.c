@@ -9,8 +9,11 @@
 
 
 #include <stdio.h>
+#include <string.h>
 
-#include "src/game.h"
+#include "src/screen.h"
+#include "src/options.h"
+#include "src/batch.h"
 
 
 /**
@@ -23,13 +26,53 @@
 int main(int argc, char *argv[]) {
     // 游戏指针
     Game *game = NULL;
+    // 命令行选项
+    Options options;
+    // 批处理输入文件
+    FILE *input;
+    // 程序运行状态码
+    int code;
+    // 行数、列数、地雷数
+    int rows, columns, mines;
+
+    // 解析命令行选项，已输出帮助信息时正常退出
+    code = ParseOptions(&options, argc, argv);
+    if (code) {
+        return code == 1 ? 0 : code;
+    }
+
+    // 批处理或安静模式：不显示界面，从文件或标准输入读取命令
+    if (options.mode != OUTPUT_MODE_INTERACTIVE) {
+        input = options.batch_file && strcmp(options.batch_file, "-") != 0 ? fopen(options.batch_file, "r") : stdin;
+        if (! input) {
+            fprintf(stderr, "无法打开批处理输入文件：%s\n", options.batch_file);
+            return 2;
+        }
+        code = RunBatch(input, stdout, &options);
+        if (input != stdin) {
+            fclose(input);
+        }
+        return code;
+    }
 
     // 创建一个游戏
     game = CreateGame();
-    // 游戏开始界面
-    GameStartScreen(game);
-    // 散布地雷
-    RandomDistributeMines(game->map);
+    // 已在命令行中指定地图大小时跳过开始界面
+    if (options.has_size) {
+        rows = options.rows;
+        columns = options.columns;
+        mines = options.mines;
+    } else {
+        GameStartScreen(&rows, &columns, &mines);
+    }
+    // 创建地图并散布地雷，若失败则退出
+    if (! StartConfiguredGame(game, &options, rows, columns, mines, options.seed)) {
+        printf(ERROR_MESSAGE_STYLE);
+        printf("地图创建失败：内存不足！\n");
+        printf(CLEAR_STYLE);
+        DestroyGame(&game);
+        return 1;
+    }
     // 游戏进行界面
     GameProcessScreen(game);
     // 游戏结束界面
@@ -0,0 +1,136 @@
+/**
+ * ----------------------------------------------------------------------------
+ * [源文件] 模拟器主程序
+ * ----------------------------------------------------------------------------
+ *
+ * 定义模拟器的主函数：用多个线程批量进行解机对局，输出胜率、每局猜测步数和速度
+ *
+ */
+
+
+#include <stdio.h>
+#include <string.h>
+
+#include "src/simulation.h"
+#include "src/game.h"
+#include "src/random.h"
+#include "src/transposition.h"
+#include "src/options.h"
+
+
+/**
+ * 输出用法说明
+ *
+ * @param file              输出文件
+ * @param program           程序名
+ */
+static void PrintSimulatorUsage(FILE *file, const char *program) {
+    fprintf(file, "用法：%s [选项]\n", program);
+    fprintf(file, "\n");
+    fprintf(file, "  -d, --difficulty 难度    low、middle、high，或编号1、2、3（默认high）\n");
+    fprintf(file, "  -r, --rows 行数\n");
+    fprintf(file, "  -c, --columns 列数\n");
+    fprintf(file, "  -m, --mines 地雷数       只指定一部分时其余取难度的值\n");
+    fprintf(file, "  -n, --games 对局数       默认10000\n");
+    fprintf(file, "  -s, --seed 种子          第一局的种子（64位无符号整数），第i局使用 种子 + i（按64位回绕），为0时自动生成（默认1）\n");
+    fprintf(file, "  -t, --threads 线程数     为0时使用全部处理器核心（默认0）\n");
+    fprintf(file, "      --cache 表项数       缓存猜测结果的置换表大小，为0时不缓存（默认%d）\n", TRANSPOSITION_DEFAULT_SIZE);
+    fprintf(file, "  -h, --help               显示本说明\n");
+}
+
+/**
+ * 主函数
+ *
+ * @param argc              参数个数
+ * @param argv              参数列表
+ * @return                  程序运行状态码
+ */
+int main(int argc, char *argv[]) {
+    // 模拟参数
+    SimulationOptions options;
+    // 模拟统计
+    SimulationResult result;
+    // 参数下标
+    int i;
+    // 选项名、选项值
+    const char *name, *value;
+    // 解析出的整数
+    long long number;
+    // 难度
+    GameDifficulty difficulty = GAME_DIFFICULTY_HIGH;
+    // 单独指定的行数、列数、地雷数，未指定时为-1
+    long long rows = -1, columns = -1, mines = -1;
+    // 选项值是否有效
+    _Bool is_valid;
+
+    options.number_of_games = 10000;
+    options.seed = 1;
+    options.threads = 0;
+    options.cache_size = TRANSPOSITION_DEFAULT_SIZE;
+
+    for (i = 1; i < argc; i++) {
+        name = argv[i];
+        if (strcmp(name, "-h") == 0 || strcmp(name, "--help") == 0) {
+            PrintSimulatorUsage(stdout, argv[0]);
+            return 0;
+        }
+        if (i + 1 >= argc) {
+            fprintf(stderr, "选项 %s 无效或缺少值！\n", name);
+            return 2;
+        }
+        value = argv[++i];
+
+        if (strcmp(name, "-d") == 0 || strcmp(name, "--difficulty") == 0) {
+            is_valid = ParseDifficulty(value, &difficulty);
+        } else if (strcmp(name, "-r") == 0 || strcmp(name, "--rows") == 0) {
+            is_valid = ParseInteger(value, 2, MAX_BLOCK_TABLE_SIZE, &rows);
+        } else if (strcmp(name, "-c") == 0 || strcmp(name, "--columns") == 0) {
+            is_valid = ParseInteger(value, 2, MAX_BLOCK_TABLE_SIZE, &columns);
+        } else if (strcmp(name, "-m") == 0 || strcmp(name, "--mines") == 0) {
+            is_valid = ParseInteger(value, 1, MAX_BLOCK_TABLE_SIZE, &mines);
+        } else if (strcmp(name, "-n") == 0 || strcmp(name, "--games") == 0) {
+            is_valid = ParseInteger(value, 1, 0xFFFFFFFFLL * SIMULATION_BATCH_SIZE, &options.number_of_games);
+        } else if (strcmp(name, "-s") == 0 || strcmp(name, "--seed") == 0) {
+            is_valid = ParseSeed(value, &options.seed);
+        } else if (strcmp(name, "-t") == 0 || strcmp(name, "--threads") == 0) {
+            is_valid = ParseInteger(value, 0, 1024, &number);
+            options.threads = (int)number;
+        } else if (strcmp(name, "--cache") == 0) {
+            is_valid = ParseInteger(value, 0, 1LL << 30, &number);
+            options.cache_size = (size_t)number;
+        } else {
+            fprintf(stderr, "未知选项：%s\n", name);
+            PrintSimulatorUsage(stderr, argv[0]);
+            return 2;
+        }
+
+        if (! is_valid) {
+            fprintf(stderr, "选项 %s 的值无效：%s\n", name, value);
+            return 2;
+        }
+    }
+
+    // 确定地图大小
+    GetDifficultySize(difficulty, &options.rows, &options.columns, &options.mines);
+    rows = rows >= 0 ? rows : options.rows;
+    columns = columns >= 0 ? columns : options.columns;
+    mines = mines >= 0 ? mines : options.mines;
+    if (! IsValidGameSize(rows, columns, mines)) {
+        fprintf(stderr, "地图大小无效：%lld行 x %lld列，%lld个地雷！\n", rows, columns, mines);
+        return 2;
+    }
+    options.rows = (int)rows;
+    options.columns = (int)columns;
+    options.mines = (int)mines;
+    if (options.seed == 0) {
+        options.seed = GenerateSeed();
+    }
+
+    if (! RunSimulation(&options, &result)) {
+        fprintf(stderr, "模拟失败：内存不足！\n");
+        return 1;
+    }
+    PrintSimulationResult(stdout, &options, &result);
+
+    return 0;
+}
@@ -0,0 +1,420 @@
+/**
+ * ----------------------------------------------------------------------------
+ * [源文件] 批处理
+ * ----------------------------------------------------------------------------
+ *
+ * 定义非交互的批处理模式的各个函数
+ *
+ * 输入按块读入缓冲区后逐字节切分记号，不经过scanf；
+ * 命令连续应用到地图上，中间不绘制界面，只按指定间隔和在结束时输出状态。
+ *
+ */
+
+
+#include <stdlib.h>
+#include <stdint.h>
+#include <limits.h>
+
+#include "batch.h"
+
+
+// 输入缓冲区的字节数
+#define BATCH_BUFFER_SIZE 65536
+
+// 结构体：记号读取器
+typedef struct {
+    // 输入文件
+    FILE *file;
+    // 缓冲区
+    char data[BATCH_BUFFER_SIZE];
+    // 缓冲区中的有效字节数
+    size_t length;
+    // 下一个字节的位置
+    size_t position;
+    // 当前行号（从1开始）
+    long long line;
+} Tokenizer;
+
+// 枚举：记号读取结果
+typedef enum {
+    // 读取成功
+    TOKEN_OK,
+    // 输入结束
+    TOKEN_END,
+    // 格式错误
+    TOKEN_MALFORMED,
+} TokenResult;
+
+/**
+ * 查看下一个字节，必要时读入下一块输入
+ *
+ * @param tokenizer         记号读取器指针
+ * @return                  下一个字节，输入结束时返回EOF
+ */
+static int PeekByte(Tokenizer *tokenizer) {
+    if (tokenizer->position == tokenizer->length) {
+        tokenizer->length = fread(tokenizer->data, 1, BATCH_BUFFER_SIZE, tokenizer->file);
+        tokenizer->position = 0;
+        if (tokenizer->length == 0) {
+            return EOF;
+        }
+    }
+
+    return (unsigned char)tokenizer->data[tokenizer->position];
+}
+
+/**
+ * 跳过空白和注释
+ *
+ * @param tokenizer         记号读取器指针
+ * @return                  下一个记号的第一个字节，输入结束时返回EOF
+ */
+static int SkipSpace(Tokenizer *tokenizer) {
+    // 当前字节
+    int byte;
+
+    for (;;) {
+        byte = PeekByte(tokenizer);
+        if (byte == '#') {
+            // 注释一直到行尾
+            do {
+                tokenizer->position++;
+                byte = PeekByte(tokenizer);
+            } while (byte != '\n' && byte != EOF);
+        }
+        if (byte == '\n') {
+            tokenizer->line++;
+        } else if (byte != ' ' && byte != '\t' && byte != '\r') {
+            return byte;
+        }
+        tokenizer->position++;
+    }
+}
+
+/**
+ * 当前记号是否已结束（后面是空白、注释或输入结束）
+ *
+ * @param tokenizer         记号读取器指针
+ * @return                  是否已结束
+ */
+static _Bool IsTokenEnd(Tokenizer *tokenizer) {
+    // 下一个字节
+    int byte = PeekByte(tokenizer);
+
+    return byte == EOF || byte == ' ' || byte == '\t' || byte == '\r' || byte == '\n' || byte == '#';
+}
+
+/**
+ * 读取一个可带正负号的十进制数
+ *
+ * @param tokenizer         记号读取器指针
+ * @param is_negative       是否为负数指针
+ * @param magnitude         绝对值指针
+ * @return                  读取结果，超出64位无符号整数范围时为格式错误
+ */
+static TokenResult ReadNumber(Tokenizer *tokenizer, _Bool *is_negative, uint64_t *magnitude) {
+    // 当前字节
+    int byte = SkipSpace(tokenizer);
+    // 数字个数
+    int digits = 0;
+
+    if (byte == EOF) {
+        return TOKEN_END;
+    }
+
+    *is_negative = byte == '-';
+    if (byte == '-' || byte == '+') {
+        tokenizer->position++;
+        byte = PeekByte(tokenizer);
+    }
+
+    *magnitude = 0;
+    while (byte >= '0' && byte <= '9') {
+        if (*magnitude > (UINT64_MAX - (uint64_t)(byte - '0')) / 10) {
+            return TOKEN_MALFORMED;
+        }
+        *magnitude = *magnitude * 10 + (uint64_t)(byte - '0');
+        digits++;
+        tokenizer->position++;
+        byte = PeekByte(tokenizer);
+    }
+
+    return digits > 0 && IsTokenEnd(tokenizer) ? TOKEN_OK : TOKEN_MALFORMED;
+}
+
+/**
+ * 读取一个整数
+ *
+ * @param tokenizer         记号读取器指针
+ * @param value             整数指针
+ * @return                  读取结果，超出long long范围时为格式错误
+ */
+static TokenResult ReadInteger(Tokenizer *tokenizer, long long *value) {
+    // 是否为负数
+    _Bool is_negative;
+    // 绝对值
+    uint64_t magnitude;
+    // 读取结果
+    TokenResult result = ReadNumber(tokenizer, &is_negative, &magnitude);
+
+    if (result != TOKEN_OK) {
+        return result;
+    }
+    if (magnitude > (uint64_t)LLONG_MAX) {
+        return TOKEN_MALFORMED;
+    }
+
+    *value = is_negative ? -(long long)magnitude : (long long)magnitude;
+    return TOKEN_OK;
+}
+
+/**
+ * 读取随机数种子
+ *
+ * @param tokenizer         记号读取器指针
+ * @param seed              随机数种子指针
+ * @return                  读取结果，负数为格式错误
+ */
+static TokenResult ReadSeed(Tokenizer *tokenizer, uint64_t *seed) {
+    // 是否为负数
+    _Bool is_negative;
+    // 读取结果
+    TokenResult result = ReadNumber(tokenizer, &is_negative, seed);
+
+    return result == TOKEN_OK && is_negative ? TOKEN_MALFORMED : result;
+}
+
+/**
+ * 读取一个方块操作指令
+ *
+ * @param tokenizer         记号读取器指针
+ * @param status            方块目标状态指针
+ * @return                  读取结果
+ */
+static TokenResult ReadDirective(Tokenizer *tokenizer, BlockStatus *status) {
+    // 当前字节
+    int byte = SkipSpace(tokenizer);
+
+    if (byte == EOF) {
+        return TOKEN_END;
+    }
+
+    if (byte == 'V' || byte == 'v') {
+        *status = BLOCK_STATUS_VISIBLE;
+    } else if (byte == 'F' || byte == 'f') {
+        *status = BLOCK_STATUS_FLAG;
+    } else if (byte == '?') {
+        *status = BLOCK_STATUS_DOUBT;
+    } else if (byte == 'C' || byte == 'c') {
+        *status = BLOCK_STATUS_INVISIBLE;
+    } else {
+        return TOKEN_MALFORMED;
+    }
+    tokenizer->position++;
+
+    return IsTokenEnd(tokenizer) ? TOKEN_OK : TOKEN_MALFORMED;
+}
+
+/**
+ * 输出当前状态
+ *
+ * @param output            输出文件
+ * @param game              游戏指针
+ * @param moves             已读取的命令数
+ * @param ignored           被忽略的命令数（坐标超出范围或方块已翻开）
+ */
+static void ReportState(FILE *output, Game *game, long long moves, long long ignored) {
+    fprintf(output, "state moves=%lld applied=%lld ignored=%lld visible=%lld invisible=%lld flags=%lld doubts=%lld result=%s\n",
+            moves, moves - ignored, ignored,
+            game->map->number_of_visible_blocks, game->map->number_of_invisible_blocks,
+            game->map->number_of_flags, game->map->number_of_doubts,
+            game->is_finished ? (game->is_winning ? "won" : "lost") : "playing");
+}
+
+/**
+ * 以纯文本输出整个地图
+ *
+ * 未翻开为#，旗标为F，疑问标为?，已翻开的空白为.，数字为1 ~ 8，地雷为*
+ *
+ * @param output            输出文件
+ * @param map               地图指针
+ */
+static void DumpBoard(FILE *output, Map *map) {
+    // 方块状态对应的字符，可见方块另行处理
+    static const char STATUS_CHARACTERS[] = { '#', 'F', '?' };
+    // 可见方块按类型对应的字符
+    static const char TYPE_CHARACTERS[] = { '.', '1', '2', '3', '4', '5', '6', '7', '8', '*' };
+    // 行下标
+    int row;
+    // 列下标
+    int column;
+    // 一行的内容
+    char *line = (char *)malloc((size_t)map->number_of_columns + 1);
+    // 方块
+    Block block;
+
+    if (! line) {
+        return;
+    }
+
+    for (row = 0; row < map->number_of_rows; row++) {
+        for (column = 0; column < map->number_of_columns; column++) {
+            block = BLOCK_AT(map, row, column);
+            line[column] = BLOCK_STATUS_OF(block) == BLOCK_STATUS_VISIBLE
+                           ? TYPE_CHARACTERS[BLOCK_TYPE_OF(block)]
+                           : STATUS_CHARACTERS[BLOCK_STATUS_OF(block)];
+        }
+        line[map->number_of_columns] = '\n';
+        fwrite(line, 1, (size_t)map->number_of_columns + 1, output);
+    }
+
+    free(line);
+}
+
+/**
+ * 读取地图参数并开始游戏
+ *
+ * 命令行选项已指定地图大小时不读取地图参数
+ *
+ * @param tokenizer         记号读取器指针
+ * @param output            输出文件
+ * @param options           命令行选项指针
+ * @param game              游戏指针
+ * @return                  程序运行状态码：0成功，1内存不足，2输入错误
+ */
+static int StartBatchGame(Tokenizer *tokenizer, FILE *output, const Options *options, Game *game) {
+    // 地图参数：行数、列数、地雷数
+    long long parameters[3];
+    // 随机数种子
+    uint64_t seed;
+    // 参数序号
+    int i;
+    // 读取结果
+    TokenResult result = TOKEN_OK;
+
+    if (options->has_size) {
+        parameters[0] = options->rows;
+        parameters[1] = options->columns;
+        parameters[2] = options->mines;
+        seed = options->seed;
+    }
+
+    for (i = 0; i < 3 && ! options->has_size && result == TOKEN_OK; i++) {
+        result = ReadInteger(tokenizer, &parameters[i]);
+    }
+    if (result == TOKEN_OK && ! options->has_size) {
+        result = ReadSeed(tokenizer, &seed);
+    }
+    if (result != TOKEN_OK) {
+        fprintf(stderr, "批处理输入第%lld行：应为“行数 列数 地雷数 随机数种子”！\n", tokenizer->line);
+        return 2;
+    }
+
+    if (! IsValidGameSize(parameters[0], parameters[1], parameters[2])) {
+        fprintf(stderr, "批处理输入第%lld行：地图参数超出范围！\n", tokenizer->line);
+        return 2;
+    }
+
+    if (! StartConfiguredGame(game, options, (int)parameters[0], (int)parameters[1], (int)parameters[2], seed)) {
+        fprintf(stderr, "批处理：地图创建失败，内存不足！\n");
+        return 1;
+    }
+
+    if (options->mode != OUTPUT_MODE_QUIET) {
+        fprintf(output, "board rows=%d columns=%d mines=%d seed=%llu\n",
+                game->map->number_of_rows, game->map->number_of_columns, game->map->number_of_mines,
+                (unsigned long long)game->map->seed);
+    }
+
+    return 0;
+}
+
+/**
+ * 执行批处理
+ *
+ * 先读取地图参数并开始游戏，再依次应用每条命令，游戏结束后忽略剩余的输入。
+ * 安静模式只在结束时输出游戏结果（won、lost或playing）。
+ *
+ * @param input             输入文件
+ * @param output            输出文件
+ * @param options           命令行选项指针，使用其中的地图参数、状态输出间隔和输出模式
+ * @return                  程序运行状态码：0成功，1内存不足，2输入错误
+ */
+int RunBatch(FILE *input, FILE *output, const Options *options) {
+    // 记号读取器
+    Tokenizer *tokenizer;
+    // 行编号、列编号
+    long long row, column;
+    // 方块目标状态
+    BlockStatus status;
+    // 读取结果
+    TokenResult result;
+    // 已读取的命令数、被忽略的命令数（坐标超出范围或方块已翻开）
+    long long moves = 0, ignored = 0;
+    // 游戏
+    Game *game;
+    // 程序运行状态码
+    int code;
+
+    tokenizer = (Tokenizer *)malloc(sizeof(Tokenizer));
+    game = CreateGame();
+    if (! tokenizer || ! game) {
+        fprintf(stderr, "批处理：内存不足！\n");
+        free(tokenizer);
+        free(game);
+        return 1;
+    }
+    tokenizer->file = input;
+    tokenizer->length = 0;
+    tokenizer->position = 0;
+    tokenizer->line = 1;
+
+    code = StartBatchGame(tokenizer, output, options, game);
+
+    // 依次应用每条命令
+    while (code == 0 && ! game->is_finished) {
+        result = ReadInteger(tokenizer, &row);
+        if (result == TOKEN_END) {
+            break;
+        }
+        if (result == TOKEN_OK) {
+            result = ReadInteger(tokenizer, &column);
+        }
+        if (result == TOKEN_OK) {
+            result = ReadDirective(tokenizer, &status);
+        }
+        if (result != TOKEN_OK) {
+            fprintf(stderr, "批处理输入第%lld行：应为“行编号 列编号 方块操作指令”！\n", tokenizer->line);
+            code = 2;
+            break;
+        }
+
+        moves++;
+        if (row < 1 || row > game->map->number_of_rows || column < 1 || column > game->map->number_of_columns
+            || ! PlayMove(game, (int)row - 1, (int)column - 1, status)) {
+            ignored++;
+        }
+
+        if (options->mode != OUTPUT_MODE_QUIET && options->report_interval > 0 && moves % options->report_interval == 0) {
+            ReportState(output, game, moves, ignored);
+        }
+    }
+
+    // 输出最终状态，输入有误时输出出错前的状态
+    if (game->map) {
+        if (options->mode == OUTPUT_MODE_QUIET) {
+            fprintf(output, "%s\n", game->is_finished ? (game->is_winning ? "won" : "lost") : "playing");
+        } else {
+            ReportState(output, game, moves, ignored);
+        }
+        if (options->is_board_dumped) {
+            DumpBoard(output, game->map);
+        }
+        DestroyMap(&game->map);
+    }
+
+    DestroyGame(&game);
+    free(tokenizer);
+
+    return code;
+}
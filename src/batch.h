@@ -0,0 +1,35 @@
+/**
+ * ----------------------------------------------------------------------------
+ * [头文件] 批处理
+ * ----------------------------------------------------------------------------
+ *
+ * 定义非交互的批处理模式的函数原型
+ *
+ * 批处理输入是由空白分隔的记号流，#到行尾为注释：
+ *
+ *     行数 列数 地雷数 随机数种子
+ *     行编号 列编号 方块操作指令
+ *     ...
+ *
+ * 随机数种子为0时自动生成，方块操作指令为V、F、?、C之一。
+ * 命令行选项已指定地图大小时，输入中没有第一行的地图参数。
+ *
+ */
+
+
+#ifndef MINESWEEPING_BATCH_H
+#define MINESWEEPING_BATCH_H
+
+#include <stdio.h>
+
+#include "game.h"
+#include "options.h"
+
+/*
+ * 函数原型
+ */
+
+// 执行批处理
+int RunBatch(FILE *input, FILE *output, const Options *options);
+
+#endif //MINESWEEPING_BATCH_H
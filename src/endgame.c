@@ -0,0 +1,716 @@
+/**
+ * ----------------------------------------------------------------------------
+ * [源文件] 残局
+ * ----------------------------------------------------------------------------
+ *
+ * 定义残局穷举搜索的各个函数
+ *
+ * 局面的胜率是所有相容布局等概率时，按最佳策略走下去能翻开全部安全方块的概率：
+ * 翻开一个方块时，它是地雷的布局记为失败，其余布局按翻开后看到的方块和数字
+ * （翻开空白时连带翻开的区域也计入）分组，各组递归求胜率，按组内布局数加权平均。
+ * 有一定安全的方块时只走它：多看到的信息不会降低最佳胜率。
+ * 翻开方块的胜率不超过它安全的概率，候选方块按安全的概率从高到低尝试，
+ * 不可能超过当前最佳胜率时剪枝。
+ *
+ */
+
+
+#include <stdlib.h>
+#include <string.h>
+
+#include "endgame.h"
+
+
+/**
+ * 按需扩大缓冲区
+ *
+ * 容量不足时扩容为所需容量和原容量2倍中的较大者，内存不足时保留原缓冲区
+ *
+ * @param buffer            缓冲区指针的指针
+ * @param capacity          容量指针（元素数）
+ * @param required          所需容量（元素数）
+ * @param size              每个元素的字节数
+ * @return                  容量是否足够
+ */
+static _Bool Reserve(void **buffer, size_t *capacity, size_t required, size_t size) {
+    // 新容量
+    size_t new_capacity;
+    // 新的缓冲区
+    void *new_buffer;
+
+    if (required <= *capacity) {
+        return 1;
+    }
+
+    new_capacity = *capacity * 2 > required ? *capacity * 2 : required;
+    new_buffer = realloc(*buffer, size * new_capacity);
+    if (! new_buffer) {
+        return 0;
+    }
+    *buffer = new_buffer;
+    *capacity = new_capacity;
+
+    return 1;
+}
+
+/**
+ * 混合一个64位整数（SplitMix64的输出函数）
+ *
+ * @param value             整数
+ * @return                  混合后的整数
+ */
+static uint64_t Mix(uint64_t value) {
+    value += 0x9E3779B97F4A7C15ULL;
+    value = (value ^ (value >> 30)) * 0xBF58476D1CE4E5B9ULL;
+    value = (value ^ (value >> 27)) * 0x94D049BB133111EBULL;
+
+    return value ^ (value >> 31);
+}
+
+/**
+ * 创建残局搜索器
+ *
+ * @param map               地图指针
+ * @return                  分配的内存地址
+ */
+Endgame * CreateEndgame(Map *map) {
+    // 残局搜索器指针
+    Endgame *endgame;
+
+    endgame = (Endgame *)calloc(1, sizeof(Endgame));
+    if (! endgame) {
+        return NULL;
+    }
+
+    endgame->map = map;
+    endgame->node_budget = ENDGAME_NODE_BUDGET;
+    endgame->memo = (EndgameMemo *)calloc(ENDGAME_MEMO_SIZE, sizeof(EndgameMemo));
+    if (! endgame->memo) {
+        DestroyEndgame(&endgame);
+        return NULL;
+    }
+
+    return endgame;
+}
+
+/**
+ * 销毁残局搜索器
+ *
+ * @param endgame           残局搜索器指针的指针
+ */
+void DestroyEndgame(Endgame **endgame) {
+    free((*endgame)->constraints);
+    free((*endgame)->layouts);
+    free((*endgame)->entries);
+    free((*endgame)->memo);
+    free(*endgame);
+    *endgame = NULL;
+}
+
+/**
+ * 比较两个方块下标，用于排序
+ *
+ * @param a                 方块下标A的指针
+ * @param b                 方块下标B的指针
+ * @return                  A小于、等于、大于B时分别为负数、0、正数
+ */
+static int CompareIndices(const void *a, const void *b) {
+    return (*(const int *)a > *(const int *)b) - (*(const int *)a < *(const int *)b);
+}
+
+/**
+ * 扫描方块表，收集未翻开的方块
+ *
+ * 未翻开的方块按方块表的顺序编号，旗标和疑问标当作未翻开处理
+ *
+ * @param endgame           残局搜索器指针
+ * @param max_unknown       最多的未翻开方块数
+ * @return                  未翻开的方块是否不超过最多的未翻开方块数
+ */
+static _Bool FindUnknownBlocks(Endgame *endgame, int max_unknown) {
+    // 地图指针
+    Map *map = endgame->map;
+    // 行下标、列下标（方块表中，含哨兵行、列）
+    int row, column;
+    // 方块下标
+    int index;
+
+    endgame->number_of_unknown_blocks = 0;
+    for (row = 1; row <= map->number_of_rows; row++) {
+        for (column = 1; column <= map->number_of_columns; column++) {
+            index = row * map->stride + column;
+            if (BLOCK_STATUS_OF(map->blocks[index]) == BLOCK_STATUS_VISIBLE) {
+                continue;
+            }
+            if (endgame->number_of_unknown_blocks >= max_unknown) {
+                return 0;
+            }
+            endgame->unknown_blocks[endgame->number_of_unknown_blocks++] = index;
+        }
+    }
+
+    return 1;
+}
+
+/**
+ * 查找方块的编号
+ *
+ * @param endgame           残局搜索器指针，未翻开的方块已按方块表的顺序编号
+ * @param index             方块在方块表中的下标
+ * @return                  方块编号，不是搜索的方块时为-1
+ */
+static int FindCell(Endgame *endgame, int index) {
+    // 查找范围
+    int low = 0, high = endgame->number_of_unknown_blocks - 1;
+    // 中间位置
+    int middle;
+
+    while (low <= high) {
+        middle = (low + high) / 2;
+        if (endgame->unknown_blocks[middle] == index) {
+            return middle;
+        }
+        if (endgame->unknown_blocks[middle] < index) {
+            low = middle + 1;
+        } else {
+            high = middle - 1;
+        }
+    }
+
+    return -1;
+}
+
+/**
+ * 根据未翻开的方块收集相邻关系和约束
+ *
+ * 只访问未翻开方块周围的方块，代价与未翻开的方块数成正比，不扫描方块表。
+ * 不在搜索范围内的未翻开方块是已知的地雷，旗标与其他方块相同，不当作地雷。
+ * 与未翻开方块相邻的数字成为约束，不与未翻开方块相邻的数字不影响布局，不检查它们与已知地雷是否矛盾
+ *
+ * @param endgame           残局搜索器指针，未翻开的方块已按方块表的顺序编号
+ * @return                  是否成功：内存不足或数字与已知地雷矛盾时失败
+ */
+static _Bool CollectConstraints(Endgame *endgame) {
+    // 地图指针
+    Map *map = endgame->map;
+    // 与未翻开方块相邻的数字的下标
+    int numbers[ENDGAME_MAX_UNKNOWN * 8];
+    // 数字个数、数字序号
+    int number_of_numbers = 0, i;
+    // 方块下标、邻居下标
+    int index, neighbor;
+    // 行下标、列下标（方块表中，含哨兵行、列）
+    int row, column;
+    // 邻居序号、方块编号
+    int k, cell;
+    // 数字周围的未翻开方块
+    uint64_t mask;
+    // 数字周围剩余的地雷数
+    int remaining;
+
+    // 未翻开方块之间的相邻关系和周围的已知地雷数，同时收集相邻的数字
+    endgame->root_moves = 0;
+    for (cell = 0; cell < endgame->number_of_unknown_blocks; cell++) {
+        index = endgame->unknown_blocks[cell];
+        endgame->neighbor_masks[cell] = 0;
+        endgame->known_counts[cell] = 0;
+        if (BLOCK_STATUS_OF(map->blocks[index]) != BLOCK_STATUS_FLAG) {
+            endgame->root_moves |= (uint64_t)1 << cell;
+        }
+        for (k = 0; k < 8; k++) {
+            neighbor = index + map->neighbor_offsets[k];
+            row = neighbor / map->stride;
+            column = neighbor % map->stride;
+            if (row < 1 || row > map->number_of_rows || column < 1 || column > map->number_of_columns) {
+                continue;
+            }
+            if (BLOCK_STATUS_OF(map->blocks[neighbor]) == BLOCK_STATUS_VISIBLE) {
+                numbers[number_of_numbers++] = neighbor;
+            } else if (FindCell(endgame, neighbor) < 0) {
+                endgame->known_counts[cell]++;
+            }
+        }
+        for (k = 0; k < endgame->number_of_unknown_blocks; k++) {
+            neighbor = endgame->unknown_blocks[k];
+            if (k != cell && abs(neighbor / map->stride - index / map->stride) <= 1
+                && abs(neighbor % map->stride - index % map->stride) <= 1) {
+                endgame->neighbor_masks[cell] |= (uint64_t)1 << k;
+            }
+        }
+    }
+
+    // 数字按方块表的顺序去重后成为约束
+    qsort(numbers, (size_t)number_of_numbers, sizeof(int), CompareIndices);
+    endgame->number_of_constraints = 0;
+    for (i = 0; i < number_of_numbers; i++) {
+        index = numbers[i];
+        if (i > 0 && index == numbers[i - 1]) {
+            continue;
+        }
+
+        mask = 0;
+        remaining = BLOCK_TYPE_OF(map->blocks[index]);
+        for (k = 0; k < 8; k++) {
+            neighbor = index + map->neighbor_offsets[k];
+            if (BLOCK_STATUS_OF(map->blocks[neighbor]) == BLOCK_STATUS_VISIBLE) {
+                continue;
+            }
+            cell = FindCell(endgame, neighbor);
+            if (cell < 0) {
+                remaining--;
+            } else {
+                mask |= (uint64_t)1 << cell;
+            }
+        }
+        if (remaining < 0 || remaining > __builtin_popcountll(mask)) {
+            return 0;
+        }
+
+        if (! Reserve((void **)&endgame->constraints, &endgame->constraint_capacity,
+                      (size_t)endgame->number_of_constraints + 1, sizeof(EndgameConstraint))) {
+            return 0;
+        }
+        endgame->constraints[endgame->number_of_constraints].mask = mask;
+        endgame->constraints[endgame->number_of_constraints++].remaining = remaining;
+    }
+
+    return 1;
+}
+
+/**
+ * 枚举相容的地雷布局
+ *
+ * 按编号依次决定每个方块是否是地雷，每决定一个方块检查包含它的数字和剩余的地雷数
+ *
+ * @param endgame           残局搜索器指针
+ * @param cell              当前方块编号
+ * @param layout            已决定的方块中的地雷
+ * @param mines             还需放置的地雷数
+ * @return                  是否成功：布局过多、超出预算或内存不足时失败
+ */
+static _Bool EnumerateLayouts(Endgame *endgame, int cell, uint64_t layout, int mines) {
+    // 已决定的方块
+    uint64_t decided;
+    // 约束序号、取值
+    int i, value;
+    // 约束中已决定的地雷数、未决定的方块数
+    int placed, undecided;
+    // 约束指针
+    const EndgameConstraint *constraint;
+
+    if (++endgame->number_of_nodes > endgame->node_budget) {
+        endgame->is_aborted = 1;
+        return 0;
+    }
+
+    if (cell == endgame->number_of_unknown_blocks) {
+        if (endgame->number_of_layouts >= ENDGAME_MAX_LAYOUTS) {
+            return 0;
+        }
+        if (! Reserve((void **)&endgame->layouts, &endgame->layout_capacity,
+                      (size_t)endgame->number_of_layouts + 1, sizeof(uint64_t))) {
+            return 0;
+        }
+        endgame->layouts[endgame->number_of_layouts++] = layout;
+        return 1;
+    }
+
+    decided = cell == 63 ? ~(uint64_t)0 : ((uint64_t)1 << (cell + 1)) - 1;
+    for (value = 0; value <= 1; value++) {
+        if (value > mines || mines - value > endgame->number_of_unknown_blocks - cell - 1) {
+            continue;
+        }
+        if (value) {
+            layout |= (uint64_t)1 << cell;
+        }
+
+        for (i = 0; i < endgame->number_of_constraints; i++) {
+            constraint = &endgame->constraints[i];
+            if (! (constraint->mask >> cell & 1)) {
+                continue;
+            }
+            placed = __builtin_popcountll(layout & constraint->mask);
+            undecided = __builtin_popcountll(constraint->mask & ~decided);
+            if (placed > constraint->remaining || placed + undecided < constraint->remaining) {
+                break;
+            }
+        }
+        if (i == endgame->number_of_constraints && ! EnumerateLayouts(endgame, cell + 1, layout, mines - value)) {
+            return 0;
+        }
+    }
+
+    return 1;
+}
+
+/**
+ * 在一个布局中翻开一个方块
+ *
+ * 翻开空白时连带翻开周围尚未翻开的方块，与处理方块时的行为相同
+ *
+ * @param endgame           残局搜索器指针
+ * @param layout            布局
+ * @param hidden            尚未翻开的方块
+ * @param cell              翻开的方块编号，该方块在布局中必须不是地雷
+ * @param entry             分组表项指针，写入新看到的方块及其数字的散列值
+ */
+static void Reveal(Endgame *endgame, uint64_t layout, uint64_t hidden, int cell, EndgameEntry *entry) {
+    // 待处理的方块
+    uint64_t pending = (uint64_t)1 << cell;
+    // 新翻开的方块
+    uint64_t opened;
+    // 方块的数字
+    int value;
+
+    entry->revealed = pending;
+    entry->hash = 0;
+    while (pending) {
+        cell = __builtin_ctzll(pending);
+        pending &= pending - 1;
+        value = endgame->known_counts[cell] + __builtin_popcountll(layout & endgame->neighbor_masks[cell]);
+        entry->hash ^= Mix((uint64_t)cell * 9 + (uint64_t)value + 1);
+        if (value == 0) {
+            opened = endgame->neighbor_masks[cell] & hidden & ~entry->revealed;
+            entry->revealed |= opened;
+            pending |= opened;
+        }
+    }
+}
+
+/**
+ * 比较两个分组表项，按新看到的方块、散列值排序
+ *
+ * @param a                 表项指针
+ * @param b                 表项指针
+ * @return                  比较结果
+ */
+static int CompareEntries(const void *a, const void *b) {
+    // 表项指针
+    const EndgameEntry *x = (const EndgameEntry *)a, *y = (const EndgameEntry *)b;
+
+    if (x->revealed != y->revealed) {
+        return x->revealed < y->revealed ? -1 : 1;
+    }
+    if (x->hash != y->hash) {
+        return x->hash < y->hash ? -1 : 1;
+    }
+
+    return 0;
+}
+
+/**
+ * 求一个局面的胜率
+ *
+ * 局面的相容布局是表项栈中的一段表项，递归时在栈顶为每个候选方块压入分组表项，
+ * 栈可能被重新分配，因此只按下标访问
+ *
+ * @param endgame           残局搜索器指针
+ * @param hidden            尚未翻开的方块
+ * @param moves             可以走的方块，只有根局面排除有旗标的方块
+ * @param key               局面的散列值
+ * @param start             相容布局在表项栈中的起始下标
+ * @param count             相容布局数
+ * @param move              最佳走法的方块编号指针，已经胜利时为-1
+ * @return                  胜率，中止时无意义
+ */
+static double Search(Endgame *endgame, uint64_t hidden, uint64_t moves, uint64_t key, size_t start, int count, int *move) {
+    // 记忆表项指针
+    EndgameMemo *memo = &endgame->memo[key & (ENDGAME_MEMO_SIZE - 1)];
+    // 每个方块是地雷的布局数
+    int mines[ENDGAME_MAX_UNKNOWN] = {0};
+    // 候选方块编号
+    int candidates[ENDGAME_MAX_UNKNOWN];
+    // 候选方块数
+    int number_of_candidates = 0;
+    // 方块编号、布局序号、表项序号、分组末尾、候选序号
+    int cell, i, j, end, c;
+    // 布局中未翻开的地雷
+    uint64_t bits;
+    // 分组表项起始下标
+    size_t base = endgame->entry_length;
+    // 安全的布局数
+    int safe;
+    // 各组胜率的加权和、胜率、最佳胜率
+    double sum, probability, best = -1;
+    // 子局面的最佳走法
+    int child;
+
+    *move = -1;
+    if (++endgame->number_of_nodes > endgame->node_budget) {
+        endgame->is_aborted = 1;
+        return 0;
+    }
+
+    // 尚未翻开的都是地雷时胜利
+    if (__builtin_popcountll(hidden) == endgame->number_of_mines) {
+        return 1;
+    }
+
+    // 散列值0表示空表项，不查也不存
+    if (key && memo->key == key) {
+        *move = memo->move;
+        return memo->win_probability;
+    }
+
+    for (i = 0; i < count; i++) {
+        bits = endgame->layouts[endgame->entries[start + (size_t)i].layout] & hidden;
+        while (bits) {
+            mines[__builtin_ctzll(bits)]++;
+            bits &= bits - 1;
+        }
+    }
+
+    // 有一定安全的方块时只走它，否则按安全的布局数从多到少插入排序
+    bits = hidden & moves;
+    while (bits) {
+        cell = __builtin_ctzll(bits);
+        bits &= bits - 1;
+        if (mines[cell] == 0) {
+            candidates[0] = cell;
+            number_of_candidates = 1;
+            break;
+        }
+        if (mines[cell] == count) {
+            continue;
+        }
+        for (c = number_of_candidates; c > 0 && mines[candidates[c - 1]] > mines[cell]; c--) {
+            candidates[c] = candidates[c - 1];
+        }
+        candidates[c] = cell;
+        number_of_candidates++;
+    }
+
+    for (c = 0; c < number_of_candidates; c++) {
+        cell = candidates[c];
+        safe = count - mines[cell];
+        // 胜率不超过安全的概率，之后的候选更不可能超过当前最佳
+        if ((double)safe / count <= best) {
+            break;
+        }
+
+        if (! Reserve((void **)&endgame->entries, &endgame->entry_capacity, base + (size_t)safe, sizeof(EndgameEntry))) {
+            endgame->is_aborted = 1;
+            return 0;
+        }
+
+        j = 0;
+        for (i = 0; i < count; i++) {
+            EndgameEntry *entry = &endgame->entries[base + (size_t)j];
+            uint64_t layout = endgame->layouts[endgame->entries[start + (size_t)i].layout];
+
+            if (layout >> cell & 1) {
+                continue;
+            }
+            Reveal(endgame, layout, hidden, cell, entry);
+            entry->layout = endgame->entries[start + (size_t)i].layout;
+            j++;
+        }
+        endgame->entry_length = base + (size_t)safe;
+        qsort(endgame->entries + base, (size_t)safe, sizeof(EndgameEntry), CompareEntries);
+
+        // 每组递归求胜率
+        sum = 0;
+        for (i = 0; i < safe; i = end) {
+            EndgameEntry group = endgame->entries[base + (size_t)i];
+
+            for (end = i + 1; end < safe && CompareEntries(&endgame->entries[base + (size_t)end], &group) == 0; end++) {
+            }
+            sum += (end - i) * Search(endgame, hidden & ~group.revealed, hidden & ~group.revealed, key ^ group.hash,
+                                      base + (size_t)i, end - i, &child);
+            if (endgame->is_aborted) {
+                endgame->entry_length = base;
+                return 0;
+            }
+        }
+        endgame->entry_length = base;
+
+        probability = sum / count;
+        if (probability > best) {
+            best = probability;
+            *move = cell;
+        }
+    }
+
+    if (key) {
+        memo->key = key;
+        memo->win_probability = best;
+        memo->move = *move;
+    }
+
+    return best;
+}
+
+/**
+ * 收集约束、枚举布局并搜索最佳走法
+ *
+ * @param endgame           残局搜索器指针，未翻开的方块已按方块表的顺序编号
+ * @return                  是否搜索成功
+ */
+static _Bool Solve(Endgame *endgame) {
+    // 地图指针
+    Map *map = endgame->map;
+    // 布局序号
+    int i;
+    // 最佳走法的方块编号
+    int move;
+    // 方块下标
+    int index;
+    // 最佳走法的方块是地雷的布局数
+    int mines = 0;
+    // 搜索的方块
+    uint64_t hidden = endgame->number_of_unknown_blocks == 64 ? ~(uint64_t)0
+                      : ((uint64_t)1 << endgame->number_of_unknown_blocks) - 1;
+
+    if (! CollectConstraints(endgame)) {
+        return 0;
+    }
+
+    // 不在搜索范围内的未翻开方块都是已知的地雷
+    endgame->number_of_mines = (int)(map->number_of_mines
+                                     - (map->number_of_invisible_blocks - endgame->number_of_unknown_blocks));
+    if (endgame->number_of_mines < 0 || endgame->number_of_mines >= endgame->number_of_unknown_blocks
+        || ! EnumerateLayouts(endgame, 0, 0, endgame->number_of_mines) || endgame->number_of_layouts == 0) {
+        return 0;
+    }
+
+    // 根局面的相容布局是全部布局
+    if (! Reserve((void **)&endgame->entries, &endgame->entry_capacity,
+                  (size_t)endgame->number_of_layouts, sizeof(EndgameEntry))) {
+        return 0;
+    }
+    for (i = 0; i < endgame->number_of_layouts; i++) {
+        endgame->entries[i].layout = i;
+    }
+    endgame->entry_length = (size_t)endgame->number_of_layouts;
+
+    endgame->generation++;
+    endgame->win_probability = Search(endgame, hidden, hidden & endgame->root_moves,
+                                      Mix(endgame->generation ^ ENDGAME_GENERATION_TAG) | 1, 0, endgame->number_of_layouts, &move);
+    endgame->entry_length = 0;
+    if (endgame->is_aborted || move < 0) {
+        return 0;
+    }
+
+    for (i = 0; i < endgame->number_of_layouts; i++) {
+        mines += (int)(endgame->layouts[i] >> move & 1);
+    }
+    endgame->mine_probability = (double)mines / endgame->number_of_layouts;
+
+    index = endgame->unknown_blocks[move];
+    endgame->best_row = index / map->stride - 1;
+    endgame->best_column = index % map->stride - 1;
+
+    return 1;
+}
+
+/**
+ * 搜索当前局面的最佳走法，依次查上次的结果和置换表
+ *
+ * @param endgame           残局搜索器指针
+ * @param blocks            搜索的未翻开方块的下标，其余未翻开的方块是已知的地雷；为空时扫描方块表收集全部未翻开的方块
+ * @param count             搜索的未翻开方块数，blocks为空时忽略
+ * @param max_unknown       最多搜索的未翻开方块数
+ * @return                  是否搜索成功
+ */
+static _Bool SolvePosition(Endgame *endgame, const int *blocks, int count, int max_unknown) {
+    // 地图指针
+    Map *map = endgame->map;
+    // 方块下标
+    int index;
+    // 置换表的键
+    uint64_t key = map->hash ^ ENDGAME_TRANSPOSITION_TAG;
+    // 置换表的数据字：最佳走法的方块下标（失败时为-1）、胜率、是地雷的概率
+    uint64_t data[TRANSPOSITION_DATA_WORDS];
+    // 是否搜索成功
+    _Bool is_solved;
+
+    endgame->number_of_nodes = 0;
+    endgame->is_aborted = 0;
+    endgame->number_of_layouts = 0;
+    endgame->entry_length = 0;
+
+    if (max_unknown > ENDGAME_MAX_UNKNOWN) {
+        max_unknown = ENDGAME_MAX_UNKNOWN;
+    }
+    // 不扫描方块表即可排除未翻开方块过多和已翻开地雷的局面
+    if ((blocks ? count : map->number_of_invisible_blocks) > max_unknown || map->number_of_visible_mine_blocks > 0) {
+        return 0;
+    }
+
+    // 局面没有改变时，上次的结果仍然保存在搜索器中
+    if (key == endgame->last_key) {
+        return endgame->is_last_solved;
+    }
+
+    if (endgame->cache && ProbeTransposition(endgame->cache, key, data)) {
+        endgame->number_of_cache_hits++;
+        index = (int)(int64_t)data[0];
+        is_solved = index >= 0;
+        if (is_solved) {
+            memcpy(&endgame->win_probability, &data[1], sizeof(double));
+            memcpy(&endgame->mine_probability, &data[2], sizeof(double));
+            endgame->best_row = index / map->stride - 1;
+            endgame->best_column = index % map->stride - 1;
+        }
+        endgame->last_key = key;
+        endgame->is_last_solved = is_solved;
+        return is_solved;
+    }
+    if (endgame->cache) {
+        endgame->number_of_cache_misses++;
+    }
+
+    if (blocks) {
+        // 按方块表的顺序编号，搜索结果与方块的记录顺序无关
+        memcpy(endgame->unknown_blocks, blocks, sizeof(int) * (size_t)count);
+        qsort(endgame->unknown_blocks, (size_t)count, sizeof(int), CompareIndices);
+        endgame->number_of_unknown_blocks = count;
+        is_solved = 1;
+    } else {
+        is_solved = FindUnknownBlocks(endgame, max_unknown);
+    }
+    is_solved = is_solved && Solve(endgame);
+
+    // 失败也缓存，避免重复耗尽节点预算；内存不足等偶然的失败也会被缓存，不影响正确性
+    if (endgame->cache) {
+        index = is_solved ? BLOCK_INDEX(map, endgame->best_row, endgame->best_column) : -1;
+        data[0] = (uint64_t)(int64_t)index;
+        memcpy(&data[1], &endgame->win_probability, sizeof(double));
+        memcpy(&data[2], &endgame->mine_probability, sizeof(double));
+        StoreTransposition(endgame->cache, key, data);
+    }
+    endgame->last_key = key;
+    endgame->is_last_solved = is_solved;
+
+    return is_solved;
+}
+
+/**
+ * 搜索当前局面的最佳走法
+ *
+ * 结果保存在最佳走法、胜率和最佳走法的方块是地雷的概率中。
+ * 局面与上次搜索相同时直接返回上次的结果，设置了置换表时再查置换表，都没有时扫描方块表收集未翻开的方块
+ *
+ * @param endgame           残局搜索器指针
+ * @param max_unknown       最多的未翻开（含旗标）方块数，不超过ENDGAME_MAX_UNKNOWN
+ * @return                  是否搜索成功：方块过多、已经胜利、没有相容布局、布局过多、超出预算或内存不足时失败
+ */
+_Bool SolveEndgame(Endgame *endgame, int max_unknown) {
+    return SolvePosition(endgame, NULL, 0, max_unknown);
+}
+
+/**
+ * 按调用者维护的未翻开方块搜索当前局面的最佳走法
+ *
+ * 与SolveEndgame相同，但不扫描方块表，代价只与给出的方块数有关。
+ * 没有给出的未翻开方块被当作地雷，调用者只能省略由已翻开的数字推出是地雷的方块，
+ * 这样相容的布局与给出全部未翻开方块时相同，搜索结果也相同
+ *
+ * @param endgame           残局搜索器指针
+ * @param blocks            搜索的未翻开（含旗标和疑问标）方块在方块表中的下标，顺序任意
+ * @param count             搜索的方块数，超过ENDGAME_MAX_UNKNOWN时失败
+ * @return                  是否搜索成功
+ */
+_Bool SolveEndgameBlocks(Endgame *endgame, const int *blocks, int count) {
+    return SolvePosition(endgame, blocks, count, ENDGAME_MAX_UNKNOWN);
+}
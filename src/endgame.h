@@ -0,0 +1,158 @@
+/**
+ * ----------------------------------------------------------------------------
+ * [头文件] 残局
+ * ----------------------------------------------------------------------------
+ *
+ * 定义残局穷举搜索的数据结构和函数原型
+ *
+ * 未翻开的方块很少时，枚举它们所有与已翻开的数字和剩余地雷数相容的地雷布局，
+ * 对每一步可能翻开的方块按翻开后看到的数字把布局分组，递归求出胜率最大的走法。
+ * 局面按已翻开的方块及其数字记忆，同一局面只搜索一次。
+ * 旗标不被当作地雷，有旗标的方块与其他未翻开的方块一样枚举，但不作为最佳走法返回；
+ * 调用者可以只给出一部分未翻开的方块，其余的未翻开方块必须已由已翻开的数字推出是地雷。
+ * 设置了置换表时，搜索结果按地图的散列值缓存，局面重复时（包括同一种子的多局游戏）直接取出。
+ *
+ */
+
+
+#ifndef MINESWEEPING_ENDGAME_H
+#define MINESWEEPING_ENDGAME_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include "game.h"
+#include "transposition.h"
+
+/*
+ * 宏定义
+ */
+
+// 残局最多的未翻开方块数，每个布局用一个64位字表示
+#define ENDGAME_MAX_UNKNOWN          64
+// 默认在未翻开方块不超过这个数时进入残局搜索
+#define ENDGAME_DEFAULT_MAX_UNKNOWN  16
+// 默认的搜索节点预算，超出时放弃搜索
+#define ENDGAME_NODE_BUDGET          2000000LL
+// 最多的布局数，超出时放弃搜索
+#define ENDGAME_MAX_LAYOUTS          16384
+// 记忆表的表项数，必须是2的幂
+#define ENDGAME_MEMO_SIZE            (1 << 16)
+// 残局结果在置换表中的标记，异或进地图的散列值作为键
+#define ENDGAME_TRANSPOSITION_TAG    0x454E4447414D4521ULL
+// 搜索代数的标记，异或进代数后再混合，使根局面的散列值不会是某个方块数字的散列值
+#define ENDGAME_GENERATION_TAG       0x47454E4552415449ULL
+
+/*
+ * 数据结构定义
+ */
+
+// 结构体：残局约束
+typedef struct {
+    // 数字周围的未翻开方块
+    uint64_t mask;
+    // 数字周围剩余的地雷数
+    int remaining;
+} EndgameConstraint;
+
+// 结构体：残局分组表项
+typedef struct {
+    // 翻开后新看到的方块
+    uint64_t revealed;
+    // 新看到的方块及其数字的散列值
+    uint64_t hash;
+    // 布局编号
+    int layout;
+} EndgameEntry;
+
+// 结构体：残局记忆表项
+typedef struct {
+    // 局面的散列值，0表示空表项
+    uint64_t key;
+    // 胜率
+    double win_probability;
+    // 最佳走法的方块编号
+    int move;
+} EndgameMemo;
+
+// 结构体：残局搜索器
+typedef struct {
+    // 地图，搜索器不拥有地图
+    Map *map;
+    // 搜索节点预算
+    long long node_budget;
+    // 上次搜索的节点数
+    long long number_of_nodes;
+    // 上次搜索是否因超出预算而中止
+    _Bool is_aborted;
+    // 置换表，为空时不缓存；搜索器不拥有置换表，共用置换表的搜索器应使用相同的节点预算
+    TranspositionCache *cache;
+    // 置换表命中、未命中的次数，每个搜索器各自统计
+    long long number_of_cache_hits, number_of_cache_misses;
+
+    // 搜索的未翻开（含旗标，不含已知地雷）方块数
+    int number_of_unknown_blocks;
+    // 搜索的未翻开方块在方块表中的下标，按方块编号存放
+    int unknown_blocks[ENDGAME_MAX_UNKNOWN];
+    // 每个未翻开方块周围的未翻开方块
+    uint64_t neighbor_masks[ENDGAME_MAX_UNKNOWN];
+    // 每个未翻开方块周围的已知地雷（不在搜索范围内的未翻开方块）数
+    int known_counts[ENDGAME_MAX_UNKNOWN];
+    // 可以作为最佳走法的方块（没有旗标）
+    uint64_t root_moves;
+    // 搜索的方块中剩余的地雷数
+    int number_of_mines;
+
+    // 周围有未翻开方块的数字给出的约束
+    EndgameConstraint *constraints;
+    // 约束数
+    int number_of_constraints;
+    // 约束缓冲区容量（约束数）
+    size_t constraint_capacity;
+
+    // 相容的地雷布局
+    uint64_t *layouts;
+    // 布局数
+    int number_of_layouts;
+    // 布局缓冲区容量（布局数）
+    size_t layout_capacity;
+
+    // 分组表项栈，搜索时按层使用
+    EndgameEntry *entries;
+    // 栈中的表项数
+    size_t entry_length;
+    // 表项栈容量（表项数）
+    size_t entry_capacity;
+
+    // 记忆表，直接映射，冲突时覆盖
+    EndgameMemo *memo;
+    // 搜索代数，混入根局面的散列值，使上次搜索的表项不再命中，而不必清空记忆表
+    uint64_t generation;
+
+    // 最佳走法的行下标、列下标
+    int best_row, best_column;
+    // 走最佳走法后的胜率
+    double win_probability;
+    // 最佳走法的方块是地雷的概率
+    double mine_probability;
+
+    // 上次搜索的局面在置换表中的键，为0时没有记录；局面不变时直接返回上次的结果，失败的搜索也不再重复
+    uint64_t last_key;
+    // 上次搜索是否成功
+    _Bool is_last_solved;
+} Endgame;
+
+/*
+ * 函数原型
+ */
+
+// 创建残局搜索器
+Endgame * CreateEndgame(Map *map);
+// 销毁残局搜索器
+void DestroyEndgame(Endgame **endgame);
+// 搜索当前局面的最佳走法
+_Bool SolveEndgame(Endgame *endgame, int max_unknown);
+// 按调用者维护的未翻开方块搜索当前局面的最佳走法
+_Bool SolveEndgameBlocks(Endgame *endgame, const int *blocks, int count);
+
+#endif //MINESWEEPING_ENDGAME_H
@@ -0,0 +1,1104 @@
+/**
+ * ----------------------------------------------------------------------------
+ * [源文件] 引擎校验
+ * ----------------------------------------------------------------------------
+ *
+ * 定义构建后由CTest运行的引擎校验程序
+ *
+ * 概率计算器与穷举全部地雷布局的结果比较；线性推理推出的方块必须在精确概率中一定安全或一定是地雷，插错旗标时也与真实地图一致；
+ * 增量维护的提示服务与每次重新创建的提示服务比较，其中穿插插错和取消的旗标；
+ * 提示服务按增量维护的未翻开方块进行的残局搜索与扫描方块表的残局搜索比较，在小地图上两者的胜率都与穷举最优走法的胜率比较。
+ * 解机在插错旗标的局面上不能翻开地雷，推出的地雷都必须是地雷。
+ * 按命令行选项开局时，同一种子在不同线程数下生成的地图必须相同。
+ * 全部使用固定的种子，结果可以重现。
+ *
+ */
+
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+
+#include "game.h"
+#include "random.h"
+#include "probability.h"
+#include "linear.h"
+#include "solver.h"
+#include "hint.h"
+#include "endgame.h"
+#include "options.h"
+
+
+/*
+ * 宏定义
+ */
+
+// 穷举比较时最多的未翻开方块数
+#define CHECK_MAX_UNKNOWN     24
+// 概率的允许误差
+#define CHECK_TOLERANCE       1e-9
+// 穷举胜率时最多的方块数，布局用32位字表示
+#define CHECK_BRUTE_FORCE_CELLS 16
+// 未翻开的方块不超过这个数时才穷举胜率，更多时太慢
+#define CHECK_BRUTE_FORCE_HIDDEN 12
+// 穷举胜率的记忆表项数，必须是2的幂，只用一半以免线性探查过长
+#define CHECK_MEMO_SIZE       (1 << 16)
+
+// 结构体：穷举胜率的记忆表项
+typedef struct {
+    // 已翻开的方块加1，0表示空表项
+    uint64_t revealed;
+    // 已翻开方块的数字，每个方块4位
+    uint64_t numbers;
+    // 胜率
+    double win_probability;
+} BruteForceMemo;
+
+// 结构体：穷举胜率的小地图
+typedef struct {
+    // 方块数，方块按 行下标 x 列数 + 列下标 编号
+    int cells;
+    // 地雷数
+    int mines;
+    // 每个方块周围的方块
+    uint32_t neighbors[CHECK_BRUTE_FORCE_CELLS];
+    // 记忆表，局面由已翻开的方块及其数字确定，与从哪个局面开始穷举无关
+    BruteForceMemo *memo;
+    // 记忆表中的表项数
+    int number_of_memos;
+} BruteForce;
+
+/**
+ * 方块是否在地图内（不是哨兵方块）
+ *
+ * @param map               地图指针
+ * @param index             方块在方块表中的下标
+ * @return                  是否在地图内
+ */
+static _Bool IsInside(Map *map, int index) {
+    // 方块表中的行、列（含哨兵行、列）
+    int row = index / map->stride, column = index % map->stride;
+
+    return row >= 1 && row <= map->number_of_rows && column >= 1 && column <= map->number_of_columns;
+}
+
+/**
+ * 随机选取一个满足条件的方块
+ *
+ * @param map               地图指针
+ * @param random            随机数发生器指针
+ * @param status            方块状态
+ * @param is_mine           1只选地雷，0只选不是地雷的方块，-1不限
+ * @return                  方块在方块表中的下标，没有时为-1
+ */
+static int PickBlock(Map *map, Random *random, BlockStatus status, int is_mine) {
+    // 行下标、列下标
+    int row, column;
+    // 方块下标
+    int index;
+    // 满足条件的方块数、选中的序号
+    int count = 0, chosen;
+
+    for (row = 0; row < map->number_of_rows; row++) {
+        for (column = 0; column < map->number_of_columns; column++) {
+            index = BLOCK_INDEX(map, row, column);
+            if (BLOCK_STATUS_OF(map->blocks[index]) == status
+                && (is_mine < 0 || (BLOCK_TYPE_OF(map->blocks[index]) == BLOCK_TYPE_MINE) == is_mine)) {
+                count++;
+            }
+        }
+    }
+    if (count == 0) {
+        return -1;
+    }
+
+    chosen = (int)RandomBelow(random, (uint64_t)count);
+    for (row = 0; row < map->number_of_rows; row++) {
+        for (column = 0; column < map->number_of_columns; column++) {
+            index = BLOCK_INDEX(map, row, column);
+            if (BLOCK_STATUS_OF(map->blocks[index]) == status
+                && (is_mine < 0 || (BLOCK_TYPE_OF(map->blocks[index]) == BLOCK_TYPE_MINE) == is_mine)
+                && chosen-- == 0) {
+                return index;
+            }
+        }
+    }
+
+    return -1;
+}
+
+/**
+ * 穷举全部相容的地雷布局，计算每个未翻开方块是地雷的概率，并与概率计算器、线性推理比较
+ *
+ * 旗标当作未翻开的方块，只有概率计算器和线性推理共用的已知地雷才被减去
+ *
+ * @param map               地图指针
+ * @param engine            概率计算器指针，已知地雷与线性推理相同
+ * @param system            线性推理指针
+ * @param error             最大误差指针，比较后更新
+ * @return                  是否一致；未翻开方块过多时不比较，视为一致
+ */
+static _Bool CheckProbabilities(Map *map, ProbabilityEngine *engine, LinearSystem *system, double *error) {
+    // 未翻开（含旗标，不含已知地雷）的方块下标
+    int unknown_blocks[CHECK_MAX_UNKNOWN];
+    // 未翻开的方块数、剩余的地雷数
+    int number_of_unknown_blocks = 0, mines = map->number_of_mines;
+    // 每个数字周围的未翻开方块
+    uint64_t masks[8 * CHECK_MAX_UNKNOWN];
+    // 每个数字周围剩余的地雷数
+    int remaining[8 * CHECK_MAX_UNKNOWN];
+    // 数字数
+    int number_of_numbers = 0;
+    // 每个方块是地雷的布局数
+    double counts[CHECK_MAX_UNKNOWN] = {0};
+    // 相容的布局数
+    double total = 0;
+    // 布局、Gosper枚举的最低位和进位
+    uint64_t layout, lowest, carry;
+    // 行下标、列下标
+    int row, column;
+    // 方块下标、邻居下标
+    int index, neighbor;
+    // 序号
+    int i, k;
+    // 概率
+    double probability;
+
+    for (row = 0; row < map->number_of_rows; row++) {
+        for (column = 0; column < map->number_of_columns; column++) {
+            index = BLOCK_INDEX(map, row, column);
+            if (BLOCK_STATUS_OF(map->blocks[index]) == BLOCK_STATUS_VISIBLE) {
+                continue;
+            }
+            if (engine->known_mines[index]) {
+                mines--;
+                continue;
+            }
+            if (number_of_unknown_blocks == CHECK_MAX_UNKNOWN) {
+                return 1;
+            }
+            unknown_blocks[number_of_unknown_blocks++] = index;
+        }
+    }
+
+    // 与未翻开方块相邻的数字成为约束
+    for (row = 0; row < map->number_of_rows; row++) {
+        for (column = 0; column < map->number_of_columns; column++) {
+            index = BLOCK_INDEX(map, row, column);
+            if (BLOCK_STATUS_OF(map->blocks[index]) != BLOCK_STATUS_VISIBLE || ! IsInside(map, index)) {
+                continue;
+            }
+            masks[number_of_numbers] = 0;
+            remaining[number_of_numbers] = BLOCK_TYPE_OF(map->blocks[index]);
+            for (k = 0; k < 8; k++) {
+                neighbor = index + map->neighbor_offsets[k];
+                if (BLOCK_STATUS_OF(map->blocks[neighbor]) != BLOCK_STATUS_VISIBLE && engine->known_mines[neighbor]) {
+                    remaining[number_of_numbers]--;
+                }
+                for (i = 0; i < number_of_unknown_blocks; i++) {
+                    if (unknown_blocks[i] == neighbor) {
+                        masks[number_of_numbers] |= (uint64_t)1 << i;
+                    }
+                }
+            }
+            if (masks[number_of_numbers] && number_of_numbers < 8 * CHECK_MAX_UNKNOWN) {
+                number_of_numbers++;
+            }
+        }
+    }
+
+    // 按Gosper的方法依次枚举恰有mines个地雷的布局
+    layout = mines > 0 ? ((uint64_t)1 << mines) - 1 : 0;
+    while (layout < (uint64_t)1 << number_of_unknown_blocks) {
+        for (i = 0; i < number_of_numbers; i++) {
+            if (__builtin_popcountll(layout & masks[i]) != remaining[i]) {
+                break;
+            }
+        }
+        if (i == number_of_numbers) {
+            total++;
+            for (i = 0; i < number_of_unknown_blocks; i++) {
+                counts[i] += (double)(layout >> i & 1);
+            }
+        }
+        if (layout == 0) {
+            break;
+        }
+        lowest = layout & -layout;
+        carry = layout + lowest;
+        layout = carry | (((layout ^ carry) / lowest) >> 2);
+    }
+
+    if (total == 0 || ! ComputeProbabilities(engine)) {
+        return 0;
+    }
+    for (i = 0; i < number_of_unknown_blocks; i++) {
+        index = unknown_blocks[i];
+        probability = GetMineProbability(engine, index / map->stride - 1, index % map->stride - 1);
+        if (fabs(probability - counts[i] / total) > *error) {
+            *error = fabs(probability - counts[i] / total);
+        }
+    }
+    if (*error > CHECK_TOLERANCE) {
+        return 0;
+    }
+
+    // 线性推理推出的方块在所有相容布局中都一定安全或一定是地雷
+    if (! SolveLinearSystem(system)) {
+        return 0;
+    }
+    for (i = 0; i < system->number_of_safe_blocks; i++) {
+        index = system->safe_blocks[i];
+        if (GetMineProbability(engine, index / map->stride - 1, index % map->stride - 1) != 0) {
+            return 0;
+        }
+    }
+    for (i = 0; i < system->number_of_mine_blocks; i++) {
+        index = system->mine_blocks[i];
+        if (GetMineProbability(engine, index / map->stride - 1, index % map->stride - 1) != 1) {
+            return 0;
+        }
+    }
+
+    return 1;
+}
+
+/**
+ * 概率计算器和线性推理：在小地图上随机走步，每个局面都与穷举比较
+ *
+ * 随机插正确的旗和插错的旗，正确的旗有一半作为已知地雷交给概率计算器和线性推理
+ *
+ * @param games             对局数
+ * @return                  是否全部一致
+ */
+static _Bool CheckProbabilityEngine(int games) {
+    // 游戏
+    Game *game = CreateGame();
+    // 概率计算器
+    ProbabilityEngine *engine;
+    // 线性推理
+    LinearSystem *system;
+    // 已知地雷
+    uint8_t *known;
+    // 随机数发生器
+    Random random;
+    // 种子
+    int seed;
+    // 方块下标
+    int index;
+    // 随机选择的走法
+    int choice;
+    // 比较的局面数、不一致的局面数
+    int positions = 0, failures = 0;
+    // 最大误差
+    double error = 0;
+
+    SeedRandom(&random, 1);
+    for (seed = 1; seed <= games; seed++) {
+        StartGame(game, 5, 6, 6, (uint64_t)seed);
+        PlayMove(game, 2, 3, BLOCK_STATUS_VISIBLE);
+        engine = CreateProbabilityEngine(game->map);
+        system = CreateLinearSystem(game->map);
+        known = (uint8_t *)calloc((size_t)(game->map->number_of_rows + 2) * (size_t)game->map->stride, sizeof(uint8_t));
+        engine->known_mines = known;
+        system->known_mines = known;
+        while (! game->is_finished) {
+            positions++;
+            if (! CheckProbabilities(game->map, engine, system, &error)) {
+                failures++;
+                printf("  种子%d的第%d个局面不一致\n", seed, positions);
+            }
+            // 随机插一面正确的旗（一半作为已知地雷）或插错的旗，或翻开一个安全方块
+            choice = (int)RandomBelow(&random, 6);
+            index = choice < 2 ? PickBlock(game->map, &random, BLOCK_STATUS_INVISIBLE, choice == 0) : -1;
+            if (index >= 0) {
+                PlayMove(game, index / game->map->stride - 1, index % game->map->stride - 1, BLOCK_STATUS_FLAG);
+                known[index] = choice == 0 && RandomBelow(&random, 2) == 0;
+                continue;
+            }
+            index = PickBlock(game->map, &random, BLOCK_STATUS_INVISIBLE, 0);
+            if (index < 0) {
+                break;
+            }
+            PlayMove(game, index / game->map->stride - 1, index % game->map->stride - 1, BLOCK_STATUS_VISIBLE);
+        }
+        DestroyLinearSystem(&system);
+        DestroyProbabilityEngine(&engine);
+        free(known);
+    }
+    DestroyMap(&game->map);
+    DestroyGame(&game);
+
+    printf("概率计算与线性推理：%d个局面，最大误差%.3g，%d个不一致\n", positions, error, failures);
+
+    return failures == 0;
+}
+
+/**
+ * 线性推理：在随机翻开安全方块、插错旗标得到的局面上，推出的方块与真实地图一致
+ *
+ * 旗标不是推理的前提，插错的旗标不能使线性推理推出错误的结果
+ *
+ * @param rows              行数
+ * @param columns           列数
+ * @param mines             地雷数
+ * @param games             对局数
+ * @return                  是否全部一致
+ */
+static _Bool CheckLinearSystem(int rows, int columns, int mines, int games) {
+    // 游戏
+    Game *game = CreateGame();
+    // 线性推理
+    LinearSystem *system;
+    // 随机数发生器
+    Random random;
+    // 种子、步数
+    int seed, step;
+    // 序号
+    int i;
+    // 方块下标
+    int index;
+    // 推出的方块数、推错的方块数
+    long long decided = 0, wrong = 0;
+
+    SeedRandom(&random, 3);
+    for (seed = 1; seed <= games; seed++) {
+        StartGame(game, rows, columns, mines, (uint64_t)seed);
+        PlayMove(game, rows / 2, columns / 2, BLOCK_STATUS_VISIBLE);
+        system = CreateLinearSystem(game->map);
+        for (step = 0; step < 20 && ! game->is_finished; step++) {
+            SolveLinearSystem(system);
+            for (i = 0; i < system->number_of_safe_blocks; i++) {
+                wrong += BLOCK_TYPE_OF(game->map->blocks[system->safe_blocks[i]]) == BLOCK_TYPE_MINE;
+            }
+            for (i = 0; i < system->number_of_mine_blocks; i++) {
+                wrong += BLOCK_TYPE_OF(game->map->blocks[system->mine_blocks[i]]) != BLOCK_TYPE_MINE;
+            }
+            decided += system->number_of_safe_blocks + system->number_of_mine_blocks;
+
+            index = PickBlock(game->map, &random, BLOCK_STATUS_INVISIBLE, 0);
+            if (index < 0) {
+                break;
+            }
+            // 随机在安全方块上插错旗，或翻开它
+            PlayMove(game, index / game->map->stride - 1, index % game->map->stride - 1,
+                     RandomBelow(&random, 3) == 0 ? BLOCK_STATUS_FLAG : BLOCK_STATUS_VISIBLE);
+        }
+        DestroyLinearSystem(&system);
+    }
+    DestroyMap(&game->map);
+    DestroyGame(&game);
+
+    printf("线性推理（%d行 x %d列，%d个地雷）：%d局，推出%lld个方块，%lld个错误\n",
+           rows, columns, mines, games, decided, wrong);
+
+    return wrong == 0;
+}
+
+/**
+ * 解机：在安全方块上随机插错旗后运行解机，解机不能翻开地雷，推出的地雷都必须是地雷
+ *
+ * 解机推不出结果时随机翻开一个安全方块，继续运行到对局结束
+ *
+ * @param rows              行数
+ * @param columns           列数
+ * @param mines             地雷数
+ * @param games             对局数
+ * @return                  是否全部正确
+ */
+static _Bool CheckSolver(int rows, int columns, int mines, int games) {
+    // 游戏
+    Game *game = CreateGame();
+    // 解机
+    Solver *solver;
+    // 随机数发生器
+    Random random;
+    // 种子
+    int seed;
+    // 序号
+    int i;
+    // 方块下标
+    int index;
+    // 解机走的步数、插错的旗标数
+    long long moves = 0, wrong_flags = 0;
+    // 解机点到地雷的局数、推错的地雷数
+    long long lost = 0, wrong_mines = 0;
+
+    SeedRandom(&random, 5);
+    for (seed = 1; seed <= games; seed++) {
+        StartGame(game, rows, columns, mines, (uint64_t)seed);
+        PlayMove(game, rows / 2, columns / 2, BLOCK_STATUS_VISIBLE);
+        solver = CreateSolver(game);
+        while (! game->is_finished) {
+            // 随机在安全方块上插错旗
+            for (i = 0; i < 3; i++) {
+                index = PickBlock(game->map, &random, BLOCK_STATUS_INVISIBLE, 0);
+                if (index >= 0) {
+                    PlayMove(game, index / game->map->stride - 1, index % game->map->stride - 1, BLOCK_STATUS_FLAG);
+                    wrong_flags++;
+                }
+            }
+
+            moves += RunSolver(solver);
+            if (game->is_finished) {
+                lost += ! game->is_winning;
+                break;
+            }
+
+            index = PickBlock(game->map, &random, BLOCK_STATUS_INVISIBLE, 0);
+            if (index < 0) {
+                index = PickBlock(game->map, &random, BLOCK_STATUS_FLAG, 0);
+            }
+            if (index < 0) {
+                break;
+            }
+            PlayMove(game, index / game->map->stride - 1, index % game->map->stride - 1, BLOCK_STATUS_VISIBLE);
+        }
+        for (index = 0; index < (game->map->number_of_rows + 2) * game->map->stride; index++) {
+            wrong_mines += solver->known_mines[index] && BLOCK_TYPE_OF(game->map->blocks[index]) != BLOCK_TYPE_MINE;
+        }
+        DestroySolver(&solver);
+    }
+    DestroyMap(&game->map);
+    DestroyGame(&game);
+
+    printf("解机（%d行 x %d列，%d个地雷）：%d局，插错%lld面旗，解机走%lld步，%lld局点到地雷，%lld个推错的地雷\n",
+           rows, columns, mines, games, wrong_flags, moves, lost, wrong_mines);
+
+    return lost == 0 && wrong_mines == 0;
+}
+
+/**
+ * 提示服务：增量结果与每次重新创建的提示服务比较，随机插错和取消旗标
+ *
+ * 旗标不是推理的前提，一定安全的提示不能是地雷，重新创建的提示服务推出一定安全的方块时增量结果也要推出
+ *
+ * @param rows              行数
+ * @param columns           列数
+ * @param mines             地雷数
+ * @param games             对局数
+ * @return                  是否全部一致
+ */
+static _Bool CheckHintService(int rows, int columns, int mines, int games) {
+    // 游戏
+    Game *game = CreateGame();
+    // 增量维护的提示服务、重新创建的提示服务
+    HintService *hint, *rebuilt;
+    // 随机数发生器
+    Random random;
+    // 种子
+    int seed;
+    // 提示的行下标、列下标
+    int row, column, rebuilt_row, rebuilt_column;
+    // 方块下标
+    int index;
+    // 提示的概率
+    double probability, rebuilt_probability;
+    // 查询次数、不一致次数
+    long long queries = 0, failures = 0;
+
+    SeedRandom(&random, 2);
+    for (seed = 1; seed <= games; seed++) {
+        StartGame(game, rows, columns, mines, (uint64_t)seed);
+        PlayMove(game, rows / 2, columns / 2, BLOCK_STATUS_VISIBLE);
+        hint = CreateHintService(game->map, 0);
+        while (! game->is_finished) {
+            // 随机插旗（不管对错）或取消旗标
+            switch (RandomBelow(&random, 8)) {
+                case 0:
+                    index = PickBlock(game->map, &random, BLOCK_STATUS_INVISIBLE, -1);
+                    if (index >= 0) {
+                        PlayMove(game, index / game->map->stride - 1, index % game->map->stride - 1, BLOCK_STATUS_FLAG);
+                    }
+                    break;
+                case 1:
+                    index = PickBlock(game->map, &random, BLOCK_STATUS_FLAG, -1);
+                    if (index >= 0) {
+                        PlayMove(game, index / game->map->stride - 1, index % game->map->stride - 1, BLOCK_STATUS_INVISIBLE);
+                    }
+                    break;
+                default:
+                    break;
+            }
+
+            if (! GetHint(hint, &row, &column, &probability)) {
+                break;
+            }
+            queries++;
+            rebuilt = CreateHintService(game->map, 0);
+            GetHint(rebuilt, &rebuilt_row, &rebuilt_column, &rebuilt_probability);
+            if ((probability == 0 && GetBlockType(game->map, row, column) == BLOCK_TYPE_MINE)
+                || (rebuilt_probability == 0 && probability != 0)
+                || hint->number_of_hidden_blocks != game->map->number_of_invisible_blocks - hint->number_of_mine_blocks) {
+                failures++;
+                printf("  种子%d：提示(%d, %d)概率%.3f，重新创建后(%d, %d)概率%.3f\n",
+                       seed, row, column, probability, rebuilt_row, rebuilt_column, rebuilt_probability);
+            }
+            DestroyHintService(&rebuilt);
+            PlayMove(game, row, column, BLOCK_STATUS_VISIBLE);
+        }
+        DestroyHintService(&hint);
+    }
+    DestroyMap(&game->map);
+    DestroyGame(&game);
+
+    printf("提示服务（%d行 x %d列，%d个地雷）：%d局，%lld次查询，%lld次不一致\n",
+           rows, columns, mines, games, queries, failures);
+
+    return failures == 0;
+}
+
+/**
+ * 提示服务：取消插错的旗标后，不再给出以它为前提的一定安全的提示
+ *
+ * 2行 x 3列，地雷在(0, 0)：翻开(1, 2)后，在(1, 0)插旗再取消
+ *
+ * @return                  是否正确
+ */
+static _Bool CheckRetractedFlag() {
+    // 地图
+    Map *map = CreateMap(2, 3, 1);
+    // 提示服务
+    HintService *hint;
+    // 提示的行下标、列下标
+    int row, column;
+    // 提示的概率
+    double probability;
+    // 是否正确
+    _Bool is_correct;
+
+    SET_BLOCK_TYPE(BLOCK_AT(map, 0, 0), BLOCK_TYPE_MINE);
+    SET_BLOCK_TYPE(BLOCK_AT(map, 0, 1), 1);
+    SET_BLOCK_TYPE(BLOCK_AT(map, 1, 0), 1);
+    SET_BLOCK_TYPE(BLOCK_AT(map, 1, 1), 1);
+    HandleBlock(map, 1, 2, BLOCK_STATUS_VISIBLE);
+
+    hint = CreateHintService(map, 0);
+    HandleBlock(map, 1, 0, BLOCK_STATUS_FLAG);
+    GetHint(hint, &row, &column, &probability);
+    HandleBlock(map, 1, 0, BLOCK_STATUS_INVISIBLE);
+    GetHint(hint, &row, &column, &probability);
+    is_correct = probability > 0;
+
+    DestroyHintService(&hint);
+    DestroyMap(&map);
+
+    printf("取消旗标：%s\n", is_correct ? "正确" : "仍然给出一定安全的提示");
+
+    return is_correct;
+}
+
+/**
+ * 残局搜索：提示服务按增量维护的未翻开方块搜索的结果，与扫描方块表搜索的结果相同
+ *
+ * 每步后把与已翻开的数字相邻的地雷都插上旗，使对局进入残局
+ *
+ * @param rows              行数
+ * @param columns           列数
+ * @param mines             地雷数
+ * @param games             对局数
+ * @return                  是否全部一致
+ */
+static _Bool CheckEndgame(int rows, int columns, int mines, int games) {
+    // 游戏
+    Game *game = CreateGame();
+    // 提示服务
+    HintService *hint;
+    // 扫描方块表的残局搜索器
+    Endgame *endgame;
+    // 种子
+    int seed;
+    // 提示的行下标、列下标，插旗时的行下标、列下标
+    int row, column, r, c;
+    // 邻居序号
+    int k;
+    // 方块下标、邻居下标
+    int index, neighbor;
+    // 提示的概率
+    double probability;
+    // 残局查询次数、不一致次数
+    long long queries = 0, failures = 0;
+
+    for (seed = 1; seed <= games; seed++) {
+        StartGame(game, rows, columns, mines, (uint64_t)seed);
+        PlayMove(game, rows / 2, columns / 2, BLOCK_STATUS_VISIBLE);
+        hint = CreateHintService(game->map, ENDGAME_DEFAULT_MAX_UNKNOWN);
+        endgame = CreateEndgame(game->map);
+        while (! game->is_finished) {
+            for (r = 0; r < rows; r++) {
+                for (c = 0; c < columns; c++) {
+                    index = BLOCK_INDEX(game->map, r, c);
+                    if (BLOCK_STATUS_OF(game->map->blocks[index]) != BLOCK_STATUS_INVISIBLE
+                        || BLOCK_TYPE_OF(game->map->blocks[index]) != BLOCK_TYPE_MINE) {
+                        continue;
+                    }
+                    for (k = 0; k < 8; k++) {
+                        neighbor = index + game->map->neighbor_offsets[k];
+                        if (BLOCK_STATUS_OF(game->map->blocks[neighbor]) == BLOCK_STATUS_VISIBLE && IsInside(game->map, neighbor)) {
+                            PlayMove(game, r, c, BLOCK_STATUS_FLAG);
+                            break;
+                        }
+                    }
+                }
+            }
+
+            if (! GetHint(hint, &row, &column, &probability)) {
+                break;
+            }
+            if (hint->win_probability >= 0) {
+                queries++;
+                if (! SolveEndgame(endgame, ENDGAME_MAX_UNKNOWN) || endgame->best_row != row
+                    || endgame->best_column != column || endgame->win_probability != hint->win_probability
+                    || (probability == 0 && GetBlockType(game->map, row, column) == BLOCK_TYPE_MINE)) {
+                    failures++;
+                    printf("  种子%d：残局提示(%d, %d)胜率%.4f，扫描方块表后(%d, %d)胜率%.4f\n",
+                           seed, row, column, hint->win_probability,
+                           endgame->best_row, endgame->best_column, endgame->win_probability);
+                }
+            }
+            PlayMove(game, row, column, BLOCK_STATUS_VISIBLE);
+        }
+        DestroyEndgame(&endgame);
+        DestroyHintService(&hint);
+    }
+    DestroyMap(&game->map);
+    DestroyGame(&game);
+
+    printf("残局搜索（%d行 x %d列，%d个地雷）：%d局，%lld次残局查询，%lld次不一致\n",
+           rows, columns, mines, games, queries, failures);
+
+    return failures == 0;
+}
+
+/**
+ * 布局下已翻开方块的数字
+ *
+ * @param brute             穷举的小地图指针
+ * @param layout            地雷布局
+ * @param revealed          已翻开的方块
+ * @return                  每个已翻开方块的数字，每个方块4位
+ */
+static uint64_t BruteForceNumbers(const BruteForce *brute, uint32_t layout, uint32_t revealed) {
+    // 数字
+    uint64_t numbers = 0;
+    // 方块编号
+    int cell;
+
+    while (revealed) {
+        cell = __builtin_ctz(revealed);
+        revealed &= revealed - 1;
+        numbers |= (uint64_t)__builtin_popcount(layout & brute->neighbors[cell]) << (4 * cell);
+    }
+
+    return numbers;
+}
+
+/**
+ * 按布局翻开一个安全的方块，数字为0时连带翻开周围的方块（含旗标，之后可以取消）
+ *
+ * @param brute             穷举的小地图指针
+ * @param layout            地雷布局
+ * @param revealed          已翻开的方块
+ * @param cell              翻开的方块编号
+ * @return                  翻开后已翻开的方块
+ */
+static uint32_t BruteForceReveal(const BruteForce *brute, uint32_t layout, uint32_t revealed, int cell) {
+    // 待处理的方块
+    uint32_t pending = (uint32_t)1 << cell;
+
+    revealed |= pending;
+    while (pending) {
+        cell = __builtin_ctz(pending);
+        pending &= pending - 1;
+        if ((layout & brute->neighbors[cell]) == 0) {
+            pending |= brute->neighbors[cell] & ~revealed;
+            revealed |= brute->neighbors[cell];
+        }
+    }
+
+    return revealed;
+}
+
+/**
+ * 穷举最优走法的胜率
+ *
+ * 依次试每个可走的方块，把它安全的布局按翻开后的局面分组，各组递归取最优；不做任何剪枝
+ *
+ * @param brute             穷举的小地图指针
+ * @param revealed          已翻开的方块
+ * @param moves             可以走的方块，不是全部未翻开的方块时不查也不存记忆表
+ * @param layouts           与局面相容的布局
+ * @param count             布局数
+ * @return                  胜率，没有可能安全的方块时为-1
+ */
+static double BruteForceWin(BruteForce *brute, uint32_t revealed, uint32_t moves, const uint32_t *layouts, int count) {
+    // 全部方块
+    uint32_t all = (uint32_t)(((uint64_t)1 << brute->cells) - 1);
+    // 局面的数字
+    uint64_t numbers = BruteForceNumbers(brute, layouts[0], revealed);
+    // 是否使用记忆表
+    _Bool is_memorized = moves == (all & ~revealed);
+    // 记忆表位置
+    size_t slot = (size_t)((revealed * 0x9E3779B97F4A7C15ULL ^ numbers) * 0xBF58476D1CE4E5B9ULL >> 40) & (CHECK_MEMO_SIZE - 1);
+    // 每个安全布局翻开后的已翻开方块和数字
+    uint32_t *children = (uint32_t *)malloc(sizeof(uint32_t) * (size_t)count);
+    uint64_t *child_numbers = (uint64_t *)malloc(sizeof(uint64_t) * (size_t)count);
+    // 安全的布局、一组布局
+    uint32_t *safe_layouts = (uint32_t *)malloc(sizeof(uint32_t) * (size_t)count);
+    uint32_t *group = (uint32_t *)malloc(sizeof(uint32_t) * (size_t)count);
+    // 每个安全布局是否已分组
+    uint8_t *is_grouped = (uint8_t *)malloc((size_t)count);
+    // 未试的方块
+    uint32_t bits;
+    // 方块编号、序号、安全的布局数、组内的布局数
+    int cell, i, j, safe, size;
+    // 胜率的加权和、最佳胜率
+    double sum, best = -1;
+
+    if (brute->cells - __builtin_popcount(revealed) == brute->mines) {
+        best = 1;
+        goto done;
+    }
+    if (is_memorized) {
+        for (; brute->memo[slot].revealed; slot = (slot + 1) & (CHECK_MEMO_SIZE - 1)) {
+            if (brute->memo[slot].revealed == (uint64_t)revealed + 1 && brute->memo[slot].numbers == numbers) {
+                best = brute->memo[slot].win_probability;
+                goto done;
+            }
+        }
+    }
+
+    for (bits = moves & ~revealed; bits; bits &= bits - 1) {
+        cell = __builtin_ctz(bits);
+        safe = 0;
+        for (i = 0; i < count; i++) {
+            if (! (layouts[i] >> cell & 1)) {
+                safe_layouts[safe] = layouts[i];
+                children[safe] = BruteForceReveal(brute, layouts[i], revealed, cell);
+                child_numbers[safe] = BruteForceNumbers(brute, layouts[i], children[safe]);
+                is_grouped[safe] = 0;
+                safe++;
+            }
+        }
+        if (safe == 0) {
+            continue;
+        }
+
+        sum = 0;
+        for (i = 0; i < safe; i++) {
+            if (is_grouped[i]) {
+                continue;
+            }
+            size = 0;
+            for (j = i; j < safe; j++) {
+                if (! is_grouped[j] && children[j] == children[i] && child_numbers[j] == child_numbers[i]) {
+                    is_grouped[j] = 1;
+                    group[size++] = safe_layouts[j];
+                }
+            }
+            sum += size * BruteForceWin(brute, children[i], all & ~children[i], group, size);
+        }
+        if (sum / count > best) {
+            best = sum / count;
+        }
+    }
+
+    if (is_memorized && brute->number_of_memos < CHECK_MEMO_SIZE / 2) {
+        brute->memo[slot].revealed = (uint64_t)revealed + 1;
+        brute->memo[slot].numbers = numbers;
+        brute->memo[slot].win_probability = best;
+        brute->number_of_memos++;
+    }
+
+done:
+    free(children);
+    free(child_numbers);
+    free(safe_layouts);
+    free(group);
+    free(is_grouped);
+
+    return best;
+}
+
+/**
+ * 残局搜索的胜率与穷举比较
+ *
+ * 枚举与已翻开的数字和地雷总数相容的全部布局，第一步只能走没有旗标的方块。
+ * 扫描方块表的残局搜索和提示服务（进行残局搜索时）的胜率都要等于穷举的最优胜率，
+ * 它们选的走法按穷举的胜率也要是最优的；没有可能安全的方块时残局搜索必须失败
+ *
+ * @param map               地图指针，方块数不超过CHECK_BRUTE_FORCE_CELLS
+ * @param endgame           扫描方块表的残局搜索器指针
+ * @param hint              提示服务指针，残局阈值不小于方块数
+ * @param brute             穷举的小地图指针
+ * @param searches          残局搜索成功的次数指针，比较后更新
+ * @return                  是否一致
+ */
+static _Bool CheckWinProbability(Map *map, Endgame *endgame, HintService *hint, BruteForce *brute, long long *searches) {
+    // 相容的布局
+    uint32_t *layouts;
+    // 布局数
+    int count = 0;
+    // 真实布局、已翻开的方块、第一步可以走的方块、枚举的布局、Gosper枚举的最低位和进位
+    uint32_t truth = 0, revealed = 0, moves = 0, layout, lowest, carry;
+    // 已翻开方块的数字
+    uint64_t numbers;
+    // 行下标、列下标、方块编号
+    int row, column, cell;
+    // 方块下标
+    int index;
+    // 提示的概率
+    double probability;
+    // 最优胜率
+    double best;
+    // 是否一致
+    _Bool is_correct = 1;
+
+    for (row = 0; row < map->number_of_rows; row++) {
+        for (column = 0; column < map->number_of_columns; column++) {
+            index = BLOCK_INDEX(map, row, column);
+            cell = row * map->number_of_columns + column;
+            truth |= (uint32_t)(BLOCK_TYPE_OF(map->blocks[index]) == BLOCK_TYPE_MINE) << cell;
+            revealed |= (uint32_t)(BLOCK_STATUS_OF(map->blocks[index]) == BLOCK_STATUS_VISIBLE) << cell;
+            moves |= (uint32_t)(BLOCK_STATUS_OF(map->blocks[index]) != BLOCK_STATUS_FLAG) << cell;
+        }
+    }
+    numbers = BruteForceNumbers(brute, truth, revealed);
+
+    layouts = (uint32_t *)malloc(sizeof(uint32_t) * ((size_t)1 << brute->cells));
+    for (layout = ((uint32_t)1 << brute->mines) - 1; layout < (uint32_t)1 << brute->cells; ) {
+        if (! (layout & revealed) && BruteForceNumbers(brute, layout, revealed) == numbers) {
+            layouts[count++] = layout;
+        }
+        lowest = layout & -layout;
+        carry = layout + lowest;
+        layout = carry | (((layout ^ carry) / lowest) >> 2);
+    }
+
+    best = BruteForceWin(brute, revealed, moves & ~revealed, layouts, count);
+    if (! SolveEndgame(endgame, ENDGAME_MAX_UNKNOWN)) {
+        is_correct = best < 0;
+    } else {
+        (*searches)++;
+        cell = endgame->best_row * map->number_of_columns + endgame->best_column;
+        is_correct = fabs(endgame->win_probability - best) <= CHECK_TOLERANCE && (moves >> cell & 1)
+                     && fabs(BruteForceWin(brute, revealed, (uint32_t)1 << cell, layouts, count) - best) <= CHECK_TOLERANCE;
+    }
+
+    if (GetHint(hint, &row, &column, &probability) && hint->win_probability >= 0) {
+        cell = row * map->number_of_columns + column;
+        is_correct = is_correct && fabs(hint->win_probability - best) <= CHECK_TOLERANCE && (moves >> cell & 1)
+                     && fabs(BruteForceWin(brute, revealed, (uint32_t)1 << cell, layouts, count) - best) <= CHECK_TOLERANCE;
+    }
+    if (! is_correct) {
+        printf("  穷举胜率%.6f，残局搜索(%d, %d)胜率%.6f，提示(%d, %d)胜率%.6f\n", best,
+               endgame->best_row, endgame->best_column, endgame->win_probability, row, column, hint->win_probability);
+    }
+    free(layouts);
+
+    return is_correct;
+}
+
+/**
+ * 残局胜率：在小地图上随机翻开安全的方块，随机插对或插错旗标和取消旗标，每个局面的胜率都与穷举比较
+ *
+ * 未翻开的方块不超过CHECK_BRUTE_FORCE_HIDDEN时才比较，之前只翻开安全的方块
+ *
+ * @param rows              行数
+ * @param columns           列数，行数 x 列数不超过CHECK_BRUTE_FORCE_CELLS
+ * @param mines             地雷数
+ * @param games             对局数
+ * @return                  是否全部一致
+ */
+static _Bool CheckEndgameBruteForce(int rows, int columns, int mines, int games) {
+    // 游戏
+    Game *game = CreateGame();
+    // 提示服务
+    HintService *hint;
+    // 扫描方块表的残局搜索器
+    Endgame *endgame;
+    // 穷举的小地图
+    BruteForce brute;
+    // 随机数发生器
+    Random random;
+    // 种子
+    int seed;
+    // 行下标、列下标、邻居的行下标、列下标
+    int row, column, r, c;
+    // 方块下标
+    int index;
+    // 局面数、残局搜索成功的次数、不一致次数
+    long long positions = 0, searches = 0, failures = 0;
+
+    brute.cells = rows * columns;
+    brute.mines = mines;
+    brute.memo = (BruteForceMemo *)malloc(sizeof(BruteForceMemo) * CHECK_MEMO_SIZE);
+    for (row = 0; row < rows; row++) {
+        for (column = 0; column < columns; column++) {
+            brute.neighbors[row * columns + column] = 0;
+            for (r = row - 1; r <= row + 1; r++) {
+                for (c = column - 1; c <= column + 1; c++) {
+                    if (r >= 0 && r < rows && c >= 0 && c < columns && (r != row || c != column)) {
+                        brute.neighbors[row * columns + column] |= (uint32_t)1 << (r * columns + c);
+                    }
+                }
+            }
+        }
+    }
+
+    SeedRandom(&random, 4);
+    for (seed = 1; seed <= games; seed++) {
+        memset(brute.memo, 0, sizeof(BruteForceMemo) * CHECK_MEMO_SIZE);
+        brute.number_of_memos = 0;
+        StartGame(game, rows, columns, mines, (uint64_t)seed);
+        hint = CreateHintService(game->map, ENDGAME_MAX_UNKNOWN);
+        endgame = CreateEndgame(game->map);
+        index = PickBlock(game->map, &random, BLOCK_STATUS_INVISIBLE, 0);
+        PlayMove(game, index / game->map->stride - 1, index % game->map->stride - 1, BLOCK_STATUS_VISIBLE);
+        while (! game->is_finished) {
+            if (game->map->number_of_invisible_blocks <= CHECK_BRUTE_FORCE_HIDDEN) {
+                // 随机插旗（不管对错）或取消旗标
+                switch (RandomBelow(&random, 3)) {
+                    case 0:
+                        index = PickBlock(game->map, &random, BLOCK_STATUS_INVISIBLE, -1);
+                        if (index >= 0) {
+                            PlayMove(game, index / game->map->stride - 1, index % game->map->stride - 1, BLOCK_STATUS_FLAG);
+                        }
+                        break;
+                    case 1:
+                        index = PickBlock(game->map, &random, BLOCK_STATUS_FLAG, -1);
+                        if (index >= 0) {
+                            PlayMove(game, index / game->map->stride - 1, index % game->map->stride - 1, BLOCK_STATUS_INVISIBLE);
+                        }
+                        break;
+                    default:
+                        break;
+                }
+
+                positions++;
+                if (! CheckWinProbability(game->map, endgame, hint, &brute, &searches)) {
+                    failures++;
+                }
+            }
+
+            // 翻开一个安全的方块，安全的方块都插了旗时先取消一面
+            index = PickBlock(game->map, &random, BLOCK_STATUS_INVISIBLE, 0);
+            if (index < 0) {
+                index = PickBlock(game->map, &random, BLOCK_STATUS_FLAG, 0);
+                PlayMove(game, index / game->map->stride - 1, index % game->map->stride - 1, BLOCK_STATUS_INVISIBLE);
+            }
+            PlayMove(game, index / game->map->stride - 1, index % game->map->stride - 1, BLOCK_STATUS_VISIBLE);
+        }
+        DestroyEndgame(&endgame);
+        DestroyHintService(&hint);
+    }
+    free(brute.memo);
+    DestroyMap(&game->map);
+    DestroyGame(&game);
+
+    printf("残局胜率（%d行 x %d列，%d个地雷）：%d局，%lld个局面，%lld次残局搜索，%lld次不一致\n",
+           rows, columns, mines, games, positions, searches, failures);
+
+    return failures == 0;
+}
+
+/**
+ * 按命令行选项开局：同一种子在不同线程数下生成的地图相同
+ *
+ * 先按单线程开局记下每个方块的类型，再分别按其他线程数（包括使用全部处理器核心）
+ * 和延迟计算数值的选项开局，逐个方块比较
+ *
+ * @param rows              行数，超过一个行带才能覆盖多线程散布
+ * @param columns           列数
+ * @param mines             地雷数
+ * @param seeds             种子数
+ * @return                  是否全部相同
+ */
+static _Bool CheckSeedDeterminism(int rows, int columns, int mines, int seeds) {
+    // 命令行参数：线程数和是否延迟计算数值的各种组合
+    static char *arguments[][4] = {
+        { "EngineCheck", "-t", "2", NULL },
+        { "EngineCheck", "-t", "3", NULL },
+        { "EngineCheck", "-t", "0", NULL },
+        { "EngineCheck", "-t", "1", "--lazy" },
+        { "EngineCheck", "-t", "4", "--lazy" },
+    };
+    // 单线程开局的命令行参数
+    static char *single[] = { "EngineCheck", "-t", "1" };
+    // 游戏
+    Game *game = CreateGame();
+    // 命令行选项
+    Options options;
+    // 单线程开局时每个方块的类型
+    BlockType *expected = (BlockType *)malloc(sizeof(BlockType) * (size_t)rows * (size_t)columns);
+    // 种子
+    int seed;
+    // 参数组序号
+    int k;
+    // 行下标、列下标
+    int row, column;
+    // 开局次数、不同的次数
+    long long starts = 0, failures = 0;
+    // 本局是否相同
+    _Bool is_same;
+
+    for (seed = 1; seed <= seeds; seed++) {
+        ParseOptions(&options, 3, single);
+        StartConfiguredGame(game, &options, rows, columns, mines, (uint64_t)seed);
+        for (row = 0; row < rows; row++) {
+            for (column = 0; column < columns; column++) {
+                expected[row * columns + column] = GetBlockType(game->map, row, column);
+            }
+        }
+
+        for (k = 0; k < (int)(sizeof(arguments) / sizeof(arguments[0])); k++) {
+            ParseOptions(&options, arguments[k][3] ? 4 : 3, arguments[k]);
+            starts++;
+            is_same = StartConfiguredGame(game, &options, rows, columns, mines, (uint64_t)seed);
+            for (row = 0; is_same && row < rows; row++) {
+                for (column = 0; is_same && column < columns; column++) {
+                    is_same = GetBlockType(game->map, row, column) == expected[row * columns + column];
+                }
+            }
+            if (! is_same) {
+                failures++;
+                printf("  种子%d：%s %s %s 生成的地图与单线程不同\n",
+                       seed, arguments[k][1], arguments[k][2], arguments[k][3] ? arguments[k][3] : "");
+            }
+        }
+    }
+    free(expected);
+    DestroyMap(&game->map);
+    DestroyGame(&game);
+
+    printf("种子复现（%d行 x %d列，%d个地雷）：%d个种子，%lld次开局，%lld次不同\n",
+           rows, columns, mines, seeds, starts, failures);
+
+    return failures == 0;
+}
+
+/**
+ * 主函数
+ *
+ * @return                  全部一致时为0，否则为1
+ */
+int main() {
+    // 是否全部一致
+    _Bool is_passed = 1;
+
+    is_passed = CheckProbabilityEngine(300) && is_passed;
+    is_passed = CheckLinearSystem(9, 9, 10, 300) && is_passed;
+    is_passed = CheckLinearSystem(16, 30, 99, 100) && is_passed;
+    is_passed = CheckSolver(9, 9, 10, 300) && is_passed;
+    is_passed = CheckSolver(16, 30, 99, 100) && is_passed;
+    is_passed = CheckHintService(9, 9, 10, 200) && is_passed;
+    is_passed = CheckHintService(16, 16, 40, 50) && is_passed;
+    is_passed = CheckRetractedFlag() && is_passed;
+    is_passed = CheckEndgame(16, 16, 40, 300) && is_passed;
+    is_passed = CheckEndgameBruteForce(4, 4, 5, 100) && is_passed;
+    is_passed = CheckEndgameBruteForce(3, 5, 5, 400) && is_passed;
+    is_passed = CheckSeedDeterminism(200, 50, 2000, 20) && is_passed;
+
+    return is_passed ? 0 : 1;
+}
@@ -3,19 +3,19 @@
  * [源文件] 游戏
  * ----------------------------------------------------------------------------
  *
- * 定义扫雷游戏的各个功能函数
+ * 定义扫雷游戏引擎的各个功能函数
+ *
+ * 引擎只负责地图和游戏规则，不做任何输入输出，可以脱离终端界面单独链接使用
  *
  */
 
 
-#include <stdio.h>
 #include <stdlib.h>
-#include <time.h>
-#include <ctype.h>
 #include <string.h>
 #include <limits.h>
 
 #include "game.h"
+#include "neighbor.h"
 
 
 /**
@@ -64,6 +64,9 @@ void InitializeGame(Game *game) {
     game->is_winning = 0;
     // 暂不创建地图，置指针为空
     game->map = NULL;
+    // 尚未操作过方块，结束时从左上角显示地图
+    game->last_row = 0;
+    game->last_column = 0;
 }
 
 /**
@@ -78,6 +81,11 @@ Map * CreateMap(int rows, int columns, int mines) {
     // 地图指针
     Map *map;
 
+    // 方块表（含哨兵方块）过大时，方块下标会溢出，不能创建
+    if (((long long)rows + 2) * ((long long)columns + 2) > MAX_BLOCK_TABLE_SIZE) {
+        return NULL;
+    }
+
     // 为地图分配内存
     map = (Map *)malloc(sizeof(Map));
 
@@ -85,6 +93,11 @@ Map * CreateMap(int rows, int columns, int mines) {
     if (map) {
         // 初始化地图
         InitializeMap(map, rows, columns, mines);
+        // 若方块表分配失败，则释放地图
+        if (! map->blocks) {
+            free(map);
+            map = NULL;
+        }
     }
 
     // 分配成功返回内存地址，失败返回NULL
@@ -97,13 +110,14 @@ Map * CreateMap(int rows, int columns, int mines) {
  * @param map               地图指针的指针
  */
 void DestroyMap(Map **map) {
-    // 行下标
-    int row;
-
-    // 释放方块表各行内存
-    for (row = 0; row < (*map)->number_of_rows; row++) {
-        free((*map)->blocks[row]);
-    }
+    // 释放位平面内存
+    DisableBitPlanes(*map);
+    // 释放密度金字塔内存
+    DisablePyramid(*map);
+    // 释放变更日志内存
+    DisableJournal(*map);
+    // 释放区段栈内存
+    free((*map)->span_stack);
     // 释放整个方块表内存
     free((*map)->blocks);
     // 释放地图内存
@@ -112,6 +126,44 @@ void DestroyMap(Map **map) {
     *map = NULL;
 }
 
+/**
+ * Zobrist键的混合函数（SplitMix64的输出函数）
+ *
+ * 键由方块下标和状态计算得到，而不是查随机数表，使大小相同的地图共用同一组键
+ *
+ * @param value             整数
+ * @return                  混合后的整数
+ */
+static uint64_t ZobristMix(uint64_t value) {
+    value += 0x9E3779B97F4A7C15ULL;
+    value = (value ^ (value >> 30)) * 0xBF58476D1CE4E5B9ULL;
+    value = (value ^ (value >> 27)) * 0x94D049BB133111EBULL;
+
+    return value ^ (value >> 31);
+}
+
+/**
+ * 一个方块的Zobrist键
+ *
+ * 不可见的方块键为0，因此新地图的散列值只由地图大小和地雷数决定；
+ * 可见方块的键包含数值，其他状态只取决于状态
+ *
+ * @param index             方块在方块表中的下标
+ * @param block             方块，可见时数值必须已经计算
+ * @return                  键
+ */
+static uint64_t ZobristKey(int index, Block block) {
+    // 状态
+    BlockStatus status = BLOCK_STATUS_OF(block);
+
+    if (status == BLOCK_STATUS_INVISIBLE) {
+        return 0;
+    }
+
+    return ZobristMix((uint64_t)index << 6 | (uint64_t)status << 4
+                      | (status == BLOCK_STATUS_VISIBLE ? (uint64_t)BLOCK_TYPE_OF(block) : 0));
+}
+
 /**
  * 初始化地图
  *
@@ -121,8 +173,8 @@ void DestroyMap(Map **map) {
  * @param mines             地雷数
  */
 void InitializeMap(Map *map, int rows, int columns, int mines) {
-    // 行下标
-    int row;
+    // 位平面编号
+    int plane;
 
     // 设置行数
     map->number_of_rows = rows;
@@ -131,7 +183,7 @@ void InitializeMap(Map *map, int rows, int columns, int mines) {
     // 设置地雷数
     map->number_of_mines = mines;
     // 计算方块总数
-    map->number_of_blocks = map->number_of_rows * map->number_of_columns;
+    map->number_of_blocks = (long long)map->number_of_rows * map->number_of_columns;
     // 设置可见方块数
     map->number_of_visible_blocks = 0;
     // 设置不可见方块数
@@ -143,306 +195,678 @@ void InitializeMap(Map *map, int rows, int columns, int mines) {
     // 设置可见地雷数
     map->number_of_visible_mine_blocks = 0;
 
-    // 为方块表分配内存
-    // 分配行指针数组内存
-    map->blocks = (Block**)malloc(sizeof(Block *) * map->number_of_rows);
-    // 分配每行的方块内存
-    for (row = 0; row < map->number_of_rows; row++) {
-        map->blocks[row] = (Block *)malloc(sizeof(Block) * map->number_of_columns);
+    // 默认在散布地雷时计算全部数值
+    map->is_lazy = 0;
+    // 计算行跨度
+    map->stride = map->number_of_columns + 2;
+    // 计算周围8个方块的下标偏移量：左上、正上、右上、正左、正右、左下、正下、右下
+    map->neighbor_offsets[0] = -map->stride - 1;
+    map->neighbor_offsets[1] = -map->stride;
+    map->neighbor_offsets[2] = -map->stride + 1;
+    map->neighbor_offsets[3] = -1;
+    map->neighbor_offsets[4] = 1;
+    map->neighbor_offsets[5] = map->stride - 1;
+    map->neighbor_offsets[6] = map->stride;
+    map->neighbor_offsets[7] = map->stride + 1;
+    // 计算位平面每行的字数
+    map->words_per_row = (map->number_of_columns + 63) / 64;
+    // 位平面默认不启用
+    for (plane = 0; plane < NUMBER_OF_BIT_PLANES; plane++) {
+        map->bit_planes[plane] = NULL;
+    }
+    // 密度金字塔默认不启用
+    map->pyramid = NULL;
+    // 变更日志默认不启用
+    map->journal = NULL;
+    map->journal_length = 0;
+    map->journal_capacity = 0;
+    // 全部方块不可见，散列值只由地图大小和地雷数决定
+    map->hash = ZobristMix(ZobristMix((uint64_t)(unsigned)rows << 32 | (unsigned)columns) ^ (uint64_t)(unsigned)mines);
+    // 区段栈在第一次翻开空白区域时再分配
+    map->span_stack = NULL;
+    map->span_stack_capacity = 0;
+    // 尚未散布地雷，种子置为0
+    map->seed = 0;
+
+    // 为方块表分配内存，整个方块表（含四周的哨兵方块）只分配一次
+    // 不可见的空白方块编码为0，因此分配时清零即完成内部方块的初始化，
+    // 大地图的内存页直到第一次写入时才真正分配
+    map->blocks = (Block *)calloc((size_t)(map->number_of_rows + 2) * (size_t)map->stride, sizeof(Block));
+    // 设置哨兵方块
+    if (map->blocks) {
+        SetSentinelBlocks(map->blocks, map->number_of_rows, map->number_of_columns);
+    }
+}
+
+/**
+ * 设置方块表四周的哨兵方块
+ *
+ * 哨兵方块被设置为可见的空白方块，
+ * 这样遍历周围方块时不需要判断边界：哨兵方块既不是地雷，也不会被翻开或入栈
+ *
+ * @param blocks            方块表指针
+ * @param rows              行数
+ * @param columns           列数
+ */
+void SetSentinelBlocks(Block *blocks, int rows, int columns) {
+    // 行下标
+    int row;
+    // 行跨度
+    int stride = columns + 2;
+
+    // 首行和末行
+    memset(blocks, MAKE_BLOCK(BLOCK_TYPE_BLANK, BLOCK_STATUS_VISIBLE), (size_t)stride);
+    memset(blocks + (size_t)(rows + 1) * stride, MAKE_BLOCK(BLOCK_TYPE_BLANK, BLOCK_STATUS_VISIBLE), (size_t)stride);
+    // 每行的首列和末列
+    for (row = 1; row <= rows; row++) {
+        blocks[(size_t)row * stride] = MAKE_BLOCK(BLOCK_TYPE_BLANK, BLOCK_STATUS_VISIBLE);
+        blocks[(size_t)row * stride + stride - 1] = MAKE_BLOCK(BLOCK_TYPE_BLANK, BLOCK_STATUS_VISIBLE);
     }
-    // 清空方块表
-    ClearBlockTable(map->blocks, map->number_of_rows, map->number_of_columns);
 }
 
 /**
  * 清空方块表
  *
+ * 内部方块设置为不可见的空白方块，四周设置哨兵方块
+ *
  * @param blocks            方块表指针
  * @param rows              行数
  * @param columns           列数
  */
-void ClearBlockTable(Block **blocks, int rows, int columns) {
+void ClearBlockTable(Block *blocks, int rows, int columns) {
     // 行下标
     int row;
-    // 列下标
-    int column;
+    // 行跨度
+    int stride = columns + 2;
 
-    for (row = 0; row < rows; row++) {
-        for (column = 0; column < columns; column++) {
-            // 类型设置为空
-            blocks[row][column].type = BLOCK_TYPE_BLANK;
-            // 状态设置为不可见
-            blocks[row][column].status = BLOCK_STATUS_INVISIBLE;
-        }
+    for (row = 1; row <= rows; row++) {
+        memset(blocks + (size_t)row * stride + 1, MAKE_BLOCK(BLOCK_TYPE_BLANK, BLOCK_STATUS_INVISIBLE), (size_t)columns);
     }
+    SetSentinelBlocks(blocks, rows, columns);
 }
 
 /**
  * 随机散布地雷
  *
+ * 使用Floyd抽样算法从全部方块中不重复地恰好抽取地雷数个方块，
+ * 每个地雷只需生成一个随机数，没有冲突重试。
+ * 随机数发生器保存在地图中，相同的种子总是生成完全相同的地图。
+ *
  * @param map               地图指针
+ * @param seed              随机数种子，为0时自动生成
+ * @return                  实际使用的随机数种子
  */
-void RandomDistributeMines(Map *map) {
-    // 行下标
-    int row = 0;
-    // 列下标
-    int column = 0;
-    // 地雷计数
-    int mine = 0;
-
-    // 将当前时间设置为随机数种子
-    srand((unsigned)time(NULL));
+uint64_t RandomDistributeMines(Map *map, uint64_t seed) {
+    // 方块总数
+    uint64_t total = (uint64_t)map->number_of_rows * (uint64_t)map->number_of_columns;
+    // 抽样序号
+    uint64_t j;
+    // 抽中的方块序号
+    uint64_t t;
+
+    // 设置随机数种子
+    if (seed == 0) {
+        seed = GenerateSeed();
+    }
+    map->seed = seed;
+    SeedRandom(&map->random, seed);
 
     /*
      * 将地雷散布到地图中
      */
 
-    for (mine = 0; mine < map->number_of_mines; mine++) {
-        // 随机行下标
-        row = rand() % map->number_of_rows;
-        // 随机列下标
-        column = rand() % map->number_of_columns;
-
-        // 若该方块类型为空，则放置地雷
-        if (map->blocks[row][column].type == BLOCK_TYPE_BLANK) {
-            map->blocks[row][column].type = BLOCK_TYPE_MINE;
-        }
-        // 否则，不放置，等待下一轮
-        else {
-            mine--;
+    // Floyd抽样：对 j = N - M, ..., N - 1，在[0, j]中随机取t，
+    // 若t已是地雷，则改为在j处放置地雷（j此前不可能被选中）
+    for (j = total - (uint64_t)map->number_of_mines; j < total; j++) {
+        t = RandomBelow(&map->random, j + 1);
+        if (BLOCK_TYPE_OF(BLOCK_AT(map, (int)(t / map->number_of_columns), (int)(t % map->number_of_columns))) == BLOCK_TYPE_MINE) {
+            t = j;
         }
+        SET_BLOCK_TYPE(BLOCK_AT(map, (int)(t / map->number_of_columns), (int)(t % map->number_of_columns)), BLOCK_TYPE_MINE);
     }
 
     /*
      * 计算地雷周围的数值
      */
 
-    // 遍历每一个方块
+    // 按整行向量化计算，哨兵方块不是地雷，因此无需判断边界
+    // 延迟计算数值的地图跳过这一步，耗时只与地雷数成正比
+    if (! map->is_lazy) {
+        CountNeighborMines(map->blocks, map->stride, map->number_of_columns, 0, map->number_of_rows);
+    }
+
+    // 同步位平面
+    if (map->bit_planes[BIT_PLANE_MINE]) {
+        RebuildBitPlanes(map);
+    }
+
+    return seed;
+}
+
+/**
+ * 取得方块类型，必要时计算并缓存数值
+ *
+ * 只能用于内部方块，哨兵方块可见，调用前应先排除可见方块或确认下标在地图范围内
+ *
+ * @param map               地图指针
+ * @param index             方块在方块表中的下标
+ * @return                  方块类型
+ */
+static BlockType ResolveBlockType(Map *map, int index) {
+    // 方块
+    Block block = map->blocks[index];
+    // 邻居序号
+    int k;
+    // 周围地雷数
+    int count = 0;
+
+    if (! map->is_lazy || (block & BLOCK_RESOLVED) || BLOCK_TYPE_OF(block) == BLOCK_TYPE_MINE) {
+        return BLOCK_TYPE_OF(block);
+    }
+
+    for (k = 0; k < 8; k++) {
+        count += BLOCK_TYPE_OF(map->blocks[index + map->neighbor_offsets[k]]) == BLOCK_TYPE_MINE;
+    }
+    map->blocks[index] = (Block)((block & ~BLOCK_TYPE_MASK) | count | BLOCK_RESOLVED);
+
+    return (BlockType)count;
+}
+
+/**
+ * 查询方块类型
+ *
+ * 延迟计算数值的地图会在此时计算并缓存该方块的数值
+ *
+ * @param map               地图指针
+ * @param row               行下标
+ * @param column            列下标
+ * @return                  方块类型
+ */
+BlockType GetBlockType(Map *map, int row, int column) {
+    return ResolveBlockType(map, BLOCK_INDEX(map, row, column));
+}
+
+/**
+ * 查询方块状态
+ *
+ * @param map               地图指针
+ * @param row               行下标
+ * @param column            列下标
+ * @return                  方块状态
+ */
+BlockStatus GetBlockStatus(Map *map, int row, int column) {
+    return BLOCK_STATUS_OF(BLOCK_AT(map, row, column));
+}
+
+/**
+ * 启用位平面
+ *
+ * 位平面是方块表的附加视图，地雷、可见、旗标、疑问标各占一个平面，
+ * 每个方块占1位，可以按64位字整体扫描
+ *
+ * @param map               地图指针
+ * @return                  是否启用成功
+ */
+_Bool EnableBitPlanes(Map *map) {
+    // 位平面编号
+    int plane;
+    // 每个位平面的字数
+    size_t words = (size_t)map->words_per_row * (size_t)map->number_of_rows;
+
+    // 若已启用，则无需处理
+    if (map->bit_planes[BIT_PLANE_MINE]) {
+        return 1;
+    }
+
+    // 为各位平面分配内存
+    for (plane = 0; plane < NUMBER_OF_BIT_PLANES; plane++) {
+        map->bit_planes[plane] = (uint64_t *)malloc(sizeof(uint64_t) * words);
+        // 若分配失败，则释放已分配的位平面
+        if (! map->bit_planes[plane]) {
+            DisableBitPlanes(map);
+            return 0;
+        }
+    }
+
+    // 根据方块表填充位平面
+    RebuildBitPlanes(map);
+
+    return 1;
+}
+
+/**
+ * 停用位平面
+ *
+ * @param map               地图指针
+ */
+void DisableBitPlanes(Map *map) {
+    // 位平面编号
+    int plane;
+
+    for (plane = 0; plane < NUMBER_OF_BIT_PLANES; plane++) {
+        free(map->bit_planes[plane]);
+        map->bit_planes[plane] = NULL;
+    }
+}
+
+/**
+ * 根据方块表重建位平面
+ *
+ * @param map               地图指针
+ */
+void RebuildBitPlanes(Map *map) {
+    // 行下标
+    int row;
+    // 列下标
+    int column;
+    // 方块
+    Block block;
+    // 字下标
+    size_t word;
+    // 位掩码
+    uint64_t bit;
+    // 位平面编号
+    int plane;
+
+    // 清空各位平面
+    for (plane = 0; plane < NUMBER_OF_BIT_PLANES; plane++) {
+        memset(map->bit_planes[plane], 0, sizeof(uint64_t) * (size_t)map->words_per_row * (size_t)map->number_of_rows);
+    }
+
+    // 逐个方块设置对应的位
     for (row = 0; row < map->number_of_rows; row++) {
         for (column = 0; column < map->number_of_columns; column++) {
-            // 如果当前方块不为地雷
-            if (map->blocks[row][column].type != BLOCK_TYPE_MINE) {
-                // 若上一行存在
-                if (row - 1 >= 0) {
-                    // 若左一列存在，且左上方为地雷
-                    if (column - 1 >= 0 && map->blocks[row - 1][column - 1].type == BLOCK_TYPE_MINE) {
-                        map->blocks[row][column].type++;
-                    }
-                    // 若正上方为地雷
-                    if (map->blocks[row - 1][column].type == BLOCK_TYPE_MINE) {
-                        map->blocks[row][column].type++;
-                    }
-                    // 若右一列存在，且右上方为地雷
-                    if (column + 1 < map->number_of_columns && map->blocks[row - 1][column + 1].type == BLOCK_TYPE_MINE) {
-                        map->blocks[row][column].type++;
-                    }
-                }
+            block = BLOCK_AT(map, row, column);
+            word = (size_t)row * map->words_per_row + column / 64;
+            bit = (uint64_t)1 << (column % 64);
 
-                // 若左一列存在，且正左方为地雷
-                if (column - 1 >= 0 && map->blocks[row][column - 1].type == BLOCK_TYPE_MINE) {
-                    map->blocks[row][column].type++;
-                }
-                // 若右一列存在，且正右方为地雷
-                if (column + 1 < map->number_of_columns && map->blocks[row][column + 1].type == BLOCK_TYPE_MINE) {
-                    map->blocks[row][column].type++;
-                }
-
-                // 若下一行存在
-                if (row + 1 < map->number_of_rows) {
-                    // 若左一列存在，且左下方为地雷
-                    if (column - 1 >= 0 && map->blocks[row + 1][column - 1].type == BLOCK_TYPE_MINE) {
-                        map->blocks[row][column].type++;
-                    }
-                    // 若正下方为地雷
-                    if (map->blocks[row + 1][column].type == BLOCK_TYPE_MINE) {
-                        map->blocks[row][column].type++;
-                    }
-                    // 若右一列存在，且右下方为地雷
-                    if (column + 1 < map->number_of_columns && map->blocks[row + 1][column + 1].type == BLOCK_TYPE_MINE) {
-                        map->blocks[row][column].type++;
-                    }
-                }
+            if (BLOCK_TYPE_OF(block) == BLOCK_TYPE_MINE) {
+                map->bit_planes[BIT_PLANE_MINE][word] |= bit;
+            }
+            if (BLOCK_STATUS_OF(block) == BLOCK_STATUS_VISIBLE) {
+                map->bit_planes[BIT_PLANE_VISIBLE][word] |= bit;
+            } else if (BLOCK_STATUS_OF(block) == BLOCK_STATUS_FLAG) {
+                map->bit_planes[BIT_PLANE_FLAG][word] |= bit;
+            } else if (BLOCK_STATUS_OF(block) == BLOCK_STATUS_DOUBT) {
+                map->bit_planes[BIT_PLANE_DOUBT][word] |= bit;
             }
         }
     }
 }
 
 /**
- * 打印地图
+ * 查询位平面中的一位
+ *
+ * @param map               地图指针
+ * @param plane             位平面编号
+ * @param row               行下标
+ * @param column            列下标
+ * @return                  该位是否为1
+ */
+_Bool TestBitPlane(Map *map, BitPlane plane, int row, int column) {
+    return (map->bit_planes[plane][(size_t)row * map->words_per_row + column / 64] >> (column % 64)) & 1;
+}
+
+/**
+ * 启用密度金字塔
+ *
+ * 启用后每次方块状态改变都会同步更新各层瓦片的统计，
+ * 绘制总览图时无需扫描方块表
+ *
+ * @param map               地图指针
+ * @return                  是否启用成功
+ */
+_Bool EnablePyramid(Map *map) {
+    // 若已启用，则无需处理
+    if (map->pyramid) {
+        return 1;
+    }
+
+    map->pyramid = CreatePyramid(map->number_of_rows, map->number_of_columns);
+    if (! map->pyramid) {
+        return 0;
+    }
+
+    // 根据方块表填充统计
+    RebuildPyramid(map);
+
+    return 1;
+}
+
+/**
+ * 停用密度金字塔
  *
  * @param map               地图指针
  */
-void PrintMap(Map *map) {
-    // 行编号输出宽度
-    int row_number_width = 0;
-    // 列编号输出宽度
-    int column_number_width = 0;
-    // 行编号转换说明
-    char row_number_conversion[100];
-    // 列编号转换说明
-    char column_number_conversion[100];
+void DisablePyramid(Map *map) {
+    DestroyPyramid(&map->pyramid);
+}
+
+/**
+ * 根据方块表重建密度金字塔
+ *
+ * 先逐个方块累计第0层，再逐层汇总
+ *
+ * @param map               地图指针
+ */
+void RebuildPyramid(Map *map) {
     // 行下标
     int row;
     // 列下标
     int column;
-    // 临时整数
-    int n;
-    // 循环下标
-    int i;
-    // 输出宽度
-    int width;
-    // 居中前导空格数
-    int center_prefix_space_number;
-
-    // 计算行编号最大数字位数
-    n = map->number_of_rows;
-    while (n) {
-        row_number_width++;
-        n /= 10;
-    }
-    // 计算行编号转换说明
-    sprintf(row_number_conversion, "%%%dd ", row_number_width);
-
-    // 计算列编号最大数字位数
-    n = map->number_of_columns;
-    while (n) {
-        column_number_width++;
-        n /= 10;
-    }
-    // 最小宽度为3
-    column_number_width = column_number_width >= 3 ? column_number_width : 3;
-    // 计算列编号转换说明
-    sprintf(column_number_conversion, " %%-%dd", column_number_width);
-
-    // 计算输出宽度
-    width = row_number_width + 1 + (1 + column_number_width) * map->number_of_columns + 1;
-    // 计算居中前导空格数
-    center_prefix_space_number = (CONSOLE_WIDTH - width) / 2;
+    // 方块状态
+    BlockStatus status;
+    // 瓦片
+    PyramidTile *tile;
 
-    /*
-     * 打印表头
-     */
+    ClearPyramid(map->pyramid);
 
-    // 第一行
-    printf(BLOCK_TABLE_STYLE);
-    // 居中前导空格
-    for (i = 0; i < center_prefix_space_number; i++) {
-        printf(" ");
-    }
-    // 表格前导空格
-    for (i = 0; i < row_number_width + 1; i++) {
-        printf(" ");
-    }
-    // 列编号
-    for (column = 0; column < map->number_of_columns; column++) {
-        printf(column_number_conversion, column + 1);
-    }
-    printf(" \n");
-    // 第二行
-    // 居中前导空格
-    for (i = 0; i < center_prefix_space_number; i++) {
-        printf(" ");
-    }
-    // 表格前导空格
-    for (i = 0; i < row_number_width + 1; i++) {
-        printf(" ");
-    }
-    // 顶部标尺线
-    for (column = 0; column < map->number_of_columns; column++) {
-        printf("+");
-        for (i = 0; i < column_number_width; i++) {
-            printf("-");
+    for (row = 0; row < map->number_of_rows; row++) {
+        for (column = 0; column < map->number_of_columns; column++) {
+            status = BLOCK_STATUS_OF(BLOCK_AT(map, row, column));
+            if (status == BLOCK_STATUS_VISIBLE || status == BLOCK_STATUS_FLAG) {
+                tile = GetPyramidTile(map->pyramid, 0, row >> PYRAMID_BASE_SHIFT, column >> PYRAMID_BASE_SHIFT);
+                tile->visible += status == BLOCK_STATUS_VISIBLE;
+                tile->flags += status == BLOCK_STATUS_FLAG;
+            }
         }
     }
-    printf("+\n");
-    printf(CLEAR_STYLE);
 
-    /*
-     * 打印每一行
-     */
-    for (row = 0; row < map->number_of_rows; row++) {
-        // 第一行
-        // 居中前导空格
-        for (i = 0; i < center_prefix_space_number; i++) {
-            printf(" ");
+    AccumulatePyramid(map->pyramid);
+}
+
+/**
+ * 启用变更日志
+ *
+ * 启用后每次方块状态改变都会追加一条记录，
+ * 使用者各自保存读到的位置，之后只处理新增的记录，无需重新扫描方块表
+ *
+ * @param map               地图指针
+ * @return                  是否启用成功
+ */
+_Bool EnableJournal(Map *map) {
+    // 若已启用，则无需处理
+    if (map->journal) {
+        return 1;
+    }
+
+    map->journal = (JournalEntry *)malloc(sizeof(JournalEntry) * 256);
+    if (! map->journal) {
+        return 0;
+    }
+    map->journal_length = 0;
+    map->journal_capacity = 256;
+
+    return 1;
+}
+
+/**
+ * 停用变更日志
+ *
+ * @param map               地图指针
+ */
+void DisableJournal(Map *map) {
+    free(map->journal);
+    map->journal = NULL;
+    map->journal_length = 0;
+    map->journal_capacity = 0;
+}
+
+/**
+ * 向变更日志追加一条记录
+ *
+ * 日志满时扩容为原来的2倍；内存不足时丢弃这条记录，
+ * 使用者只把日志当作需要重新检查的位置，漏掉记录不会导致错误的结果
+ *
+ * @param map               地图指针
+ * @param index             方块在方块表中的下标
+ * @param previous          改变前的方块
+ */
+static void AppendJournal(Map *map, int index, Block previous) {
+    // 新容量
+    size_t capacity;
+    // 新的日志内存
+    JournalEntry *journal;
+
+    if (map->journal_length == map->journal_capacity) {
+        capacity = map->journal_capacity * 2;
+        journal = (JournalEntry *)realloc(map->journal, sizeof(JournalEntry) * capacity);
+        if (! journal) {
+            return;
         }
-        // 行编号
-        printf(BLOCK_TABLE_STYLE);
-        printf(row_number_conversion, row + 1);
-        printf(CLEAR_STYLE);
+        map->journal = journal;
+        map->journal_capacity = capacity;
+    }
 
-        // 行方块
-        for (column = 0; column < map->number_of_columns; column++) {
-            printf(BLOCK_TABLE_STYLE);
-            printf("|");
-            // 左边空格
-            for (i = 0; i < (column_number_width - 1) / 2 - 1; i++) {
-                printf(" ");
-            }
-            printf(CLEAR_STYLE);
-            // 打印标识字符
-            if (map->blocks[row][column].status == BLOCK_STATUS_INVISIBLE) {
-                printf(INVISIBLE_BLOCK_STYLE);
-                printf("   ");
-                printf(CLEAR_STYLE);
-            } else if (map->blocks[row][column].status == BLOCK_STATUS_FLAG) {
-                printf(FLAG_BLOCK_STYLE);
-                printf(" F ");
-                printf(CLEAR_STYLE);
-            } else if (map->blocks[row][column].status == BLOCK_STATUS_DOUBT) {
-                printf(DOUBT_BLOCK_STYLE);
-                printf(" ? ");
-                printf(CLEAR_STYLE);
-            } else if (map->blocks[row][column].type == BLOCK_TYPE_BLANK) {
-                printf("   ");
-            } else if (map->blocks[row][column].type >= BLOCK_TYPE_NUMBER_1 && map->blocks[row][column].type <= BLOCK_TYPE_NUMBER_8) {
-                printf(NUMBER_BLOCK_STYLE);
-                printf(" %d ", map->blocks[row][column].type);
-                printf(CLEAR_STYLE);
-            } else {
-                printf(MINE_BLOCK_STYLE);
-                printf(" * ");
-                printf(CLEAR_STYLE);
-            }
+    map->journal[map->journal_length].index = index;
+    map->journal[map->journal_length].previous = previous;
+    map->journal_length++;
+}
 
-//            if (map->blocks[row][column].type == BLOCK_TYPE_BLANK) {
-//                printf(" ");
-//            } else if (map->blocks[row][column].type == BLOCK_TYPE_MINE) {
-//                printf("*");
-//            } else {
-//                printf("%d", map->blocks[row][column].type);
-//            }
-
-            // 右边空格
-            printf(BLOCK_TABLE_STYLE);
-            for (i = 0; i < (column_number_width - 1) - ((column_number_width - 1) / 2) - 1; i++) {
-                printf(" ");
-            }
-            printf(CLEAR_STYLE);
+/**
+ * 方块状态对应的位平面，不可见状态没有对应的位平面
+ */
+static const int STATUS_BIT_PLANES[] = {
+    // 不可见
+    -1,
+    // 旗标
+    BIT_PLANE_FLAG,
+    // 疑问标
+    BIT_PLANE_DOUBT,
+    // 可见
+    BIT_PLANE_VISIBLE,
+};
+
+/**
+ * 设置方块状态，并同步位平面、各统计数据、散列值和变更日志
+ *
+ * 统计数据只根据状态的实际变化增减，不再遍历整个方块表
+ *
+ * @param map               地图指针
+ * @param index             方块在方块表中的下标
+ * @param status            方块的目标状态
+ */
+static void SetBlockStatus(Map *map, int index, BlockStatus status) {
+    // 旧方块
+    Block block = map->blocks[index];
+    // 旧状态
+    BlockStatus previous = BLOCK_STATUS_OF(block);
+    // 列下标
+    int column;
+    // 字下标
+    size_t word;
+    // 位掩码
+    uint64_t bit;
+
+    // 状态未改变，则无需处理
+    if (previous == status) {
+        return;
+    }
+
+    SET_BLOCK_STATUS(map->blocks[index], status);
+    // 翻开时计算数值
+    if (status == BLOCK_STATUS_VISIBLE) {
+        ResolveBlockType(map, index);
+    }
+
+    // 撤销旧状态的统计
+    if (previous == BLOCK_STATUS_FLAG) {
+        map->number_of_flags--;
+    } else if (previous == BLOCK_STATUS_DOUBT) {
+        map->number_of_doubts--;
+    }
+    // 计入新状态的统计
+    if (status == BLOCK_STATUS_FLAG) {
+        map->number_of_flags++;
+    } else if (status == BLOCK_STATUS_DOUBT) {
+        map->number_of_doubts++;
+    } else if (status == BLOCK_STATUS_VISIBLE) {
+        // 可见方块不会再变为其他状态，因此只需增加
+        map->number_of_visible_blocks++;
+        map->number_of_invisible_blocks--;
+        if (BLOCK_TYPE_OF(map->blocks[index]) == BLOCK_TYPE_MINE) {
+            map->number_of_visible_mine_blocks++;
         }
-        printf(BLOCK_TABLE_STYLE);
-        printf("|\n");
-        printf(CLEAR_STYLE);
-        // 第二行
-        printf(BLOCK_TABLE_STYLE);
-        // 居中前导空格
-        for (i = 0; i < center_prefix_space_number; i++) {
-            printf(" ");
+    }
+
+    // 同步散列值：异或掉旧状态的键，异或上新状态的键
+    map->hash ^= ZobristKey(index, block) ^ ZobristKey(index, map->blocks[index]);
+
+    // 同步位平面
+    if (map->bit_planes[BIT_PLANE_MINE]) {
+        column = index % map->stride - 1;
+        word = (size_t)(index / map->stride - 1) * map->words_per_row + column / 64;
+        bit = (uint64_t)1 << (column % 64);
+
+        if (STATUS_BIT_PLANES[previous] >= 0) {
+            map->bit_planes[STATUS_BIT_PLANES[previous]][word] &= ~bit;
         }
-        // 表格前导空格
-        for (i = 0; i < row_number_width + 1; i++) {
-            printf(" ");
+        if (STATUS_BIT_PLANES[status] >= 0) {
+            map->bit_planes[STATUS_BIT_PLANES[status]][word] |= bit;
         }
-        // 行间分隔标尺线
-        for (column = 0; column < map->number_of_columns; column++) {
-            printf("+");
-            for (i = 0; i < column_number_width; i++) {
-                printf("-");
+    }
+
+    // 同步密度金字塔，疑问标按未翻开统计
+    if (map->pyramid && (previous == BLOCK_STATUS_FLAG || status == BLOCK_STATUS_FLAG || status == BLOCK_STATUS_VISIBLE)) {
+        AdjustPyramid(map->pyramid, index / map->stride - 1, index % map->stride - 1,
+                      status == BLOCK_STATUS_VISIBLE,
+                      (status == BLOCK_STATUS_FLAG) - (previous == BLOCK_STATUS_FLAG));
+    }
+
+    // 记录变更日志
+    if (map->journal) {
+        AppendJournal(map, index, block);
+    }
+}
+
+/**
+ * 将一个区段压入区段栈
+ *
+ * @param map               地图指针
+ * @param top               栈顶（已用元素数）指针
+ * @param left              区段左端下标
+ * @param right             区段右端下标
+ * @return                  是否压入成功
+ */
+static _Bool PushSpan(Map *map, int *top, int left, int right) {
+    // 新容量
+    int capacity;
+    // 新的栈内存
+    int *stack;
+
+    // 栈满时扩容为原来的2倍
+    if (*top + 2 > map->span_stack_capacity) {
+        capacity = map->span_stack_capacity ? map->span_stack_capacity * 2 : 256;
+        stack = (int *)realloc(map->span_stack, sizeof(int) * (size_t)capacity);
+        if (! stack) {
+            return 0;
+        }
+        map->span_stack = stack;
+        map->span_stack_capacity = capacity;
+    }
+
+    map->span_stack[(*top)++] = left;
+    map->span_stack[(*top)++] = right;
+
+    return 1;
+}
+
+/**
+ * 从指定方块开始，在同一行中找出连续的不可见空白方块，将其翻开并作为一个区段入栈
+ *
+ * @param map               地图指针
+ * @param top               栈顶（已用元素数）指针
+ * @param index             起始方块下标，该方块必须是空白方块
+ * @param is_complete       是否完整入栈的指针，入栈失败时被置为0
+ * @return                  区段右端下标
+ */
+static int RevealSpan(Map *map, int *top, int index, _Bool *is_complete) {
+    // 区段左端下标
+    int left = index;
+    // 区段右端下标
+    int right = index;
+    // 方块下标
+    int i;
+
+    // 向左、向右扩展，哨兵方块可见，因此扩展一定会在边界处停止
+    while (BLOCK_STATUS_OF(map->blocks[left - 1]) != BLOCK_STATUS_VISIBLE && ResolveBlockType(map, left - 1) == BLOCK_TYPE_BLANK) {
+        left--;
+    }
+    while (BLOCK_STATUS_OF(map->blocks[right + 1]) != BLOCK_STATUS_VISIBLE && ResolveBlockType(map, right + 1) == BLOCK_TYPE_BLANK) {
+        right++;
+    }
+
+    // 入栈前先翻开，以防止同一个区段被重复入栈
+    for (i = left; i <= right; i++) {
+        SetBlockStatus(map, i, BLOCK_STATUS_VISIBLE);
+    }
+    // 区段栈无法扩容时，该区段的相邻行不会再被处理
+    if (! PushSpan(map, top, left, right)) {
+        *is_complete = 0;
+    }
+
+    return right;
+}
+
+/**
+ * 翻开一片空白区域
+ *
+ * 以区段为单位做扫描线填充：每个区段是同一行中连续的空白方块，
+ * 出栈时翻开区段两端以及上下两行对应范围（左右各多1列）内的方块，
+ * 并把其中遇到的不可见空白方块扩展成新的区段入栈。
+ * 翻开的方块与逐个方块处理周围8个方块的结果完全相同。
+ * 区段栈无法扩容时，仍会处理完已入栈的区段，但空白区域只被部分翻开。
+ *
+ * @param map               地图指针
+ * @param index             起始方块下标，该方块必须是已翻开的空白方块
+ * @return                  是否完整翻开了空白区域
+ */
+static _Bool RevealBlankRegion(Map *map, int index) {
+    // 栈顶（已用元素数）
+    int top = 0;
+    // 是否所有区段都成功入栈
+    _Bool is_complete = 1;
+    // 区段左端下标
+    int left;
+    // 区段右端下标
+    int right;
+    // 相邻行偏移量
+    int offset;
+    // 方块下标
+    int i;
+    // 相邻行序号
+    int k;
+
+    // 起始方块所在的区段入栈
+    RevealSpan(map, &top, index, &is_complete);
+
+    // 当栈不空时，一直执行
+    while (top > 0) {
+        // 取出栈顶区段
+        right = map->span_stack[--top];
+        left = map->span_stack[--top];
+
+        // 翻开区段左右两端的方块
+        SetBlockStatus(map, left - 1, BLOCK_STATUS_VISIBLE);
+        SetBlockStatus(map, right + 1, BLOCK_STATUS_VISIBLE);
+
+        // 处理上一行和下一行
+        for (k = 0; k < 2; k++) {
+            offset = k == 0 ? -map->stride : map->stride;
+            for (i = left - 1 + offset; i <= right + 1 + offset; i++) {
+                // 不可见空白方块扩展为新的区段，并跳过整个区段
+                if (BLOCK_STATUS_OF(map->blocks[i]) != BLOCK_STATUS_VISIBLE && ResolveBlockType(map, i) == BLOCK_TYPE_BLANK) {
+                    i = RevealSpan(map, &top, i, &is_complete);
+                }
+                // 其他方块直接翻开
+                else {
+                    SetBlockStatus(map, i, BLOCK_STATUS_VISIBLE);
+                }
             }
         }
-        printf("+\n");
-        printf(CLEAR_STYLE);
     }
+
+    return is_complete;
 }
 
 /**
@@ -452,7 +876,7 @@ void PrintMap(Map *map) {
  * @param row               行下标
  * @param column            列下标
  * @param status            方块的目标状态
- * @return                  是否处理成功
+ * @return                  是否处理成功，空白区域因内存不足未能完整翻开时也返回0
  */
 _Bool HandleBlock(Map *map, int row, int column, BlockStatus status) {
     /*
@@ -468,543 +892,156 @@ _Bool HandleBlock(Map *map, int row, int column, BlockStatus status) {
         return 0;
     }
     // 若该方块已可见，则不可处理
-    if (map->blocks[row][column].status == BLOCK_STATUS_VISIBLE) {
+    if (BLOCK_STATUS_OF(BLOCK_AT(map, row, column)) == BLOCK_STATUS_VISIBLE) {
         return 0;
     }
 
     // 将方块设置为指定状态
-    map->blocks[row][column].status = status;
+    SetBlockStatus(map, BLOCK_INDEX(map, row, column), status);
 
     // 若当前方块为可见，且为空白方块，则将周围方块都设置为可见
-    if (map->blocks[row][column].status == BLOCK_STATUS_VISIBLE && map->blocks[row][column].type == BLOCK_TYPE_BLANK) {
-        // 结构体：位置，用于保存空白方块的行、列下标
-        typedef struct {
-            int row;
-            int column;
-        } Position;
-
-        // 栈，保存空白方块的位置信息
-        // 最大元素数一定不超过方块总数
-        Position *stack = (Position *)malloc(sizeof(Position) * map->number_of_rows * map->number_of_columns);
-        // 栈顶下标
-        int stack_top_index = -1;
-
-        // 将当前方块入栈
-        stack_top_index++;
-        stack[stack_top_index].row = row;
-        stack[stack_top_index].column = column;
-
-        // 当栈不空时，一直执行
-        while (stack_top_index >= 0) {
-            // 取出栈顶元素的位置信息
-            row = stack[stack_top_index].row;
-            column = stack[stack_top_index].column;
-            // 将栈顶元素出栈
-            stack_top_index--;
-
-            // 若上一行存在
-            if (row - 1 >= 0) {
-                // 若左列存在
-                if (column - 1 >= 0) {
-                    // 若左上方为空白方块且不可见，则入栈
-                    // 入栈要在设置可见之前做，以防止2个相邻的空白方块反复将对方入栈
-                    if (map->blocks[row - 1][column - 1].type == BLOCK_TYPE_BLANK && map->blocks[row - 1][column - 1].status != BLOCK_STATUS_VISIBLE) {
-                        stack_top_index++;
-                        stack[stack_top_index].row = row - 1;
-                        stack[stack_top_index].column = column - 1;
-                    }
-                    // 将左上方方块设置为可见
-                    map->blocks[row - 1][column - 1].status = BLOCK_STATUS_VISIBLE;
-                }
-
-                // 若正上方为空白方块且不可见，则入栈
-                if (map->blocks[row - 1][column].type == BLOCK_TYPE_BLANK && map->blocks[row - 1][column].status != BLOCK_STATUS_VISIBLE) {
-                    stack_top_index++;
-                    stack[stack_top_index].row = row - 1;
-                    stack[stack_top_index].column = column;
-                }
-                // 将正上方方块设置为可见
-                map->blocks[row - 1][column].status = BLOCK_STATUS_VISIBLE;
-
-                // 若右列存在
-                if (column + 1 < map->number_of_columns) {
-                    // 若右上方为空白方块且不可见，则入栈
-                    if (map->blocks[row - 1][column + 1].type == BLOCK_TYPE_BLANK && map->blocks[row - 1][column + 1].status != BLOCK_STATUS_VISIBLE) {
-                        stack_top_index++;
-                        stack[stack_top_index].row = row - 1;
-                        stack[stack_top_index].column = column + 1;
-                    }
-                    // 将右上方方块设置为可见
-                    map->blocks[row - 1][column + 1].status = BLOCK_STATUS_VISIBLE;
-                }
-            }
-
-            // 若左列存在
-            if (column - 1 >= 0) {
-                // 若正左方为空白方块且不可见，则入栈
-                if (map->blocks[row][column - 1].type == BLOCK_TYPE_BLANK && map->blocks[row][column - 1].status != BLOCK_STATUS_VISIBLE) {
-                    stack_top_index++;
-                    stack[stack_top_index].row = row;
-                    stack[stack_top_index].column = column - 1;
-                }
-                // 将正左方方块设置为可见
-                map->blocks[row][column - 1].status = BLOCK_STATUS_VISIBLE;
-            }
-
-            // 若右列存在
-            if (column + 1 < map->number_of_columns) {
-                // 若正右方为空白方块且不可见，则入栈
-                if (map->blocks[row][column + 1].type == BLOCK_TYPE_BLANK && map->blocks[row][column + 1].status != BLOCK_STATUS_VISIBLE) {
-                    stack_top_index++;
-                    stack[stack_top_index].row = row;
-                    stack[stack_top_index].column = column + 1;
-                }
-                // 将正右方方块设置为可见
-                map->blocks[row][column + 1].status = BLOCK_STATUS_VISIBLE;
-            }
-
-            // 若下一行存在
-            if (row + 1 < map->number_of_rows) {
-                // 若左列存在
-                if (column - 1 >= 0) {
-                    // 若左下方为空白方块且不可见，则入栈
-                    if (map->blocks[row + 1][column - 1].type == BLOCK_TYPE_BLANK && map->blocks[row + 1][column - 1].status != BLOCK_STATUS_VISIBLE) {
-                        stack_top_index++;
-                        stack[stack_top_index].row = row + 1;
-                        stack[stack_top_index].column = column - 1;
-                    }
-                    // 将左下方方块设置为可见
-                    map->blocks[row + 1][column - 1].status = BLOCK_STATUS_VISIBLE;
-                }
-
-                // 若正下方为空白方块且不可见，则入栈
-                if (map->blocks[row + 1][column].type == BLOCK_TYPE_BLANK && map->blocks[row + 1][column].status != BLOCK_STATUS_VISIBLE) {
-                    stack_top_index++;
-                    stack[stack_top_index].row = row + 1;
-                    stack[stack_top_index].column = column;
-                }
-                // 将正下方方块设置为可见
-                map->blocks[row + 1][column].status = BLOCK_STATUS_VISIBLE;
-
-                // 若右列存在
-                if (column + 1 < map->number_of_columns) {
-                    // 若右下方为空白方块且不可见，则入栈
-                    if (map->blocks[row + 1][column + 1].type == BLOCK_TYPE_BLANK && map->blocks[row + 1][column + 1].status != BLOCK_STATUS_VISIBLE) {
-                        stack_top_index++;
-                        stack[stack_top_index].row = row + 1;
-                        stack[stack_top_index].column = column + 1;
-                    }
-                    // 将右下方方块设置为可见
-                    map->blocks[row + 1][column + 1].status = BLOCK_STATUS_VISIBLE;
-                }
-            }
-        }
-
-        // 释放栈的内存
-        free(stack);
+    if (status == BLOCK_STATUS_VISIBLE && ResolveBlockType(map, BLOCK_INDEX(map, row, column)) == BLOCK_TYPE_BLANK) {
+        return RevealBlankRegion(map, BLOCK_INDEX(map, row, column));
     }
 
-    /*
-     * 重新计算各统计数据
-     */
-
-    // 重置统计数据
-    map->number_of_visible_blocks = 0;
-    map->number_of_flags = 0;
-    map->number_of_doubts = 0;
-    map->number_of_visible_mine_blocks = 0;
-    // 遍历方块表，计算统计数据
-    for (row = 0; row < map->number_of_rows; row++) {
-        for (column = 0; column < map->number_of_columns; column++) {
-            if (map->blocks[row][column].status == BLOCK_STATUS_VISIBLE) {
-                map->number_of_visible_blocks++;
-
-                if (map->blocks[row][column].type == BLOCK_TYPE_MINE) {
-                    map->number_of_visible_mine_blocks++;
-                }
-            }
-            if (map->blocks[row][column].status == BLOCK_STATUS_FLAG) {
-                map->number_of_flags++;
-            }
-            if (map->blocks[row][column].status == BLOCK_STATUS_DOUBT) {
-                map->number_of_doubts++;
-            }
-        }
-    }
-    // 计算不可见方块数
-    map->number_of_invisible_blocks = map->number_of_blocks - map->number_of_visible_blocks;
-
     return 1;
 }
 
 /**
- * 游戏开始界面
+ * 预设难度的行数、列数和地雷数
  *
- * @param game              游戏指针
+ * @param difficulty        难度，不能为自定义
+ * @param rows              行数指针
+ * @param columns           列数指针
+ * @param mines             地雷数指针
  */
-void GameStartScreen(Game *game) {
-    // 行数
-    int rows;
-    // 列数
-    int columns;
-    // 地雷数
-    int mines;
-    // 难度
-    GameDifficulty difficulty;
-    // 最小数
-    int min;
-    // 最大数
-    int max;
-    // 输入是否正确
-    _Bool is_valid;
-
-    // 清空控制台
-    system("clear");
-
-    // 输出难度信息
-    printf(TITLE_STYLE);
-    printf("                                   [  扫雷  ]                                   \n");
-    printf(CLEAR_STYLE);
-
-    printf("\n\n");
-
-    printf(SUBTITLE_STYLE);
-    printf("[ 难度 ]\n");
-    printf(CLEAR_STYLE);
-
-    printf("\n");
-
-    printf("    %d. 初级（ 9行 x  9列，10个地雷）\n", GAME_DIFFICULTY_LOW);
-    printf("    %d. 中级（16行 x 16列，40个地雷）\n", GAME_DIFFICULTY_MIDDLE);
-    printf("    %d. 高级（16行 x 30列，99个地雷）\n", GAME_DIFFICULTY_HIGH);
-    printf("    %d. 自定义\n", GAME_DIFFICULTY_CUSTOMIZED);
-
-    printf("\n");
-
-    printf(SEPARATOR);
-
-    // 选择难度
-    do {
-        printf(INPUT_PROMPT_STYLE);
-        printf("请选择难度：");
-        printf(CLEAR_STYLE);
-
-        printf(INPUT_STYLE);
-        scanf("%d", (int *)&difficulty);
-        printf(CLEAR_STYLE);
-
-        is_valid = difficulty >= GAME_DIFFICULTY_CUSTOMIZED && difficulty <= GAME_DIFFICULTY_HIGH;
-
-        if (! is_valid) {
-            printf(ERROR_MESSAGE_STYLE);
-            printf("请输入正确的编号！\n");
-            printf(CLEAR_STYLE);
-        }
-    } while (! is_valid);
-
-    // 确定行数、列数和地雷数
-    // 低级难度
-    if (difficulty == GAME_DIFFICULTY_LOW) {
-        rows = 9;
-        columns = 9;
-        mines = 10;
+void GetDifficultySize(GameDifficulty difficulty, int *rows, int *columns, int *mines) {
+    // 高级难度
+    if (difficulty == GAME_DIFFICULTY_HIGH) {
+        *rows = 16;
+        *columns = 30;
+        *mines = 99;
     }
     // 中级难度
     else if (difficulty == GAME_DIFFICULTY_MIDDLE) {
-        rows = 16;
-        columns = 16;
-        mines = 40;
-    }
-    // 高级难度
-    else if (difficulty == GAME_DIFFICULTY_HIGH) {
-        rows = 16;
-        columns = 30;
-        mines = 99;
+        *rows = 16;
+        *columns = 16;
+        *mines = 40;
     }
-    // 自定义难度
+    // 低级难度
     else {
-        // 输入行数
-        do {
-            printf(INPUT_PROMPT_STYLE);
-            printf("行数：");
-            printf(CLEAR_STYLE);
-
-            printf(INPUT_STYLE);
-            scanf("%d", &rows);
-            printf(CLEAR_STYLE);
-
-            min = 2;
-            max = INT_MAX;
-            is_valid = rows >= min && rows <= max;
-
-            if (! is_valid) {
-                printf(ERROR_MESSAGE_STYLE);
-                printf("行数范围：%d ~ %d！\n", min, max);
-                printf(CLEAR_STYLE);
-            }
-        } while (! is_valid);
-
-        // 输入列数
-        do {
-            printf(INPUT_PROMPT_STYLE);
-            printf("列数：");
-            printf(CLEAR_STYLE);
-
-            printf(INPUT_STYLE);
-            scanf("%d", &columns);
-            printf(CLEAR_STYLE);
-
-            min = 2;
-            max = INT_MAX;
-            is_valid = columns >= min && columns <= max;
-
-            if (! is_valid) {
-                printf(ERROR_MESSAGE_STYLE);
-                printf("列数范围：%d ~ %d！\n", min, max);
-                printf(CLEAR_STYLE);
-            }
-        } while (! is_valid);
-
-        // 输入地雷数
-        do {
-            printf(INPUT_PROMPT_STYLE);
-            printf("地雷数：");
-            printf(CLEAR_STYLE);
-
-            printf(INPUT_STYLE);
-            scanf("%d", &mines);
-            printf(CLEAR_STYLE);
-
-            // 合格条件：地雷数≥1，地雷比率≥5%，且≤90%
-            min = (int)(rows * columns * 0.05) >= 1 ? (int)(rows * columns * 0.05) : 1;
-            max = (int)(rows * columns * 0.90) >= 1 ? (int)(rows * columns * 0.90) : 1;
-            is_valid = mines >= min && mines <= max;
-
-            if (! is_valid) {
-                printf(ERROR_MESSAGE_STYLE);
-                printf("地雷数范围：%d ~ %d！\n", min, max);
-                printf(CLEAR_STYLE);
-            }
-        } while (! is_valid);
+        *rows = 9;
+        *columns = 9;
+        *mines = 10;
     }
-
-    // 创建地图
-    game->map = CreateMap(rows, columns, mines);
 }
 
 /**
- * 游戏过程界面
+ * 地图大小和地雷数是否有效
  *
- * @param game              游戏指针
+ * 与自定义难度界面的限制相同：行数、列数至少为2，方块表（含哨兵方块）不能超过最大方块数，
+ * 地雷数至少为1，地雷比率在5%~90%之间
+ *
+ * @param rows              行数
+ * @param columns           列数
+ * @param mines             地雷数
+ * @return                  是否有效
  */
-void GameProcessScreen(Game *game) {
-    // 行编号
-    int row;
-    // 列编号
-    int column;
-    // 操作指令
-    char directive[100];
-    // 方块目标状态
-    BlockStatus status;
-    // 输入是否正确
-    _Bool is_valid;
-
-    // 当游戏未结束时一直执行
-    while (! game->is_finished) {
-        // 换行，解决输入多个命令行时上一个界面的输入提示挤占本次界面顶部的问题
-        printf("\n");
-        // 清空控制台
-        system("clear");
-
-        printf(TITLE_STYLE);
-        printf("                                   [  扫雷  ]                                   \n");
-        printf(CLEAR_STYLE);
-
-        printf("\n\n");
-
-        // 打印地图
-        PrintMap(game->map);
-
-        printf("\n\n");
-
-        // 打印统计信息
-        printf(SUBTITLE_STYLE);
-        printf("[ 统计信息 ]\n");
-        printf(CLEAR_STYLE);
+_Bool IsValidGameSize(long long rows, long long columns, long long mines) {
+    // 地雷数范围
+    long long min, max;
 
-        printf("    ");
-
-        printf("行数: ");
-        printf(HIGHLIGHT_STYLE);
-        printf("%-13d", game->map->number_of_rows);
-        printf(CLEAR_STYLE);
-
-        printf("列数: ");
-        printf(HIGHLIGHT_STYLE);
-        printf("%-13d", game->map->number_of_columns);
-        printf(CLEAR_STYLE);
-
-        printf("方块总数: ");
-        printf(HIGHLIGHT_STYLE);
-        printf("%-9d", game->map->number_of_blocks);
-        printf(CLEAR_STYLE);
-
-        printf("地雷数: ");
-        printf(HIGHLIGHT_STYLE);
-        printf("%-11d", game->map->number_of_mines);
-        printf(CLEAR_STYLE);
-
-        printf("\n");
-        printf("    ");
-
-        printf("已翻开方块数: ");
-        printf(HIGHLIGHT_STYLE);
-        printf("%-5d", game->map->number_of_visible_blocks);
-        printf(CLEAR_STYLE);
-
-        printf("未翻开方块数: ");
-        printf(HIGHLIGHT_STYLE);
-        printf("%-5d", game->map->number_of_invisible_blocks);
-        printf(CLEAR_STYLE);
-
-        printf("旗标数: ");
-        printf(HIGHLIGHT_STYLE);
-        printf("%-11d", game->map->number_of_flags);
-        printf(CLEAR_STYLE);
-
-        printf("疑问标数: ");
-        printf(HIGHLIGHT_STYLE);
-        printf("%-9d", game->map->number_of_doubts);
-        printf(CLEAR_STYLE);
-
-        printf("\n\n");
-
-        // 打印操作方法
-        printf(SUBTITLE_STYLE);
-        printf("[ 操作说明 ]\n");
-        printf(CLEAR_STYLE);
-
-        printf("    命令行格式：\n");
-
-        printf("        ");
-        printf(HIGHLIGHT_STYLE);
-        printf("行编号 列编号 方块操作指令\n");
-        printf(CLEAR_STYLE);
-
-        printf("    方块操作指令：\n");
-
-        printf("        ");
-        printf(HIGHLIGHT_STYLE);
-        printf("V");
-        printf(CLEAR_STYLE);
-        printf(": 将一个未翻开的方块翻开\n");
-
-        printf("        ");
-        printf(HIGHLIGHT_STYLE);
-        printf("F");
-        printf(CLEAR_STYLE);
-        printf(": 对一个未翻开的方块设置小旗标记，表示此处确定有地雷\n");
-
-        printf("        ");
-        printf(HIGHLIGHT_STYLE);
-        printf("?");
-        printf(CLEAR_STYLE);
-        printf(": 对一个未翻开的方块设置疑问标记，表示此处可能有地雷\n");
-
-        printf("        ");
-        printf(HIGHLIGHT_STYLE);
-        printf("C");
-        printf(CLEAR_STYLE);
-        printf(": 清除一个未翻开的方块上的任何标记\n");
-
-        printf("    可同时输入多个完整的命令行\n");
-
-        printf("\n");
-
-        printf(SEPARATOR);
-
-        do {
-            printf(INPUT_PROMPT_STYLE);
-            printf("命令行：");
-            printf(CLEAR_STYLE);
-
-            printf(INPUT_STYLE);
-            scanf("%d%d%s", &row, &column, directive);
-            printf(CLEAR_STYLE);
-
-            if (strcmp(directive, "V") == 0 || strcmp(directive, "v") == 0) {
-                is_valid = 1;
-                status = BLOCK_STATUS_VISIBLE;
-            } else if (strcmp(directive, "F") == 0 || strcmp(directive, "f") == 0) {
-                is_valid = 1;
-                status = BLOCK_STATUS_FLAG;
-            } else if (strcmp(directive, "?") == 0) {
-                is_valid = 1;
-                status = BLOCK_STATUS_DOUBT;
-            } else if (strcmp(directive, "C") == 0 || strcmp(directive, "c") == 0) {
-                is_valid = 1;
-                status = BLOCK_STATUS_INVISIBLE;
-            } else {
-                is_valid = 0;
-            }
-
-            if (! is_valid) {
-                printf(ERROR_MESSAGE_STYLE);
-                printf("请输入正确的命令行！\n");
-                printf(CLEAR_STYLE);
-            }
-        } while (! is_valid);
-
-        // 处理方块
-        HandleBlock(game->map, row - 1, column - 1, status);
-
-        // 计算游戏结果信息
-        // 如果剩余不可见方块数等于地雷数，则全部雷都被排出来了，即胜利
-        game->is_winning = game->map->number_of_invisible_blocks == game->map->number_of_mines;
-        // 如果输了或赢了，则游戏结束
-        game->is_finished =
-                // 可见地雷数＞0 => 点到雷了 => 输
-                game->map->number_of_visible_mine_blocks > 0
-                // 或，胜利
-                || game->is_winning;
+    if (rows < 2 || rows > MAX_BLOCK_TABLE_SIZE / 4 - 2 || columns < 2 || columns > MAX_BLOCK_TABLE_SIZE / (rows + 2) - 2) {
+        return 0;
     }
+    min = (long long)((double)rows * columns * 0.05) >= 1 ? (long long)((double)rows * columns * 0.05) : 1;
+    max = (long long)((double)rows * columns * 0.90) >= 1 ? (long long)((double)rows * columns * 0.90) : 1;
+
+    return mines >= min && mines <= max;
 }
 
 /**
- * 游戏结束界面
+ * 重置游戏，并创建尚未散布地雷的地图
+ *
+ * 调用者可以在散布地雷前设置地图选项（如延迟计算数值），再选择散布方式
  *
  * @param game              游戏指针
+ * @param rows              行数
+ * @param columns           列数
+ * @param mines             地雷数
+ * @return                  地图是否创建成功
  */
-void GameEndScreen(Game *game) {
-    // 清空控制台
-    system("clear");
+_Bool ResetGame(Game *game, int rows, int columns, int mines) {
+    // 销毁原有地图
+    if (game->map) {
+        DestroyMap(&game->map);
+    }
 
-    // 输出结果信息
-    printf(TITLE_STYLE);
-    printf("                                   [  扫雷  ]                                   \n");
-    printf(CLEAR_STYLE);
+    // 重置游戏状态
+    InitializeGame(game);
 
-    printf("\n\n");
+    // 创建地图
+    game->map = CreateMap(rows, columns, mines);
 
-    if (game->is_winning) {
-        printf("                       ");
-        printf(VICTORY_STYLE);
-        printf("恭喜，您已扫出所有地雷，游戏胜利！\n");
-        printf(CLEAR_STYLE);
-    } else {
-        printf("                        ");
-        printf(DEFEAT_STYLE);
-        printf("很遗憾，您踩到了地雷，游戏失败！\n");
-        printf(CLEAR_STYLE);
+    return game->map != NULL;
+}
+
+/**
+ * 开始一局新游戏
+ *
+ * 销毁原有地图，创建新地图并按种子散布地雷，相同的参数和种子总是生成相同的地图
+ *
+ * @param game              游戏指针
+ * @param rows              行数
+ * @param columns           列数
+ * @param mines             地雷数
+ * @param seed              随机数种子，为0时自动生成
+ * @return                  地图是否创建成功
+ */
+_Bool StartGame(Game *game, int rows, int columns, int mines, uint64_t seed) {
+    if (! ResetGame(game, rows, columns, mines)) {
+        return 0;
     }
 
-    printf("\n");
+    // 散布地雷
+    RandomDistributeMines(game->map, seed);
 
-    printf(SEPARATOR);
+    return 1;
+}
+
+/**
+ * 根据地图计算游戏结果
+ *
+ * @param game              游戏指针
+ */
+void UpdateGameResult(Game *game) {
+    // 如果剩余不可见方块数等于地雷数，则全部雷都被排出来了，即胜利
+    game->is_winning = game->map->number_of_visible_mine_blocks == 0
+                       && game->map->number_of_invisible_blocks == game->map->number_of_mines;
+    // 如果输了或赢了，则游戏结束
+    game->is_finished =
+            // 可见地雷数＞0 => 点到雷了 => 输
+            game->map->number_of_visible_mine_blocks > 0
+            // 或，胜利
+            || game->is_winning;
+}
 
-    printf("\n");
+/**
+ * 走一步：处理一个方块并计算游戏结果
+ *
+ * @param game              游戏指针
+ * @param row               行下标
+ * @param column            列下标
+ * @param status            方块的目标状态
+ * @return                  是否处理成功
+ */
+_Bool PlayMove(Game *game, int row, int column, BlockStatus status) {
+    // 是否处理成功
+    _Bool is_handled = HandleBlock(game->map, row, column, status);
 
-    PrintMap(game->map);
+    game->last_row = row;
+    game->last_column = column;
+    UpdateGameResult(game);
 
-    printf("\n\n");
+    return is_handled;
 }
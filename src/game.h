@@ -3,7 +3,11 @@
  * [头文件] 游戏
  * ----------------------------------------------------------------------------
  *
- * 定义扫雷游戏的数据结构和函数原型
+ * 定义扫雷游戏引擎的数据结构和函数原型
+ *
+ * 线程安全：随机数发生器、区段栈、位平面和密度金字塔都归各自的地图所有，
+ * 引擎没有可变的全局状态（生成种子用的原子计数器除外）。
+ * 同一个地图或游戏同一时刻只能由一个线程使用；不同的地图或游戏可以在多个线程中同时使用，无需加锁。
  *
  */
 
@@ -11,46 +15,45 @@
 #ifndef MINESWEEPING_GAME_H
 #define MINESWEEPING_GAME_H
 
+#include <stddef.h>
+#include <stdint.h>
+#include <limits.h>
+
+#include "random.h"
+#include "pyramid.h"
+
 /*
  * 宏定义
  */
 
-// 控制台宽度
-#define CONSOLE_WIDTH 80
-
-// 标题样式
-#define TITLE_STYLE           "\033[47;30;01m"
-// 副标题样式
-#define SUBTITLE_STYLE        "\033[47;30m"
-// 输入提示样式
-#define INPUT_PROMPT_STYLE    "\033[32m"
-// 输入样式
-#define INPUT_STYLE           "\033[32;01m"
-// 错误消息样式
-#define ERROR_MESSAGE_STYLE   "\033[31m"
-// 强调样式
-#define HIGHLIGHT_STYLE       "\033[33;01m"
-// 胜利样式
-#define VICTORY_STYLE         "\033[32;01;05m\a\a\a"
-// 失败样式
-#define DEFEAT_STYLE          "\033[31;01;05m\a"
-// 方块表样式
-#define BLOCK_TABLE_STYLE     ""
-// 不可见方块样式
-#define INVISIBLE_BLOCK_STYLE "\033[44;01m"
-// 旗标方块样式
-#define FLAG_BLOCK_STYLE      "\033[44;37;01m"
-// 疑问标方块样式
-#define DOUBT_BLOCK_STYLE     "\033[44;37;01m"
-// 数字方块样式
-#define NUMBER_BLOCK_STYLE    "\033[34;01m"
-// 地雷方块样式
-#define MINE_BLOCK_STYLE      "\033[41;37;01m"
-// 清除样式
-#define CLEAR_STYLE           "\033[0m"
-
-// 分隔线
-#define SEPARATOR             "\033[4m                                                                                \033[0m\n\n"
+// 方块类型所占的位
+#define BLOCK_TYPE_MASK               0x0F
+// 方块状态的起始位
+#define BLOCK_STATUS_SHIFT            4
+// 方块状态所占的位
+#define BLOCK_STATUS_MASK             0x30
+
+// 方块类型已计算的标记位，仅在延迟计算数值的地图中使用
+#define BLOCK_RESOLVED                0x40
+
+// 由类型和状态组成一个方块
+#define MAKE_BLOCK(type, status)      ((Block)((type) | ((status) << BLOCK_STATUS_SHIFT)))
+// 方块的类型
+#define BLOCK_TYPE_OF(block)          ((BlockType)((block) & BLOCK_TYPE_MASK))
+// 方块的状态
+#define BLOCK_STATUS_OF(block)        ((BlockStatus)(((block) & BLOCK_STATUS_MASK) >> BLOCK_STATUS_SHIFT))
+// 设置方块的类型
+#define SET_BLOCK_TYPE(block, type)   ((block) = (Block)(((block) & ~BLOCK_TYPE_MASK) | (type)))
+// 设置方块的状态
+#define SET_BLOCK_STATUS(block, status) ((block) = (Block)(((block) & ~BLOCK_STATUS_MASK) | ((status) << BLOCK_STATUS_SHIFT)))
+
+// 方块表（含哨兵方块）的最大方块数，方块下标使用int
+#define MAX_BLOCK_TABLE_SIZE          INT_MAX
+
+// 方块在方块表中的下标（跳过左上角的哨兵方块）
+#define BLOCK_INDEX(map, row, column) (((row) + 1) * (map)->stride + (column) + 1)
+// 方块表中指定行、列的方块
+#define BLOCK_AT(map, row, column)    ((map)->blocks[BLOCK_INDEX(map, row, column)])
 
 /*
  * 数据结构定义
@@ -97,13 +100,30 @@ typedef enum {
     BLOCK_STATUS_VISIBLE,
 } BlockStatus;
 
-// 结构体：方块
+// 方块：压缩为1个字节，低4位为类型，第4 ~ 5位为状态
+typedef uint8_t Block;
+
+// 枚举：位平面
+typedef enum {
+    // 地雷
+    BIT_PLANE_MINE,
+    // 可见
+    BIT_PLANE_VISIBLE,
+    // 旗标
+    BIT_PLANE_FLAG,
+    // 疑问标
+    BIT_PLANE_DOUBT,
+    // 位平面个数
+    NUMBER_OF_BIT_PLANES,
+} BitPlane;
+
+// 结构体：变更日志条目
 typedef struct {
-    // 类型
-    BlockType type;
-    // 状态
-    BlockStatus status;
-} Block;
+    // 方块在方块表中的下标
+    int index;
+    // 改变前的方块
+    Block previous;
+} JournalEntry;
 
 // 结构体：地图
 typedef struct {
@@ -114,19 +134,48 @@ typedef struct {
     // 地雷数
     int number_of_mines;
     // 方块总数
-    int number_of_blocks;
+    long long number_of_blocks;
     // 可见方块数
-    int number_of_visible_blocks;
+    long long number_of_visible_blocks;
     // 不可见方块数
-    int number_of_invisible_blocks;
+    long long number_of_invisible_blocks;
     // 旗标数
-    int number_of_flags;
+    long long number_of_flags;
     // 疑问标数
-    int number_of_doubts;
+    long long number_of_doubts;
     // 可见地雷数
-    int number_of_visible_mine_blocks;
-    // 方块表
-    Block **blocks;
+    long long number_of_visible_mine_blocks;
+    // 是否延迟计算数值：为真时散布地雷只放置地雷，方块的数值在翻开或查询时才计算
+    _Bool is_lazy;
+    // 方块表行跨度（列数 + 左右两个哨兵方块）
+    int stride;
+    // 周围8个方块相对于当前方块的下标偏移量
+    int neighbor_offsets[8];
+    // 方块表，按行优先连续存放，四周有一圈哨兵方块
+    Block *blocks;
+    // 位平面每行的字数
+    int words_per_row;
+    // 位平面，每个方块占1位，每行按64位字对齐，未启用时为空
+    uint64_t *bit_planes[NUMBER_OF_BIT_PLANES];
+    // 密度金字塔，按瓦片统计已翻开和插旗的方块数，未启用时为空
+    Pyramid *pyramid;
+    // 变更日志，按先后顺序记录每次方块状态的改变，未启用时为空
+    JournalEntry *journal;
+    // 变更日志的条目数
+    size_t journal_length;
+    // 变更日志容量（条目数）
+    size_t journal_capacity;
+    // 可见状态的Zobrist散列值：由地图大小、地雷数和每个不是不可见状态的方块（可见方块含数值）的键异或而成，
+    // 设置方块状态时增量更新，大小和地雷数相同的地图上相同的可见局面散列值相同
+    uint64_t hash;
+    // 翻开空白区域时使用的区段栈，每个区段占2个元素（左、右端下标），在多次调用间复用
+    int *span_stack;
+    // 区段栈容量（元素数）
+    int span_stack_capacity;
+    // 散布地雷使用的随机数种子
+    uint64_t seed;
+    // 随机数发生器
+    Random random;
 } Map;
 
 // 结构体：游戏
@@ -137,6 +186,8 @@ typedef struct {
     _Bool is_winning;
     // 地图
     Map *map;
+    // 最后一次操作的方块的行下标、列下标
+    int last_row, last_column;
 } Game;
 
 /*
@@ -155,19 +206,47 @@ Map * CreateMap(int rows, int columns, int mines);
 void DestroyMap(Map **map);
 // 初始化地图
 void InitializeMap(Map *map, int rows, int columns, int mines);
+// 设置哨兵方块
+void SetSentinelBlocks(Block *blocks, int rows, int columns);
 // 清空方块表
-void ClearBlockTable(Block **blocks, int rows, int columns);
+void ClearBlockTable(Block *blocks, int rows, int columns);
 // 随机散布地雷
-void RandomDistributeMines(Map *map);
-// 打印地图
-void PrintMap(Map *map);
+uint64_t RandomDistributeMines(Map *map, uint64_t seed);
+// 查询方块类型，延迟计算数值的地图会在此时计算并缓存数值
+BlockType GetBlockType(Map *map, int row, int column);
+// 查询方块状态
+BlockStatus GetBlockStatus(Map *map, int row, int column);
+// 启用位平面
+_Bool EnableBitPlanes(Map *map);
+// 停用位平面
+void DisableBitPlanes(Map *map);
+// 根据方块表重建位平面
+void RebuildBitPlanes(Map *map);
+// 查询位平面中的一位
+_Bool TestBitPlane(Map *map, BitPlane plane, int row, int column);
+// 启用密度金字塔
+_Bool EnablePyramid(Map *map);
+// 停用密度金字塔
+void DisablePyramid(Map *map);
+// 根据方块表重建密度金字塔
+void RebuildPyramid(Map *map);
+// 启用变更日志
+_Bool EnableJournal(Map *map);
+// 停用变更日志
+void DisableJournal(Map *map);
 // 处理一个方块
 _Bool HandleBlock(Map *map, int row, int column, BlockStatus status);
-// 游戏开始界面
-void GameStartScreen(Game *game);
-// 游戏过程界面
-void GameProcessScreen(Game *game);
-// 游戏结束界面
-void GameEndScreen(Game *game);
+// 预设难度的行数、列数和地雷数
+void GetDifficultySize(GameDifficulty difficulty, int *rows, int *columns, int *mines);
+// 地图大小和地雷数是否有效
+_Bool IsValidGameSize(long long rows, long long columns, long long mines);
+// 重置游戏，并创建尚未散布地雷的地图
+_Bool ResetGame(Game *game, int rows, int columns, int mines);
+// 开始一局新游戏
+_Bool StartGame(Game *game, int rows, int columns, int mines, uint64_t seed);
+// 根据地图计算游戏结果
+void UpdateGameResult(Game *game);
+// 走一步：处理一个方块并计算游戏结果
+_Bool PlayMove(Game *game, int row, int column, BlockStatus status);
 
 #endif //MINESWEEPING_GAME_H
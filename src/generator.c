@@ -0,0 +1,329 @@
+/**
+ * ----------------------------------------------------------------------------
+ * [源文件] 多线程地图生成
+ * ----------------------------------------------------------------------------
+ *
+ * 把地图按固定行数划分为若干行带，由多个工作线程并行生成：
+ *
+ * 1. 主线程按顺序为每个行带抽取地雷数（超几何分布）和行带种子，保证地雷总数恰好正确；
+ * 2. 工作线程并行清空各自的行带，并在行带内用Floyd抽样放置地雷；
+ * 3. 工作线程分两轮计算周围地雷数：先处理偶数行带，再处理奇数行带，
+ *    同一轮中各行带只读取相邻行带的边缘行，不会与其写入冲突。
+ *
+ * 每个行带的内容只取决于种子和行带编号，因此种子相同时，无论使用多少线程结果都完全相同。
+ * 延迟计算数值的地图只执行第1、2步。
+ *
+ */
+
+
+// 使用可重入的lgamma_r
+#define _DEFAULT_SOURCE
+
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <pthread.h>
+#include <stdatomic.h>
+#include <unistd.h>
+
+#include "generator.h"
+#include "neighbor.h"
+
+
+// 结构体：行带
+typedef struct {
+    // 起始行下标
+    int row_begin;
+    // 结束行下标（不含）
+    int row_end;
+    // 地雷数
+    uint64_t mines;
+    // 行带种子
+    uint64_t seed;
+} Band;
+
+// 结构体：生成任务
+typedef struct {
+    // 地图指针
+    Map *map;
+    // 行带表
+    Band *bands;
+    // 行带数
+    int number_of_bands;
+    // 当前阶段：0为放置地雷，1为计算偶数行带的数值，2为计算奇数行带的数值
+    int phase;
+    // 下一个待领取的行带序号
+    atomic_int next_band;
+} GenerationTask;
+
+/**
+ * 处理器核心数
+ *
+ * @return                  在线处理器核心数，至少为1
+ */
+int NumberOfProcessors() {
+    // 核心数
+    long n = sysconf(_SC_NPROCESSORS_ONLN);
+
+    return n >= 1 ? (int)n : 1;
+}
+
+/**
+ * 生成[0, 1)范围内的随机浮点数
+ *
+ * @param random            随机数发生器指针
+ * @return                  随机浮点数
+ */
+static double RandomUnit(Random *random) {
+    return (double)(NextRandom(random) >> 11) * (1.0 / 9007199254740992.0);
+}
+
+/**
+ * 组合数的自然对数 ln C(n, k)
+ *
+ * lgamma会写入全局变量signgam，多个线程同时生成地图时存在数据竞争，因此使用lgamma_r
+ *
+ * @param n                 总数
+ * @param k                 选取数
+ * @return                  组合数的自然对数
+ */
+static double LogChoose(uint64_t n, uint64_t k) {
+    // Gamma函数的符号（参数为正，总是1）
+    int sign;
+
+    return lgamma_r((double)n + 1, &sign) - lgamma_r((double)k + 1, &sign) - lgamma_r((double)(n - k) + 1, &sign);
+}
+
+/**
+ * 超几何分布抽样：从total个方块（其中mines个地雷）中不放回地取draws个，取到的地雷数
+ *
+ * 从众数开始交替向两侧累加概率做逆变换抽样，期望步数与标准差同阶
+ *
+ * @param random            随机数发生器指针
+ * @param total             方块总数
+ * @param mines             地雷总数
+ * @param draws             抽取数
+ * @return                  抽到的地雷数
+ */
+static uint64_t SampleHypergeometric(Random *random, uint64_t total, uint64_t mines, uint64_t draws) {
+    // 取值下界、上界
+    uint64_t low = draws + mines > total ? draws + mines - total : 0;
+    uint64_t high = draws < mines ? draws : mines;
+    // 众数
+    uint64_t mode;
+    // 众数的概率
+    double p_mode;
+    // 向下、向上搜索的当前值
+    uint64_t down, up;
+    // 向下、向上搜索的当前概率
+    double p_down, p_up;
+    // 剩余的随机量
+    double u;
+
+    if (low == high) {
+        return low;
+    }
+
+    mode = (uint64_t)(((double)draws + 1) * ((double)mines + 1) / ((double)total + 2));
+    mode = mode < low ? low : mode > high ? high : mode;
+    p_mode = exp(LogChoose(mines, mode) + LogChoose(total - mines, draws - mode) - LogChoose(total, draws));
+
+    u = RandomUnit(random) - p_mode;
+    if (u <= 0) {
+        return mode;
+    }
+
+    down = up = mode;
+    p_down = p_up = p_mode;
+    while (down > low || up < high) {
+        // 向上一步：p(k + 1) = p(k) * (K - k)(n - k) / ((k + 1)(N - K - n + k + 1))
+        if (up < high) {
+            p_up *= (double)(mines - up) * (double)(draws - up) / ((double)(up + 1) * (double)(total - mines - draws + up + 1));
+            up++;
+            u -= p_up;
+            if (u <= 0) {
+                return up;
+            }
+        }
+        // 向下一步：p(k - 1) = p(k) * k(N - K - n + k) / ((K - k + 1)(n - k + 1))
+        if (down > low) {
+            p_down *= (double)down * (double)(total - mines - draws + down) / ((double)(mines - down + 1) * (double)(draws - down + 1));
+            down--;
+            u -= p_down;
+            if (u <= 0) {
+                return down;
+            }
+        }
+    }
+
+    // 浮点舍入导致概率和略小于1时，退回众数
+    return mode;
+}
+
+/**
+ * 清空一个行带，并在行带内用Floyd抽样放置地雷
+ *
+ * @param map               地图指针
+ * @param band              行带指针
+ */
+static void PlaceBandMines(Map *map, Band *band) {
+    // 行下标
+    int row;
+    // 行带内的方块总数
+    uint64_t total = (uint64_t)(band->row_end - band->row_begin) * (uint64_t)map->number_of_columns;
+    // 抽样序号
+    uint64_t j;
+    // 抽中的方块序号
+    uint64_t t;
+    // 方块指针
+    Block *block;
+    // 行带的随机数发生器
+    Random random;
+
+    // 清空行带内的方块，首次写入也在工作线程中完成
+    for (row = band->row_begin; row < band->row_end; row++) {
+        memset(&BLOCK_AT(map, row, 0), MAKE_BLOCK(BLOCK_TYPE_BLANK, BLOCK_STATUS_INVISIBLE), (size_t)map->number_of_columns);
+    }
+
+    // Floyd抽样
+    SeedRandom(&random, band->seed);
+    for (j = total - band->mines; j < total; j++) {
+        t = RandomBelow(&random, j + 1);
+        block = &BLOCK_AT(map, band->row_begin + (int)(t / map->number_of_columns), (int)(t % map->number_of_columns));
+        if (BLOCK_TYPE_OF(*block) == BLOCK_TYPE_MINE) {
+            block = &BLOCK_AT(map, band->row_begin + (int)(j / map->number_of_columns), (int)(j % map->number_of_columns));
+        }
+        SET_BLOCK_TYPE(*block, BLOCK_TYPE_MINE);
+    }
+}
+
+/**
+ * 工作线程：不断领取当前阶段的行带并处理
+ *
+ * @param argument          生成任务指针
+ * @return                  空
+ */
+static void * GenerationWorker(void *argument) {
+    // 生成任务
+    GenerationTask *task = (GenerationTask *)argument;
+    // 行带序号
+    int band;
+
+    while (1) {
+        band = atomic_fetch_add(&task->next_band, 1);
+        if (task->phase == 0) {
+            if (band >= task->number_of_bands) {
+                break;
+            }
+            PlaceBandMines(task->map, &task->bands[band]);
+        } else {
+            // 第1阶段处理偶数行带，第2阶段处理奇数行带
+            band = band * 2 + (task->phase - 1);
+            if (band >= task->number_of_bands) {
+                break;
+            }
+            CountNeighborMines(task->map->blocks, task->map->stride, task->map->number_of_columns,
+                               task->bands[band].row_begin, task->bands[band].row_end);
+        }
+    }
+
+    return NULL;
+}
+
+/**
+ * 多线程随机散布地雷
+ *
+ * 与RandomDistributeMines相比，抽样方式不同，因此同一种子生成的地图不同；
+ * 对同一种子，本函数的结果与线程数无关（包括单线程），
+ * 命令行和批处理的每一局都由本函数生成，种子可以在不同机器和线程数之间复现
+ *
+ * @param map               地图指针
+ * @param seed              随机数种子，为0时自动生成
+ * @param threads           工作线程数，小于1时使用处理器核心数
+ * @return                  实际使用的随机数种子，内存不足时返回0且不散布地雷
+ */
+uint64_t ParallelDistributeMines(Map *map, uint64_t seed, int threads) {
+    // 生成任务
+    GenerationTask task;
+    // 线程表
+    pthread_t *workers;
+    // 已创建的线程数
+    int created;
+    // 行带序号
+    int band;
+    // 线程序号
+    int i;
+    // 剩余方块数、剩余地雷数、行带方块数
+    uint64_t remaining_blocks, remaining_mines, band_blocks;
+
+    // 设置随机数种子
+    if (seed == 0) {
+        seed = GenerateSeed();
+    }
+    map->seed = seed;
+    SeedRandom(&map->random, seed);
+
+    // 划分行带
+    task.map = map;
+    task.number_of_bands = (map->number_of_rows + GENERATION_BAND_ROWS - 1) / GENERATION_BAND_ROWS;
+    task.bands = (Band *)malloc(sizeof(Band) * (size_t)task.number_of_bands);
+    if (! task.bands) {
+        return 0;
+    }
+
+    // 按顺序为每个行带抽取地雷数和种子
+    remaining_blocks = (uint64_t)map->number_of_rows * (uint64_t)map->number_of_columns;
+    remaining_mines = (uint64_t)map->number_of_mines;
+    for (band = 0; band < task.number_of_bands; band++) {
+        task.bands[band].row_begin = band * GENERATION_BAND_ROWS;
+        task.bands[band].row_end = band * GENERATION_BAND_ROWS + GENERATION_BAND_ROWS;
+        if (task.bands[band].row_end > map->number_of_rows) {
+            task.bands[band].row_end = map->number_of_rows;
+        }
+        band_blocks = (uint64_t)(task.bands[band].row_end - task.bands[band].row_begin) * (uint64_t)map->number_of_columns;
+        task.bands[band].mines = SampleHypergeometric(&map->random, remaining_blocks, remaining_mines, band_blocks);
+        task.bands[band].seed = NextRandom(&map->random);
+        remaining_blocks -= band_blocks;
+        remaining_mines -= task.bands[band].mines;
+    }
+
+    // 确定线程数
+    if (threads < 1) {
+        threads = NumberOfProcessors();
+    }
+    if (threads > task.number_of_bands) {
+        threads = task.number_of_bands;
+    }
+    workers = (pthread_t *)malloc(sizeof(pthread_t) * (size_t)threads);
+
+    // 依次执行3个阶段，每个阶段结束后等待所有线程完成
+    // 延迟计算数值的地图只执行放置地雷的阶段
+    for (task.phase = 0; task.phase < (map->is_lazy ? 1 : 3); task.phase++) {
+        atomic_init(&task.next_band, 0);
+        created = 0;
+        // 主线程也参与处理，只需额外创建threads - 1个线程
+        for (i = 0; workers && i < threads - 1; i++) {
+            if (pthread_create(&workers[created], NULL, GenerationWorker, &task) == 0) {
+                created++;
+            }
+        }
+        GenerationWorker(&task);
+        for (i = 0; i < created; i++) {
+            pthread_join(workers[i], NULL);
+        }
+    }
+
+    free(workers);
+    free(task.bands);
+
+    // 同步位平面
+    if (map->bit_planes[BIT_PLANE_MINE]) {
+        RebuildBitPlanes(map);
+    }
+    // 散布前会清空整个方块表，同步密度金字塔
+    if (map->pyramid) {
+        RebuildPyramid(map);
+    }
+
+    return seed;
+}
@@ -0,0 +1,32 @@
+/**
+ * ----------------------------------------------------------------------------
+ * [头文件] 多线程地图生成
+ * ----------------------------------------------------------------------------
+ *
+ * 定义按行带并行散布地雷的函数原型
+ *
+ */
+
+
+#ifndef MINESWEEPING_GENERATOR_H
+#define MINESWEEPING_GENERATOR_H
+
+#include "game.h"
+
+/*
+ * 宏定义
+ */
+
+// 每个行带的行数，行带划分只取决于地图大小，与线程数无关
+#define GENERATION_BAND_ROWS 64
+
+/*
+ * 函数原型
+ */
+
+// 处理器核心数
+int NumberOfProcessors();
+// 多线程随机散布地雷
+uint64_t ParallelDistributeMines(Map *map, uint64_t seed, int threads);
+
+#endif //MINESWEEPING_GENERATOR_H
@@ -0,0 +1,682 @@
+/**
+ * ----------------------------------------------------------------------------
+ * [源文件] 提示
+ * ----------------------------------------------------------------------------
+ *
+ * 定义增量维护的“下一步安全走法”提示服务的各个函数
+ *
+ * 每条变更日志记录只影响被改变的方块本身及其周围最多8个数字：重新计算这些数字的计数，
+ * 用单个数字的规则和局部模式查找表推理，并把它们周围的未翻开方块移到新的风险桶中。
+ * 方块的局部风险是周围各数字 剩余地雷数 / 未翻开方块数 的最大值，按HINT_RISK_SCALE取整后
+ * 作为桶号；桶用双向链表串起，另有非空桶位图，查询风险最小的方块只需扫描几个字。
+ * 内部方块的风险用全局的 剩余地雷数 / 未翻开方块数 估计，两者都不含推出的地雷。
+ * 风险只是局部估计，需要精确概率时使用概率计算器。
+ * 推理只以已翻开的数字为前提，旗标与未翻开的方块相同：已翻开的数字不会再改变，推出的结果因此
+ * 一直成立，插错的旗标被取消时不必撤回任何标记。
+ *
+ */
+
+
+#include <stdlib.h>
+
+#include "hint.h"
+#include "pattern.h"
+
+
+/*
+ * 宏定义
+ */
+
+// 方块标记：已推出安全
+#define HINT_MARK_SAFE        1
+// 方块标记：已推出是地雷
+#define HINT_MARK_MINE        2
+// 方块标记：本次更新已放入待推理列表
+#define HINT_MARK_TOUCHED     4
+
+/**
+ * 方块是否未翻开（含旗标和疑问标）
+ *
+ * @param block             方块
+ * @return                  是否未翻开
+ */
+static _Bool IsUnknownBlock(Block block) {
+    return BLOCK_STATUS_OF(block) != BLOCK_STATUS_VISIBLE;
+}
+
+/**
+ * 方块是否可以作为提示返回（未翻开且未插旗，含疑问标）
+ *
+ * @param block             方块
+ * @return                  是否可以返回
+ */
+static _Bool IsSelectableBlock(Block block) {
+    return BLOCK_STATUS_OF(block) == BLOCK_STATUS_INVISIBLE || BLOCK_STATUS_OF(block) == BLOCK_STATUS_DOUBT;
+}
+
+/**
+ * 方块是否为已翻开的数字（含空白，不含哨兵方块和已翻开的地雷）
+ *
+ * @param map               地图指针
+ * @param index             方块在方块表中的下标
+ * @return                  是否为已翻开的数字
+ */
+static _Bool IsNumberBlock(Map *map, int index) {
+    // 方块
+    Block block = map->blocks[index];
+    // 方块表中的行、列（含哨兵行、列）
+    int row = index / map->stride, column = index % map->stride;
+
+    return BLOCK_STATUS_OF(block) == BLOCK_STATUS_VISIBLE && BLOCK_TYPE_OF(block) != BLOCK_TYPE_MINE
+           && row >= 1 && row <= map->number_of_rows && column >= 1 && column <= map->number_of_columns;
+}
+
+/**
+ * 方块是否为尚未推出结果的未翻开方块
+ *
+ * @param hint              提示服务指针
+ * @param index             方块在方块表中的下标
+ * @return                  是否尚未推出结果
+ */
+static _Bool IsOpenBlock(HintService *hint, int index) {
+    return IsUnknownBlock(hint->map->blocks[index]) && ! (hint->marks[index] & (HINT_MARK_SAFE | HINT_MARK_MINE));
+}
+
+/**
+ * 将一个下标压入栈
+ *
+ * 栈满时扩容为原来的2倍
+ *
+ * @param stack             栈内存指针的指针
+ * @param length            栈中元素数指针
+ * @param capacity          栈容量指针
+ * @param index             方块在方块表中的下标
+ * @return                  是否压入成功
+ */
+static _Bool PushIndex(int **stack, int *length, int *capacity, int index) {
+    // 新容量
+    int new_capacity;
+    // 新的栈内存
+    int *new_stack;
+
+    if (*length == *capacity) {
+        new_capacity = *capacity ? *capacity * 2 : 256;
+        new_stack = (int *)realloc(*stack, sizeof(int) * (size_t)new_capacity);
+        if (! new_stack) {
+            return 0;
+        }
+        *stack = new_stack;
+        *capacity = new_capacity;
+    }
+
+    (*stack)[(*length)++] = index;
+
+    return 1;
+}
+
+/**
+ * 将方块从所在的风险桶中移出
+ *
+ * @param hint              提示服务指针
+ * @param index             方块在方块表中的下标
+ */
+static void Unlink(HintService *hint, int index) {
+    // 所在的桶
+    int bucket = hint->buckets[index];
+
+    if (bucket < 0) {
+        return;
+    }
+
+    if (hint->previous[index] >= 0) {
+        hint->next[hint->previous[index]] = hint->next[index];
+    } else {
+        hint->heads[bucket] = hint->next[index];
+        if (hint->heads[bucket] < 0 && bucket != HINT_INTERIOR_BUCKET) {
+            hint->nonempty[bucket / 64] &= ~((uint64_t)1 << (bucket % 64));
+        }
+    }
+    if (hint->next[index] >= 0) {
+        hint->previous[hint->next[index]] = hint->previous[index];
+    }
+    hint->buckets[index] = -1;
+}
+
+/**
+ * 将方块放入风险桶
+ *
+ * @param hint              提示服务指针
+ * @param index             方块在方块表中的下标，不能已在桶中
+ * @param bucket            桶号
+ */
+static void Link(HintService *hint, int index, int bucket) {
+    hint->buckets[index] = (int16_t)bucket;
+    hint->previous[index] = -1;
+    hint->next[index] = hint->heads[bucket];
+    if (hint->heads[bucket] >= 0) {
+        hint->previous[hint->heads[bucket]] = index;
+    }
+    hint->heads[bucket] = index;
+    if (bucket != HINT_INTERIOR_BUCKET) {
+        hint->nonempty[bucket / 64] |= (uint64_t)1 << (bucket % 64);
+    }
+}
+
+/**
+ * 根据周围数字的计数把方块放入对应的风险桶
+ *
+ * 已翻开、已插旗或已推出结果的方块不在任何桶中；旗标取消后重新放入
+ *
+ * @param hint              提示服务指针
+ * @param index             方块在方块表中的下标
+ */
+static void Relist(HintService *hint, int index) {
+    // 地图指针
+    Map *map = hint->map;
+    // 邻居序号
+    int k;
+    // 邻居下标
+    int neighbor;
+    // 风险、桶号
+    int risk, bucket = -1;
+
+    if (IsOpenBlock(hint, index) && IsSelectableBlock(map->blocks[index])) {
+        for (k = 0; k < 8; k++) {
+            neighbor = index + map->neighbor_offsets[k];
+            if (! IsNumberBlock(map, neighbor) || hint->unknown[neighbor] <= 0) {
+                continue;
+            }
+            risk = hint->remaining[neighbor] * HINT_RISK_SCALE / hint->unknown[neighbor];
+            risk = risk < 0 ? 0 : risk > HINT_RISK_SCALE ? HINT_RISK_SCALE : risk;
+            if (risk > bucket) {
+                bucket = risk;
+            }
+        }
+        if (bucket < 0) {
+            bucket = HINT_INTERIOR_BUCKET;
+        }
+    }
+
+    if (bucket != hint->buckets[index]) {
+        Unlink(hint, index);
+        if (bucket >= 0) {
+            Link(hint, index, bucket);
+        }
+    }
+}
+
+/**
+ * 根据方块状态和推理结果把方块加入或移出未翻开方块表
+ *
+ * 表中是未推出是地雷的未翻开方块（含旗标和疑问标），即残局搜索需要枚举的方块；
+ * 推出是地雷的方块由已翻开的数字确定，不必枚举。移出时用表尾的方块填补空位
+ *
+ * @param hint              提示服务指针
+ * @param index             方块在方块表中的下标
+ */
+static void UpdateHidden(HintService *hint, int index) {
+    // 方块在表中的位置
+    int position = hint->hidden_positions[index];
+    // 表尾的方块下标
+    int last;
+
+    if (IsUnknownBlock(hint->map->blocks[index]) && ! (hint->marks[index] & HINT_MARK_MINE)) {
+        if (position < 0) {
+            hint->hidden_positions[index] = hint->number_of_hidden_blocks;
+            hint->hidden_blocks[hint->number_of_hidden_blocks++] = index;
+        }
+    } else if (position >= 0) {
+        last = hint->hidden_blocks[--hint->number_of_hidden_blocks];
+        hint->hidden_blocks[position] = last;
+        hint->hidden_positions[last] = position;
+        hint->hidden_positions[index] = -1;
+    }
+}
+
+static void Touch(HintService *hint, int index);
+
+/**
+ * 记录一个推出安全的方块
+ *
+ * @param hint              提示服务指针
+ * @param index             方块在方块表中的下标
+ */
+static void MarkSafe(HintService *hint, int index) {
+    // 邻居序号
+    int k;
+
+    if (hint->marks[index] & (HINT_MARK_SAFE | HINT_MARK_MINE)) {
+        return;
+    }
+
+    // 内存不足时不做标记，方块留在风险桶中
+    if (PushIndex(&hint->safe_stack, &hint->safe_length, &hint->safe_capacity, index)) {
+        hint->marks[index] |= HINT_MARK_SAFE;
+        hint->number_of_safe_blocks++;
+        Unlink(hint, index);
+        for (k = 0; k < 8; k++) {
+            Touch(hint, index + hint->map->neighbor_offsets[k]);
+        }
+    }
+}
+
+/**
+ * 记录一个推出是地雷的方块
+ *
+ * @param hint              提示服务指针
+ * @param index             方块在方块表中的下标
+ */
+static void MarkMine(HintService *hint, int index) {
+    // 邻居序号
+    int k;
+
+    if (hint->marks[index] & (HINT_MARK_SAFE | HINT_MARK_MINE)) {
+        return;
+    }
+
+    hint->marks[index] |= HINT_MARK_MINE;
+    hint->number_of_mine_blocks++;
+    Unlink(hint, index);
+    UpdateHidden(hint, index);
+    for (k = 0; k < 8; k++) {
+        Touch(hint, index + hint->map->neighbor_offsets[k]);
+    }
+}
+
+/**
+ * 重新计算一个数字的计数，并放入待推理列表
+ *
+ * 已推出是地雷的方块计入地雷，已推出安全的方块不计入未翻开方块，
+ * 推出结果后周围的数字因此可以继续推理。旗标不是前提，未推出结果的旗标计入未翻开方块。
+ * 不是已翻开的数字的方块跳过；尚在列表中等待推理的数字只更新计数；内存不足时只更新计数
+ *
+ * @param hint              提示服务指针
+ * @param index             方块在方块表中的下标
+ */
+static void Touch(HintService *hint, int index) {
+    // 地图指针
+    Map *map = hint->map;
+    // 邻居序号
+    int k;
+    // 邻居下标
+    int neighbor;
+    // 剩余的地雷数、未翻开的方块数
+    int remaining, unknown = 0;
+
+    if (! IsNumberBlock(map, index)) {
+        return;
+    }
+
+    remaining = BLOCK_TYPE_OF(map->blocks[index]);
+    for (k = 0; k < 8; k++) {
+        neighbor = index + map->neighbor_offsets[k];
+        if (IsUnknownBlock(map->blocks[neighbor]) && (hint->marks[neighbor] & HINT_MARK_MINE)) {
+            remaining--;
+        } else if (IsOpenBlock(hint, neighbor)) {
+            unknown++;
+        }
+    }
+    hint->remaining[index] = (int8_t)remaining;
+    hint->unknown[index] = (int8_t)unknown;
+
+    if (! (hint->marks[index] & HINT_MARK_TOUCHED)
+        && PushIndex(&hint->touched, &hint->touched_length, &hint->touched_capacity, index)) {
+        hint->marks[index] |= HINT_MARK_TOUCHED;
+    }
+}
+
+/**
+ * 用局部模式查找表推理两个数字
+ *
+ * @param hint              提示服务指针
+ * @param a                 数字A在方块表中的下标
+ * @param b                 数字B在方块表中的下标，与A的距离不超过2；为-1时只推理A
+ */
+static void DeducePair(HintService *hint, int a, int b) {
+    // 地图指针
+    Map *map = hint->map;
+    // 各组的方块数
+    int counts[NUMBER_OF_PATTERN_GROUPS] = {0, 0, 0};
+    // B剩余的地雷数
+    int remaining_b = b >= 0 ? hint->remaining[b] : 0;
+    // 方块表中B的行、列
+    int b_row = b / map->stride, b_column = b % map->stride;
+    // 邻居序号
+    int k;
+    // 邻居下标、邻居所在的组
+    int neighbor, group;
+    // 表项
+    uint8_t entry;
+
+    for (k = 0; k < 8; k++) {
+        neighbor = a + map->neighbor_offsets[k];
+        if (IsOpenBlock(hint, neighbor)) {
+            counts[b >= 0 && abs(neighbor / map->stride - b_row) <= 1 && abs(neighbor % map->stride - b_column) <= 1
+                   ? PATTERN_GROUP_SHARED : PATTERN_GROUP_ONLY_A]++;
+        }
+    }
+    if (b >= 0) {
+        counts[PATTERN_GROUP_ONLY_B] = hint->unknown[b] - counts[PATTERN_GROUP_SHARED];
+    }
+
+    entry = PATTERN_TABLE[PATTERN_KEY(hint->remaining[a], counts[PATTERN_GROUP_ONLY_A], counts[PATTERN_GROUP_SHARED],
+                                      remaining_b, counts[PATTERN_GROUP_ONLY_B])];
+    if ((entry & PATTERN_INCONSISTENT) || ! entry) {
+        return;
+    }
+
+    // A周围的方块属于只属于A或共有的组
+    for (k = 0; k < 8; k++) {
+        neighbor = a + map->neighbor_offsets[k];
+        if (! IsOpenBlock(hint, neighbor)) {
+            continue;
+        }
+        group = b >= 0 && abs(neighbor / map->stride - b_row) <= 1 && abs(neighbor % map->stride - b_column) <= 1
+                ? PATTERN_GROUP_SHARED : PATTERN_GROUP_ONLY_A;
+        if (PATTERN_RESULT_OF(entry, group) == PATTERN_SAFE) {
+            MarkSafe(hint, neighbor);
+        } else if (PATTERN_RESULT_OF(entry, group) == PATTERN_MINE) {
+            MarkMine(hint, neighbor);
+        }
+    }
+
+    // B周围不与A相邻的方块属于只属于B的组
+    if (b < 0 || PATTERN_RESULT_OF(entry, PATTERN_GROUP_ONLY_B) == PATTERN_UNKNOWN) {
+        return;
+    }
+    for (k = 0; k < 8; k++) {
+        neighbor = b + map->neighbor_offsets[k];
+        if (! IsOpenBlock(hint, neighbor)
+            || (abs(neighbor / map->stride - a / map->stride) <= 1 && abs(neighbor % map->stride - a % map->stride) <= 1)) {
+            continue;
+        }
+        if (PATTERN_RESULT_OF(entry, PATTERN_GROUP_ONLY_B) == PATTERN_SAFE) {
+            MarkSafe(hint, neighbor);
+        } else {
+            MarkMine(hint, neighbor);
+        }
+    }
+}
+
+/**
+ * 判断一个数字的计数能否作为约束
+ *
+ * @param hint              提示服务指针
+ * @param index             数字在方块表中的下标
+ * @return                  周围有未推出结果的方块，且剩余的地雷数不超过它们的个数
+ */
+static _Bool IsUsableNumber(HintService *hint, int index) {
+    return hint->unknown[index] > 0 && hint->remaining[index] >= 0 && hint->remaining[index] <= hint->unknown[index];
+}
+
+/**
+ * 推理待推理列表中的数字，更新它们周围方块的风险桶，并清空列表
+ *
+ * 每个数字与距离不超过2的每个数字组合查表，代价与列表长度成正比。
+ * 推出的结果会改变周围数字的计数并把它们重新放入列表，直到推不出新的结果为止。
+ *
+ * @param hint              提示服务指针
+ */
+static void ProcessTouched(HintService *hint) {
+    // 地图指针
+    Map *map = hint->map;
+    // 列表序号
+    int i;
+    // 数字下标、另一个数字的下标、邻居下标
+    int index, other, neighbor;
+    // 行偏移量、列偏移量、邻居序号
+    int row_offset, column_offset, k;
+    // 方块表中数字的行、列
+    int row, column;
+
+    for (i = 0; i < hint->touched_length; i++) {
+        index = hint->touched[i];
+        hint->marks[index] &= ~HINT_MARK_TOUCHED;
+        if (! IsUsableNumber(hint, index)) {
+            continue;
+        }
+
+        DeducePair(hint, index, -1);
+        row = index / map->stride;
+        column = index % map->stride;
+        for (row_offset = -2; row_offset <= 2; row_offset++) {
+            if (row + row_offset < 1 || row + row_offset > map->number_of_rows) {
+                continue;
+            }
+            for (column_offset = -2; column_offset <= 2; column_offset++) {
+                if (column + column_offset < 1 || column + column_offset > map->number_of_columns
+                    || (row_offset == 0 && column_offset == 0)) {
+                    continue;
+                }
+                // 计数改变的数字都已在列表中，其余数字的计数仍然有效
+                other = index + row_offset * map->stride + column_offset;
+                if (IsNumberBlock(map, other) && IsUsableNumber(hint, other)) {
+                    DeducePair(hint, index, other);
+                }
+            }
+        }
+    }
+
+    for (i = 0; i < hint->touched_length; i++) {
+        index = hint->touched[i];
+        for (k = 0; k < 8; k++) {
+            neighbor = index + map->neighbor_offsets[k];
+            if (IsUnknownBlock(map->blocks[neighbor])) {
+                Relist(hint, neighbor);
+            }
+        }
+    }
+    hint->touched_length = 0;
+}
+
+/**
+ * 读取变更日志中的新记录，更新受影响的数字和方块
+ *
+ * 旗标不影响推理，插旗或取消旗标只改变方块能否返回：已推出安全的方块取消旗标后重新入栈
+ *
+ * @param hint              提示服务指针
+ */
+static void ConsumeJournal(HintService *hint) {
+    // 地图指针
+    Map *map = hint->map;
+    // 方块下标
+    int index;
+    // 邻居序号
+    int k;
+
+    for (; hint->journal_position < map->journal_length; hint->journal_position++) {
+        index = map->journal[hint->journal_position].index;
+        Touch(hint, index);
+        for (k = 0; k < 8; k++) {
+            Touch(hint, index + map->neighbor_offsets[k]);
+        }
+        Relist(hint, index);
+        UpdateHidden(hint, index);
+        if ((hint->marks[index] & HINT_MARK_SAFE) && BLOCK_STATUS_OF(map->journal[hint->journal_position].previous) == BLOCK_STATUS_FLAG
+            && IsSelectableBlock(map->blocks[index])) {
+            PushIndex(&hint->safe_stack, &hint->safe_length, &hint->safe_capacity, index);
+        }
+    }
+
+    ProcessTouched(hint);
+}
+
+/**
+ * 创建提示服务
+ *
+ * 启用地图的变更日志，并根据当前地图完整计算一次，之后只做增量更新
+ *
+ * @param map               地图指针，散布地雷后才能查询
+ * @param endgame_threshold 残局阈值：未推出是地雷的未翻开方块不超过它时进行残局搜索，
+ *                          为0时不搜索，超过ENDGAME_MAX_UNKNOWN时按ENDGAME_MAX_UNKNOWN
+ * @return                  分配的内存地址
+ */
+HintService * CreateHintService(Map *map, int endgame_threshold) {
+    // 提示服务指针
+    HintService *hint;
+    // 方块表的方块数
+    size_t size = (size_t)(map->number_of_rows + 2) * (size_t)map->stride;
+    // 方块下标
+    size_t index;
+    // 桶号
+    int bucket;
+    // 行下标、列下标（方块表中，含哨兵行、列）
+    int row, column;
+
+    hint = (HintService *)calloc(1, sizeof(HintService));
+    if (! hint) {
+        return NULL;
+    }
+
+    hint->map = map;
+    hint->endgame_threshold = endgame_threshold < 0 ? 0
+                              : endgame_threshold > ENDGAME_MAX_UNKNOWN ? ENDGAME_MAX_UNKNOWN : endgame_threshold;
+    hint->win_probability = -1;
+    hint->remaining = (int8_t *)calloc(size, sizeof(int8_t));
+    hint->unknown = (int8_t *)calloc(size, sizeof(int8_t));
+    hint->marks = (uint8_t *)calloc(size, sizeof(uint8_t));
+    hint->buckets = (int16_t *)malloc(sizeof(int16_t) * size);
+    hint->next = (int *)malloc(sizeof(int) * size);
+    hint->previous = (int *)malloc(sizeof(int) * size);
+    hint->hidden_blocks = (int *)malloc(sizeof(int) * (size_t)map->number_of_rows * (size_t)map->number_of_columns);
+    hint->hidden_positions = (int *)malloc(sizeof(int) * size);
+    if (! hint->remaining || ! hint->unknown || ! hint->marks || ! hint->buckets || ! hint->next || ! hint->previous
+        || ! hint->hidden_blocks || ! hint->hidden_positions || ! EnableJournal(map)) {
+        DestroyHintService(&hint);
+        return NULL;
+    }
+    hint->journal_position = map->journal_length;
+
+    for (index = 0; index < size; index++) {
+        hint->buckets[index] = -1;
+        hint->hidden_positions[index] = -1;
+    }
+    for (bucket = 0; bucket < HINT_NUMBER_OF_BUCKETS; bucket++) {
+        hint->heads[bucket] = -1;
+    }
+
+    // 全部数字都需要推理，全部未翻开方块都需要放入风险桶
+    for (row = 1; row <= map->number_of_rows; row++) {
+        for (column = 1; column <= map->number_of_columns; column++) {
+            Touch(hint, row * map->stride + column);
+        }
+    }
+    for (row = 1; row <= map->number_of_rows; row++) {
+        for (column = 1; column <= map->number_of_columns; column++) {
+            Relist(hint, row * map->stride + column);
+            UpdateHidden(hint, row * map->stride + column);
+        }
+    }
+    ProcessTouched(hint);
+
+    return hint;
+}
+
+/**
+ * 销毁提示服务
+ *
+ * 变更日志可能还有其他使用者，因此保持启用，随地图一起释放
+ *
+ * @param hint              提示服务指针的指针
+ */
+void DestroyHintService(HintService **hint) {
+    free((*hint)->remaining);
+    free((*hint)->unknown);
+    free((*hint)->marks);
+    free((*hint)->buckets);
+    free((*hint)->next);
+    free((*hint)->previous);
+    free((*hint)->safe_stack);
+    free((*hint)->touched);
+    free((*hint)->hidden_blocks);
+    free((*hint)->hidden_positions);
+    if ((*hint)->endgame) {
+        DestroyEndgame(&(*hint)->endgame);
+    }
+    free(*hint);
+    *hint = NULL;
+}
+
+/**
+ * 查询下一步走法
+ *
+ * 先处理上次查询以来的变更日志，再依次取一定安全的方块、残局搜索的最佳走法、局部风险最小的方块。
+ * 残局搜索失败（布局过多、超出预算等）时退回局部风险。前沿方块与内部方块风险相同时取前沿方块。
+ * 残局搜索使用增量维护的未翻开方块表，不扫描方块表；旗标与其他未翻开的方块一样枚举，
+ * 推出是地雷的方块不必枚举；局面不变时不重复搜索，失败的搜索也不重复。
+ *
+ * @param hint              提示服务指针
+ * @param row               行下标指针
+ * @param column            列下标指针
+ * @param probability       估计是地雷的概率指针，一定安全时为0
+ * @return                  是否还有未翻开的方块
+ */
+_Bool GetHint(HintService *hint, int *row, int *column, double *probability) {
+    // 地图指针
+    Map *map = hint->map;
+    // 方块下标
+    int index = -1;
+    // 字下标、桶号
+    int word, bucket = -1;
+    // 未推出是地雷的未翻开方块数、其中的地雷数
+    long long unknown, mines;
+
+    ConsumeJournal(hint);
+    hint->win_probability = -1;
+
+    // 已翻开或已插旗的安全方块出栈
+    while (hint->safe_length > 0) {
+        index = hint->safe_stack[hint->safe_length - 1];
+        if (IsSelectableBlock(map->blocks[index])) {
+            *probability = 0;
+            break;
+        }
+        hint->safe_length--;
+        index = -1;
+    }
+
+    // 旗标不是前提，只减去推出的地雷
+    unknown = hint->number_of_hidden_blocks;
+    mines = map->number_of_mines - (map->number_of_invisible_blocks - unknown);
+    if (index < 0 && unknown > 0 && unknown <= hint->endgame_threshold) {
+        if (! hint->endgame) {
+            hint->endgame = CreateEndgame(map);
+        }
+        if (hint->endgame) {
+            hint->endgame->cache = hint->cache;
+        }
+        if (hint->endgame && SolveEndgameBlocks(hint->endgame, hint->hidden_blocks, hint->number_of_hidden_blocks)) {
+            *row = hint->endgame->best_row;
+            *column = hint->endgame->best_column;
+            *probability = hint->endgame->mine_probability;
+            hint->win_probability = hint->endgame->win_probability;
+            return 1;
+        }
+    }
+
+    if (index < 0) {
+        for (word = 0; word < HINT_BUCKET_WORDS; word++) {
+            if (hint->nonempty[word]) {
+                bucket = word * 64 + __builtin_ctzll(hint->nonempty[word]);
+                index = hint->heads[bucket];
+                *probability = (double)bucket / HINT_RISK_SCALE;
+                break;
+            }
+        }
+
+        if (hint->heads[HINT_INTERIOR_BUCKET] >= 0 && unknown > 0
+            && (index < 0 || (double)mines / unknown < *probability)) {
+            index = hint->heads[HINT_INTERIOR_BUCKET];
+            *probability = (double)mines / unknown;
+        }
+    }
+
+    if (index < 0) {
+        return 0;
+    }
+
+    *row = index / map->stride - 1;
+    *column = index % map->stride - 1;
+
+    return 1;
+}
@@ -0,0 +1,107 @@
+/**
+ * ----------------------------------------------------------------------------
+ * [头文件] 提示
+ * ----------------------------------------------------------------------------
+ *
+ * 定义增量维护的“下一步安全走法”提示服务的数据结构和函数原型
+ *
+ * 提示服务从地图的变更日志中读取每次处理方块改变的方块，只更新它们周围数字的剩余地雷数、
+ * 未翻开方块数和推理结果，查询的代价与上一步改变的方块数成正比，不再扫描整个方块表。
+ * 有一定安全的方块时返回它；未翻开的方块少于残局阈值时返回残局搜索得到的胜率最大的方块，
+ * 否则返回按局部估计风险最小的方块。
+ * 推理只以已翻开的数字为前提，旗标不参与推理，也不会作为提示返回；
+ * 每次查询重新进行的残局搜索同样把旗标当作未翻开的方块，只省略由数字推出的地雷。
+ *
+ */
+
+
+#ifndef MINESWEEPING_HINT_H
+#define MINESWEEPING_HINT_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include "game.h"
+#include "endgame.h"
+
+/*
+ * 宏定义
+ */
+
+// 风险的分母：1 ~ 8的最小公倍数，使 剩余地雷数 / 未翻开方块数 都是整数
+#define HINT_RISK_SCALE       840
+// 风险桶数：风险0 ~ HINT_RISK_SCALE各一个桶，另加一个内部方块桶
+#define HINT_NUMBER_OF_BUCKETS (HINT_RISK_SCALE + 2)
+// 内部方块（不与任何已翻开的数字相邻的未翻开方块）桶
+#define HINT_INTERIOR_BUCKET  (HINT_RISK_SCALE + 1)
+// 非空风险桶位图的字数（不含内部方块桶）
+#define HINT_BUCKET_WORDS     ((HINT_RISK_SCALE + 1 + 63) / 64)
+
+/*
+ * 数据结构定义
+ */
+
+// 结构体：提示服务
+typedef struct {
+    // 地图，提示服务不拥有地图，销毁前地图大小不能改变
+    Map *map;
+    // 已处理到的变更日志位置
+    size_t journal_position;
+    // 每个数字剩余的地雷数（数字 - 周围推出的地雷数），按方块表下标存放，只对已翻开的数字有效
+    int8_t *remaining;
+    // 每个数字周围未推出结果的未翻开（含旗标）方块数，按方块表下标存放，只对已翻开的数字有效
+    int8_t *unknown;
+    // 每个方块的标记：已推出安全、已推出是地雷、本次更新已处理
+    uint8_t *marks;
+    // 每个未翻开方块所在的风险桶，不在任何桶中时为-1
+    int16_t *buckets;
+    // 风险桶链表中的下一个、上一个方块下标，-1表示没有
+    int *next, *previous;
+    // 每个风险桶链表的第一个方块下标，-1表示空桶
+    int heads[HINT_NUMBER_OF_BUCKETS];
+    // 非空风险桶位图
+    uint64_t nonempty[HINT_BUCKET_WORDS];
+    // 已推出安全、等待返回的方块下标栈，返回前再确认仍未翻开
+    int *safe_stack;
+    // 安全方块栈中的元素数
+    int safe_length;
+    // 安全方块栈容量（元素数）
+    int safe_capacity;
+    // 本次更新中需要重新推理的数字下标
+    int *touched;
+    // 需要重新推理的数字数
+    int touched_length;
+    // 需要重新推理的数字缓冲区容量（元素数）
+    int touched_capacity;
+    // 未推出是地雷的未翻开（含旗标和疑问标）方块下标，顺序任意，残局搜索不必扫描方块表
+    int *hidden_blocks;
+    // 未推出是地雷的未翻开方块数
+    int number_of_hidden_blocks;
+    // 每个方块在未翻开方块表中的位置，按方块表下标存放，不在表中时为-1
+    int *hidden_positions;
+    // 推出的安全方块数
+    long long number_of_safe_blocks;
+    // 推出的地雷方块数
+    long long number_of_mine_blocks;
+    // 残局阈值：未推出是地雷的未翻开方块数不超过它时进行残局搜索，为0时不搜索；创建时指定
+    int endgame_threshold;
+    // 残局搜索器，第一次搜索时创建
+    Endgame *endgame;
+    // 残局搜索器使用的置换表，为空时不缓存；提示服务不拥有置换表，多个提示服务可以共用
+    TranspositionCache *cache;
+    // 上次查询返回的走法的胜率，不是残局搜索的结果时为-1
+    double win_probability;
+} HintService;
+
+/*
+ * 函数原型
+ */
+
+// 创建提示服务
+HintService * CreateHintService(Map *map, int endgame_threshold);
+// 销毁提示服务
+void DestroyHintService(HintService **hint);
+// 查询下一步走法
+_Bool GetHint(HintService *hint, int *row, int *column, double *probability);
+
+#endif //MINESWEEPING_HINT_H
@@ -0,0 +1,684 @@
+/**
+ * ----------------------------------------------------------------------------
+ * [源文件] 线性方程组推理
+ * ----------------------------------------------------------------------------
+ *
+ * 定义把前沿数字当作线性方程组消元推理的各个函数
+ *
+ * 系数按位切片存放，一行的加减法是逐字的全加器：和 = a ^ b ^ 进位，进位 = 多数(a, b, 进位)，
+ * 每个字一次处理64个系数，代价与方块数 / 64 x 位数成正比。
+ * 消元只用系数为±1的主元，其余行减去主元行的整数倍，系数保持为整数；
+ * 系数超出补码范围的行被丢弃，只会少推出结果，不会推出错误的结果。
+ * 不共享方程的方块分属不同的连通分量，各自消元，大前沿不会退化为整个前沿的稠密矩阵。
+ *
+ */
+
+
+#include <stdlib.h>
+#include <string.h>
+
+#include "linear.h"
+
+
+/*
+ * 宏定义
+ */
+
+// 行标记：已被丢弃
+#define ROW_DROPPED  1
+// 行标记：已用作主元
+#define ROW_PIVOT    2
+
+// 方块标记：广度优先时已入队
+#define CELL_QUEUED  1
+// 方块标记：已推出结果
+#define CELL_DECIDED 2
+
+/**
+ * 按需扩大缓冲区
+ *
+ * 容量不足时扩容为所需容量和原容量2倍中的较大者，内存不足时保留原缓冲区
+ *
+ * @param buffer            缓冲区指针的指针
+ * @param capacity          容量指针（元素数）
+ * @param required          所需容量（元素数）
+ * @param size              每个元素的字节数
+ * @return                  容量是否足够
+ */
+static _Bool Reserve(void **buffer, size_t *capacity, size_t required, size_t size) {
+    // 新容量
+    size_t new_capacity;
+    // 新的缓冲区
+    void *new_buffer;
+
+    if (required <= *capacity) {
+        return 1;
+    }
+
+    new_capacity = *capacity * 2 > required ? *capacity * 2 : required;
+    new_buffer = realloc(*buffer, size * new_capacity);
+    if (! new_buffer) {
+        return 0;
+    }
+    *buffer = new_buffer;
+    *capacity = new_capacity;
+
+    return 1;
+}
+
+/**
+ * 重新分配一个缓冲区
+ *
+ * @param buffer            缓冲区指针的指针
+ * @param count             元素数
+ * @param size              每个元素的字节数
+ * @return                  是否分配成功，失败时保留原缓冲区
+ */
+static _Bool Resize(void **buffer, size_t count, size_t size) {
+    // 新的缓冲区
+    void *new_buffer = realloc(*buffer, size * count);
+
+    if (! new_buffer) {
+        return 0;
+    }
+    *buffer = new_buffer;
+
+    return 1;
+}
+
+/**
+ * 按需扩大前沿方块缓冲区
+ *
+ * 各缓冲区逐个重新分配，只有全部成功后才更新容量，部分成功时下次会重新分配全部缓冲区
+ *
+ * @param system            线性方程组指针
+ * @param required          所需容量（方块数）
+ * @return                  容量是否足够
+ */
+static _Bool ReserveCells(LinearSystem *system, size_t required) {
+    // 新容量
+    size_t capacity;
+
+    if (required <= system->cell_capacity) {
+        return 1;
+    }
+
+    capacity = system->cell_capacity * 2 > required ? system->cell_capacity * 2 : required;
+    if (! Resize((void **)&system->cells, capacity, sizeof(int))
+        || ! Resize((void **)&system->cell_equations, capacity * 8, sizeof(int))
+        || ! Resize((void **)&system->cell_equation_counts, capacity, sizeof(int))
+        || ! Resize((void **)&system->order, capacity, sizeof(int))
+        || ! Resize((void **)&system->columns, capacity, sizeof(int))
+        || ! Resize((void **)&system->marks, capacity, sizeof(uint8_t))
+        || ! Resize((void **)&system->component_starts, capacity + 1, sizeof(int))
+        || ! Resize((void **)&system->equation_starts, capacity + 1, sizeof(int))
+        || ! Resize((void **)&system->safe_blocks, capacity, sizeof(int))
+        || ! Resize((void **)&system->mine_blocks, capacity, sizeof(int))) {
+        return 0;
+    }
+    system->cell_capacity = capacity;
+
+    return 1;
+}
+
+/**
+ * 按需扩大方程缓冲区
+ *
+ * @param system            线性方程组指针
+ * @param required          所需容量（方程数）
+ * @return                  容量是否足够
+ */
+static _Bool ReserveEquations(LinearSystem *system, size_t required) {
+    // 新容量
+    size_t capacity;
+
+    if (required <= system->equation_capacity) {
+        return 1;
+    }
+
+    capacity = system->equation_capacity * 2 > required ? system->equation_capacity * 2 : required;
+    if (! Resize((void **)&system->equation_cells, capacity * 8, sizeof(int))
+        || ! Resize((void **)&system->equation_counts, capacity, sizeof(int))
+        || ! Resize((void **)&system->equation_remaining, capacity, sizeof(int))
+        || ! Resize((void **)&system->equation_order, capacity, sizeof(int))
+        || ! Resize((void **)&system->equation_marks, capacity, sizeof(uint8_t))) {
+        return 0;
+    }
+    system->equation_capacity = capacity;
+
+    return 1;
+}
+
+/**
+ * 创建线性方程组
+ *
+ * @param map               地图指针，方程组销毁前地图大小不能改变
+ * @return                  分配的内存地址
+ */
+LinearSystem * CreateLinearSystem(Map *map) {
+    // 线性方程组指针
+    LinearSystem *system;
+    // 方块表的方块数
+    size_t size = (size_t)(map->number_of_rows + 2) * (size_t)map->stride;
+    // 方块下标
+    size_t index;
+
+    system = (LinearSystem *)calloc(1, sizeof(LinearSystem));
+    if (! system) {
+        return NULL;
+    }
+
+    system->map = map;
+    system->block_cells = (int *)malloc(sizeof(int) * size);
+    // 没有前沿方块时也需要分量起始位置等缓冲区
+    if (! system->block_cells || ! ReserveCells(system, 64)) {
+        DestroyLinearSystem(&system);
+        return NULL;
+    }
+
+    for (index = 0; index < size; index++) {
+        system->block_cells[index] = -1;
+    }
+
+    return system;
+}
+
+/**
+ * 销毁线性方程组
+ *
+ * @param system            线性方程组指针的指针
+ */
+void DestroyLinearSystem(LinearSystem **system) {
+    free((*system)->safe_blocks);
+    free((*system)->mine_blocks);
+    free((*system)->block_cells);
+    free((*system)->cells);
+    free((*system)->cell_equations);
+    free((*system)->cell_equation_counts);
+    free((*system)->order);
+    free((*system)->columns);
+    free((*system)->marks);
+    free((*system)->component_starts);
+    free((*system)->equation_cells);
+    free((*system)->equation_counts);
+    free((*system)->equation_remaining);
+    free((*system)->equation_order);
+    free((*system)->equation_starts);
+    free((*system)->equation_marks);
+    free((*system)->rows);
+    free((*system)->constants);
+    free((*system)->row_flags);
+    free(*system);
+    *system = NULL;
+}
+
+/**
+ * 收集前沿方块和方程
+ *
+ * 每个周围有未翻开方块的已翻开数字成为一个方程，旗标和疑问标当作未翻开处理，
+ * 已知的地雷从剩余的地雷数中减去，与已知地雷矛盾的数字不成为方程
+ *
+ * @param system            线性方程组指针
+ * @return                  是否成功：内存不足时失败
+ */
+static _Bool CollectEquations(LinearSystem *system) {
+    // 地图指针
+    Map *map = system->map;
+    // 行下标、列下标（方块表中，含哨兵行、列）
+    int row, column;
+    // 方块下标、邻居下标
+    int index, neighbor;
+    // 邻居序号
+    int k;
+    // 方块
+    Block block;
+    // 邻居状态
+    BlockStatus status;
+    // 方程编号、前沿编号
+    int equation, cell;
+    // 邻居中的未翻开方块
+    int unknown[8];
+    // 未翻开方块数、剩余的地雷数
+    int count, remaining;
+
+    system->number_of_frontier_blocks = 0;
+    system->number_of_equations = 0;
+    for (row = 1; row <= map->number_of_rows; row++) {
+        for (column = 1; column <= map->number_of_columns; column++) {
+            index = row * map->stride + column;
+            block = map->blocks[index];
+            if (BLOCK_STATUS_OF(block) != BLOCK_STATUS_VISIBLE || BLOCK_TYPE_OF(block) == BLOCK_TYPE_MINE) {
+                continue;
+            }
+
+            count = 0;
+            remaining = BLOCK_TYPE_OF(block);
+            for (k = 0; k < 8; k++) {
+                neighbor = index + map->neighbor_offsets[k];
+                status = BLOCK_STATUS_OF(map->blocks[neighbor]);
+                if (status == BLOCK_STATUS_VISIBLE) {
+                    continue;
+                }
+                if (system->known_mines && system->known_mines[neighbor]) {
+                    remaining--;
+                } else {
+                    unknown[count++] = neighbor;
+                }
+            }
+            if (count == 0 || remaining < 0 || remaining > count) {
+                continue;
+            }
+
+            if (! ReserveEquations(system, (size_t)system->number_of_equations + 1)
+                || ! ReserveCells(system, (size_t)system->number_of_frontier_blocks + 8)) {
+                return 0;
+            }
+
+            equation = system->number_of_equations++;
+            system->equation_counts[equation] = count;
+            system->equation_remaining[equation] = remaining;
+            system->equation_marks[equation] = 0;
+            for (k = 0; k < count; k++) {
+                cell = system->block_cells[unknown[k]];
+                if (cell < 0) {
+                    cell = system->number_of_frontier_blocks++;
+                    system->block_cells[unknown[k]] = cell;
+                    system->cells[cell] = unknown[k];
+                    system->cell_equation_counts[cell] = 0;
+                    system->marks[cell] = 0;
+                }
+                system->cell_equations[cell * 8 + system->cell_equation_counts[cell]++] = equation;
+                system->equation_cells[equation * 8 + k] = cell;
+            }
+        }
+    }
+
+    return 1;
+}
+
+/**
+ * 按连通分量排列前沿方块和方程
+ *
+ * 分量内按广度优先顺序排列，相邻的列对应相邻的方块，消元时填充较少
+ *
+ * @param system            线性方程组指针
+ */
+static void FindComponents(LinearSystem *system) {
+    // 起点、队首、队尾
+    int start, head, tail = 0;
+    // 已排列的方程数
+    int equations = 0;
+    // 前沿编号、邻居前沿编号
+    int cell, other;
+    // 方程序号、方块序号
+    int i, j;
+    // 方程编号
+    int equation;
+
+    system->number_of_components = 0;
+    for (start = 0; start < system->number_of_frontier_blocks; start++) {
+        if (system->marks[start] & CELL_QUEUED) {
+            continue;
+        }
+
+        system->component_starts[system->number_of_components] = tail;
+        system->equation_starts[system->number_of_components] = equations;
+        system->number_of_components++;
+        head = tail;
+        system->order[tail++] = start;
+        system->marks[start] |= CELL_QUEUED;
+        while (head < tail) {
+            cell = system->order[head];
+            system->columns[cell] = head - system->component_starts[system->number_of_components - 1];
+            head++;
+            for (i = 0; i < system->cell_equation_counts[cell]; i++) {
+                equation = system->cell_equations[cell * 8 + i];
+                if (system->equation_marks[equation]) {
+                    continue;
+                }
+                system->equation_marks[equation] = 1;
+                system->equation_order[equations++] = equation;
+                for (j = 0; j < system->equation_counts[equation]; j++) {
+                    other = system->equation_cells[equation * 8 + j];
+                    if (! (system->marks[other] & CELL_QUEUED)) {
+                        system->marks[other] |= CELL_QUEUED;
+                        system->order[tail++] = other;
+                    }
+                }
+            }
+        }
+    }
+    system->component_starts[system->number_of_components] = tail;
+    system->equation_starts[system->number_of_components] = equations;
+}
+
+/**
+ * 读取一行中一列的系数
+ *
+ * @param row               行指针
+ * @param words             每个位平面的字数
+ * @param column            列号
+ * @return                  系数
+ */
+static int GetCoefficient(const uint64_t *row, int words, int column) {
+    // 位平面序号
+    int plane;
+    // 系数的补码
+    int value = 0;
+
+    for (plane = 0; plane < LINEAR_COEFFICIENT_BITS; plane++) {
+        value |= (int)((row[(size_t)plane * words + column / 64] >> (column % 64)) & 1) << plane;
+    }
+
+    return value & (1 << (LINEAR_COEFFICIENT_BITS - 1)) ? value - (1 << LINEAR_COEFFICIENT_BITS) : value;
+}
+
+/**
+ * 一列的系数是否为0
+ *
+ * @param row               行指针
+ * @param words             每个位平面的字数
+ * @param column            列号
+ * @return                  是否为0
+ */
+static _Bool IsZeroCoefficient(const uint64_t *row, int words, int column) {
+    // 位平面序号
+    int plane;
+    // 各位平面中这一列所在的字的或
+    uint64_t bits = 0;
+
+    for (plane = 0; plane < LINEAR_COEFFICIENT_BITS; plane++) {
+        bits |= row[(size_t)plane * words + column / 64];
+    }
+
+    return ! ((bits >> (column % 64)) & 1);
+}
+
+/**
+ * 将一行加上或减去另一行
+ *
+ * 逐字做按位切片的全加器；减法按补码把另一行取反，最低位进位为1
+ *
+ * @param target            被加的行
+ * @param source            加上的行
+ * @param words             每个位平面的字数
+ * @param is_subtract       是否为减法
+ * @return                  是否有系数溢出
+ */
+static _Bool AddRow(uint64_t *target, const uint64_t *source, int words, _Bool is_subtract) {
+    // 取反掩码
+    uint64_t invert = is_subtract ? ~(uint64_t)0 : 0;
+    // 字下标、位平面序号
+    int word, plane;
+    // 进位、加数、被加数
+    uint64_t carry, a, b;
+    // 溢出位
+    uint64_t overflow = 0;
+
+    for (word = 0; word < words; word++) {
+        carry = invert;
+        for (plane = 0; plane < LINEAR_COEFFICIENT_BITS; plane++) {
+            a = target[(size_t)plane * words + word];
+            b = source[(size_t)plane * words + word] ^ invert;
+            target[(size_t)plane * words + word] = a ^ b ^ carry;
+            carry = (a & b) | (carry & (a ^ b));
+        }
+        // 两个加数符号相同而和的符号不同时溢出
+        overflow |= ~(a ^ b) & (a ^ target[(size_t)(LINEAR_COEFFICIENT_BITS - 1) * words + word]);
+    }
+
+    return overflow != 0;
+}
+
+/**
+ * 逐列消元
+ *
+ * 每一列选一个该列系数为±1、尚未用作主元的行作主元，
+ * 其余各行（含已用作主元的行）减去主元行的整数倍使该列系数为0。
+ * 找不到这样的主元时跳过这一列。
+ *
+ * @param system            线性方程组指针
+ * @param number_of_rows    行数
+ * @param number_of_columns 列数
+ * @param words             每个位平面的字数
+ */
+static void Eliminate(LinearSystem *system, int number_of_rows, int number_of_columns, int words) {
+    // 每行的字数
+    size_t stride = (size_t)LINEAR_COEFFICIENT_BITS * words;
+    // 列号
+    int column;
+    // 行号、主元行号
+    int i, pivot;
+    // 主元系数、被消元行的系数
+    int pivot_value, value;
+    // 倍数、次数
+    int multiple, times;
+    // 主元行、被消元行
+    uint64_t *pivot_row, *row;
+
+    for (column = 0; column < number_of_columns; column++) {
+        pivot = -1;
+        pivot_value = 0;
+        for (i = 0; i < number_of_rows; i++) {
+            if (system->row_flags[i] || IsZeroCoefficient(system->rows + i * stride, words, column)) {
+                continue;
+            }
+            pivot_value = GetCoefficient(system->rows + i * stride, words, column);
+            if (pivot_value == 1 || pivot_value == -1) {
+                pivot = i;
+                break;
+            }
+        }
+        if (pivot < 0) {
+            continue;
+        }
+
+        system->row_flags[pivot] |= ROW_PIVOT;
+        pivot_row = system->rows + (size_t)pivot * stride;
+        for (i = 0; i < number_of_rows; i++) {
+            row = system->rows + (size_t)i * stride;
+            if (i == pivot || (system->row_flags[i] & ROW_DROPPED) || IsZeroCoefficient(row, words, column)) {
+                continue;
+            }
+
+            // 主元系数为±1，减去 系数 x 主元系数 倍的主元行即可消去这一列
+            value = GetCoefficient(row, words, column);
+            multiple = value * pivot_value;
+            system->constants[i] -= (long long)multiple * system->constants[pivot];
+            for (times = multiple > 0 ? multiple : -multiple; times > 0; times--) {
+                if (AddRow(row, pivot_row, words, multiple > 0)) {
+                    system->row_flags[i] |= ROW_DROPPED;
+                    break;
+                }
+            }
+        }
+    }
+}
+
+/**
+ * 记录一个推出的方块
+ *
+ * @param system            线性方程组指针
+ * @param cell              前沿编号
+ * @param is_mine           是否是地雷
+ */
+static void Decide(LinearSystem *system, int cell, _Bool is_mine) {
+    if (system->marks[cell] & CELL_DECIDED) {
+        return;
+    }
+
+    system->marks[cell] |= CELL_DECIDED;
+    if (is_mine) {
+        system->mine_blocks[system->number_of_mine_blocks++] = system->cells[cell];
+    } else {
+        system->safe_blocks[system->number_of_safe_blocks++] = system->cells[cell];
+    }
+}
+
+/**
+ * 对消元后的各行做上下界推理
+ *
+ * 变量只能取0或1，一行的值在 负系数之和 与 正系数之和 之间；
+ * 常数项等于下界时正系数的变量全为0、负系数的变量全为1，等于上界时相反
+ *
+ * @param system            线性方程组指针
+ * @param component         分量编号
+ * @param number_of_rows    行数
+ * @param words             每个位平面的字数
+ */
+static void DeduceBounds(LinearSystem *system, int component, int number_of_rows, int words) {
+    // 每行的字数
+    size_t stride = (size_t)LINEAR_COEFFICIENT_BITS * words;
+    // 分量在排列中的起始位置
+    int start = system->component_starts[component];
+    // 行号、字下标、位平面序号、列号
+    int i, word, plane, column;
+    // 行
+    const uint64_t *row;
+    // 非零系数的位
+    uint64_t support;
+    // 系数
+    int value;
+    // 下界、上界
+    long long lower, upper;
+    // 常数项等于下界、上界
+    _Bool is_lower, is_upper;
+
+    for (i = 0; i < number_of_rows; i++) {
+        if (system->row_flags[i] & ROW_DROPPED) {
+            continue;
+        }
+        row = system->rows + (size_t)i * stride;
+
+        lower = 0;
+        upper = 0;
+        for (word = 0; word < words; word++) {
+            support = 0;
+            for (plane = 0; plane < LINEAR_COEFFICIENT_BITS; plane++) {
+                support |= row[(size_t)plane * words + word];
+            }
+            for (; support; support &= support - 1) {
+                value = GetCoefficient(row, words, word * 64 + __builtin_ctzll(support));
+                if (value < 0) {
+                    lower += value;
+                } else {
+                    upper += value;
+                }
+            }
+        }
+
+        is_lower = system->constants[i] == lower;
+        is_upper = system->constants[i] == upper;
+        if (lower == upper || (! is_lower && ! is_upper)) {
+            continue;
+        }
+
+        for (word = 0; word < words; word++) {
+            support = 0;
+            for (plane = 0; plane < LINEAR_COEFFICIENT_BITS; plane++) {
+                support |= row[(size_t)plane * words + word];
+            }
+            for (; support; support &= support - 1) {
+                column = word * 64 + __builtin_ctzll(support);
+                value = GetCoefficient(row, words, column);
+                Decide(system, system->order[start + column], (value > 0) == is_upper);
+            }
+        }
+    }
+}
+
+/**
+ * 对一个连通分量建立系数矩阵并消元推理
+ *
+ * @param system            线性方程组指针
+ * @param component         分量编号
+ * @return                  是否成功：内存不足时失败
+ */
+static _Bool SolveComponent(LinearSystem *system, int component) {
+    // 列数
+    int number_of_columns = system->component_starts[component + 1] - system->component_starts[component];
+    // 行数
+    int number_of_rows = system->equation_starts[component + 1] - system->equation_starts[component];
+    // 每个位平面的字数
+    int words = (number_of_columns + 63) / 64;
+    // 每行的字数
+    size_t stride = (size_t)LINEAR_COEFFICIENT_BITS * words;
+    // 行号、方块序号
+    int i, k;
+    // 方程编号、列号
+    int equation, column;
+
+    // 单个方块的分量已由单个数字的规则处理
+    if (number_of_columns < 2) {
+        return 1;
+    }
+
+    if (! Reserve((void **)&system->rows, &system->row_capacity, stride * number_of_rows, sizeof(uint64_t))
+        || ! Reserve((void **)&system->constants, &system->constant_capacity, (size_t)number_of_rows,
+                     sizeof(long long))
+        || ! Reserve((void **)&system->row_flags, &system->row_flag_capacity, (size_t)number_of_rows,
+                     sizeof(uint8_t))) {
+        return 0;
+    }
+
+    memset(system->rows, 0, sizeof(uint64_t) * stride * number_of_rows);
+    memset(system->row_flags, 0, (size_t)number_of_rows);
+    for (i = 0; i < number_of_rows; i++) {
+        equation = system->equation_order[system->equation_starts[component] + i];
+        system->constants[i] = system->equation_remaining[equation];
+        // 系数都是1，只在第0个位平面置位
+        for (k = 0; k < system->equation_counts[equation]; k++) {
+            column = system->columns[system->equation_cells[equation * 8 + k]];
+            system->rows[i * stride + column / 64] |= (uint64_t)1 << (column % 64);
+        }
+    }
+
+    Eliminate(system, number_of_rows, number_of_columns, words);
+    DeduceBounds(system, component, number_of_rows, words);
+
+    for (i = 0; i < number_of_rows; i++) {
+        if (system->row_flags[i] & ROW_DROPPED) {
+            system->number_of_dropped_rows++;
+        }
+    }
+
+    return 1;
+}
+
+/**
+ * 根据当前地图建立方程组并消元推理
+ *
+ * 推出的方块存入安全方块表和地雷方块表，不改变地图，由调用者走棋
+ *
+ * @param system            线性方程组指针
+ * @return                  是否成功：内存不足时失败，已推出的结果仍然有效
+ */
+_Bool SolveLinearSystem(LinearSystem *system) {
+    // 分量编号
+    int component;
+    // 前沿编号
+    int cell;
+    // 是否成功
+    _Bool is_successful = 1;
+
+    system->number_of_safe_blocks = 0;
+    system->number_of_mine_blocks = 0;
+    system->number_of_dropped_rows = 0;
+    system->number_of_components = 0;
+
+    if (! CollectEquations(system)) {
+        is_successful = 0;
+    } else {
+        FindComponents(system);
+        for (component = 0; component < system->number_of_components && is_successful; component++) {
+            is_successful = SolveComponent(system, component);
+        }
+    }
+
+    // 只清除本次用到的前沿编号，不再扫描整个方块表
+    for (cell = 0; cell < system->number_of_frontier_blocks; cell++) {
+        system->block_cells[system->cells[cell]] = -1;
+    }
+
+    return is_successful;
+}
@@ -0,0 +1,119 @@
+/**
+ * ----------------------------------------------------------------------------
+ * [头文件] 线性方程组推理
+ * ----------------------------------------------------------------------------
+ *
+ * 定义把前沿数字当作线性方程组消元推理的数据结构和函数原型
+ *
+ * 每个已翻开的数字是一个方程：周围未翻开方块的变量（1为地雷，0为安全）之和等于剩余的地雷数。
+ * 方程组按连通分量分别消元，每行的系数按位切片存放：第b个位平面的每个字保存64个系数的第b位，
+ * 加减法用逐字的异或、与运算完成。消元后对每行做上下界推理，找出一定安全或一定是地雷的方块。
+ * 旗标不被当作地雷，插错的旗标不会导致错误的结果；只有调用者给出的已知地雷（例如解机自己推出的地雷）才从方程中减去。
+ *
+ */
+
+
+#ifndef MINESWEEPING_LINEAR_H
+#define MINESWEEPING_LINEAR_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include "game.h"
+
+/*
+ * 宏定义
+ */
+
+// 系数的位数，按补码表示，超出范围的行被丢弃
+#define LINEAR_COEFFICIENT_BITS 8
+
+/*
+ * 数据结构定义
+ */
+
+// 结构体：线性方程组
+typedef struct {
+    // 地图，方程组不拥有地图
+    Map *map;
+    // 已知是地雷的方块，按方块表下标存放，非0为地雷；为NULL时没有已知的地雷。方程组不拥有这个数组
+    const uint8_t *known_mines;
+    // 前沿方块数
+    int number_of_frontier_blocks;
+    // 方程数
+    int number_of_equations;
+    // 连通分量数
+    int number_of_components;
+    // 上次推理中因系数溢出被丢弃的行数
+    int number_of_dropped_rows;
+    // 上次推理推出的安全方块在方块表中的下标
+    int *safe_blocks;
+    // 推出的安全方块数
+    int number_of_safe_blocks;
+    // 上次推理推出的地雷方块在方块表中的下标
+    int *mine_blocks;
+    // 推出的地雷方块数
+    int number_of_mine_blocks;
+
+    /*
+     * 以下为推理时使用的缓冲区，在多次推理间复用
+     */
+
+    // 每个方块的前沿编号，按方块表下标存放，不是前沿方块时为-1
+    int *block_cells;
+    // 前沿方块在方块表中的下标，按前沿编号存放
+    int *cells;
+    // 每个前沿方块所在的方程编号，每个方块8个位置
+    int *cell_equations;
+    // 每个前沿方块所在的方程数
+    int *cell_equation_counts;
+    // 按连通分量分组、分量内按广度优先顺序排列的前沿编号，也是消元时的列顺序
+    int *order;
+    // 每个前沿方块在所属分量中的列号
+    int *columns;
+    // 每个前沿方块是否已入队（广度优先时）、已推出结果（推理时）
+    uint8_t *marks;
+    // 每个连通分量在排列中的起始位置，最后一个元素为前沿方块数
+    int *component_starts;
+    // 前沿方块缓冲区容量（方块数）
+    size_t cell_capacity;
+    // 每个方程包含的前沿编号，每个方程8个位置
+    int *equation_cells;
+    // 每个方程包含的前沿方块数
+    int *equation_counts;
+    // 每个方程剩余的地雷数
+    int *equation_remaining;
+    // 按连通分量分组排列的方程编号
+    int *equation_order;
+    // 每个连通分量在方程排列中的起始位置，最后一个元素为方程数，与前沿方块缓冲区一起分配
+    int *equation_starts;
+    // 每个方程是否已排列
+    uint8_t *equation_marks;
+    // 方程缓冲区容量（方程数）
+    size_t equation_capacity;
+    // 当前分量的系数矩阵，每行占 位数 x 字数 个字
+    uint64_t *rows;
+    // 当前分量每行的常数项
+    long long *constants;
+    // 当前分量每行是否已被丢弃或已用作主元
+    uint8_t *row_flags;
+    // 矩阵缓冲区容量（字数）
+    size_t row_capacity;
+    // 常数项缓冲区容量（行数）
+    size_t constant_capacity;
+    // 行标记缓冲区容量（行数）
+    size_t row_flag_capacity;
+} LinearSystem;
+
+/*
+ * 函数原型
+ */
+
+// 创建线性方程组
+LinearSystem * CreateLinearSystem(Map *map);
+// 销毁线性方程组
+void DestroyLinearSystem(LinearSystem **system);
+// 根据当前地图建立方程组并消元推理
+_Bool SolveLinearSystem(LinearSystem *system);
+
+#endif //MINESWEEPING_LINEAR_H
@@ -0,0 +1,247 @@
+/**
+ * ----------------------------------------------------------------------------
+ * [源文件] 周围地雷数
+ * ----------------------------------------------------------------------------
+ *
+ * 定义计算方块周围地雷数的内核函数
+ *
+ * 每个方块的周围地雷数 = 上、中、下三行的水平3格地雷数之和 - 自身是否为地雷。
+ * 内核按整行处理，运行时根据处理器支持情况选择AVX2、SSE2或标量实现。
+ * 方块表可以原地改写：地雷方块保持不变，非地雷方块写入的数值（0 ~ 8）永远不等于地雷，
+ * 因此后续读取的地雷掩码不受已写入结果的影响。
+ *
+ */
+
+
+#include "neighbor.h"
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#define NEIGHBOR_KERNEL_X86
+#include <immintrin.h>
+#endif
+
+
+// 内核函数类型
+typedef void (*NeighborKernel)(Block *blocks, int stride, int columns, int row_begin, int row_end);
+
+/**
+ * 标量实现，同时用于处理向量实现剩余的尾部方块
+ *
+ * @param row_blocks        行首（第0列）方块指针
+ * @param stride            行跨度
+ * @param column_begin      起始列下标
+ * @param column_end        结束列下标（不含）
+ */
+static void CountRowScalar(Block *row_blocks, int stride, int column_begin, int column_end) {
+    // 列下标
+    int column;
+    // 上、中、下三行的指针
+    Block *up = row_blocks - stride, *middle = row_blocks, *down = row_blocks + stride;
+    // 水平3格地雷数之和
+    int sum;
+    // 当前方块是否为地雷
+    int is_mine;
+
+    for (column = column_begin; column < column_end; column++) {
+        is_mine = BLOCK_TYPE_OF(middle[column]) == BLOCK_TYPE_MINE;
+        if (is_mine) {
+            continue;
+        }
+        sum = (BLOCK_TYPE_OF(up[column - 1]) == BLOCK_TYPE_MINE)
+              + (BLOCK_TYPE_OF(up[column]) == BLOCK_TYPE_MINE)
+              + (BLOCK_TYPE_OF(up[column + 1]) == BLOCK_TYPE_MINE)
+              + (BLOCK_TYPE_OF(middle[column - 1]) == BLOCK_TYPE_MINE)
+              + (BLOCK_TYPE_OF(middle[column + 1]) == BLOCK_TYPE_MINE)
+              + (BLOCK_TYPE_OF(down[column - 1]) == BLOCK_TYPE_MINE)
+              + (BLOCK_TYPE_OF(down[column]) == BLOCK_TYPE_MINE)
+              + (BLOCK_TYPE_OF(down[column + 1]) == BLOCK_TYPE_MINE);
+        SET_BLOCK_TYPE(middle[column], sum);
+    }
+}
+
+/**
+ * 标量内核
+ *
+ * @param blocks            方块表指针
+ * @param stride            行跨度
+ * @param columns           列数
+ * @param row_begin         起始行下标
+ * @param row_end           结束行下标（不含）
+ */
+static void CountNeighborMinesScalar(Block *blocks, int stride, int columns, int row_begin, int row_end) {
+    // 行下标
+    int row;
+
+    for (row = row_begin; row < row_end; row++) {
+        CountRowScalar(blocks + (size_t)(row + 1) * stride + 1, stride, 0, columns);
+    }
+}
+
+#ifdef NEIGHBOR_KERNEL_X86
+
+/**
+ * SSE2内核，每次处理16个方块
+ *
+ * @param blocks            方块表指针
+ * @param stride            行跨度
+ * @param columns           列数
+ * @param row_begin         起始行下标
+ * @param row_end           结束行下标（不含）
+ */
+__attribute__((target("sse2")))
+static void CountNeighborMinesSse2(Block *blocks, int stride, int columns, int row_begin, int row_end) {
+    // 行下标
+    int row;
+    // 列下标
+    int column;
+    // 行首方块指针
+    Block *p;
+    // 常量：类型掩码、地雷类型、状态掩码
+    const __m128i type_mask = _mm_set1_epi8(BLOCK_TYPE_MASK);
+    const __m128i mine = _mm_set1_epi8(BLOCK_TYPE_MINE);
+    const __m128i status_mask = _mm_set1_epi8((char)~BLOCK_TYPE_MASK);
+    // 中心方块及其地雷掩码（地雷为0xFF，否则为0）
+    __m128i center, center_mine;
+    // 三行的水平和（每个地雷计为-1）
+    __m128i sum;
+    // 结果
+    __m128i result;
+
+// 取地址处16个方块的地雷掩码
+#define MINE_MASK_SSE2(address) _mm_cmpeq_epi8(_mm_and_si128(_mm_loadu_si128((const __m128i *)(address)), type_mask), mine)
+
+    for (row = row_begin; row < row_end; row++) {
+        p = blocks + (size_t)(row + 1) * stride + 1;
+        for (column = 0; column + 16 <= columns; column += 16) {
+            center = _mm_loadu_si128((const __m128i *)(p + column));
+            center_mine = _mm_cmpeq_epi8(_mm_and_si128(center, type_mask), mine);
+
+            // 上、中、下三行的水平和，再减去中心方块自身
+            sum = _mm_add_epi8(_mm_add_epi8(MINE_MASK_SSE2(p + column - stride - 1), MINE_MASK_SSE2(p + column - stride)), MINE_MASK_SSE2(p + column - stride + 1));
+            sum = _mm_add_epi8(sum, _mm_add_epi8(_mm_add_epi8(MINE_MASK_SSE2(p + column - 1), center_mine), MINE_MASK_SSE2(p + column + 1)));
+            sum = _mm_add_epi8(sum, _mm_add_epi8(_mm_add_epi8(MINE_MASK_SSE2(p + column + stride - 1), MINE_MASK_SSE2(p + column + stride)), MINE_MASK_SSE2(p + column + stride + 1)));
+            sum = _mm_sub_epi8(sum, center_mine);
+
+            // 非地雷方块：保留状态位，类型设为地雷数（0 - sum）；地雷方块保持不变
+            result = _mm_or_si128(_mm_and_si128(center, status_mask), _mm_sub_epi8(_mm_setzero_si128(), sum));
+            result = _mm_or_si128(_mm_and_si128(center_mine, center), _mm_andnot_si128(center_mine, result));
+            _mm_storeu_si128((__m128i *)(p + column), result);
+        }
+        CountRowScalar(p, stride, column, columns);
+    }
+
+#undef MINE_MASK_SSE2
+}
+
+/**
+ * AVX2内核，每次处理32个方块
+ *
+ * @param blocks            方块表指针
+ * @param stride            行跨度
+ * @param columns           列数
+ * @param row_begin         起始行下标
+ * @param row_end           结束行下标（不含）
+ */
+__attribute__((target("avx2")))
+static void CountNeighborMinesAvx2(Block *blocks, int stride, int columns, int row_begin, int row_end) {
+    // 行下标
+    int row;
+    // 列下标
+    int column;
+    // 行首方块指针
+    Block *p;
+    // 常量：类型掩码、地雷类型、状态掩码
+    const __m256i type_mask = _mm256_set1_epi8(BLOCK_TYPE_MASK);
+    const __m256i mine = _mm256_set1_epi8(BLOCK_TYPE_MINE);
+    const __m256i status_mask = _mm256_set1_epi8((char)~BLOCK_TYPE_MASK);
+    // 中心方块及其地雷掩码（地雷为0xFF，否则为0）
+    __m256i center, center_mine;
+    // 三行的水平和（每个地雷计为-1）
+    __m256i sum;
+    // 结果
+    __m256i result;
+
+// 取地址处32个方块的地雷掩码
+#define MINE_MASK_AVX2(address) _mm256_cmpeq_epi8(_mm256_and_si256(_mm256_loadu_si256((const __m256i *)(address)), type_mask), mine)
+
+    for (row = row_begin; row < row_end; row++) {
+        p = blocks + (size_t)(row + 1) * stride + 1;
+        for (column = 0; column + 32 <= columns; column += 32) {
+            center = _mm256_loadu_si256((const __m256i *)(p + column));
+            center_mine = _mm256_cmpeq_epi8(_mm256_and_si256(center, type_mask), mine);
+
+            // 上、中、下三行的水平和，再减去中心方块自身
+            sum = _mm256_add_epi8(_mm256_add_epi8(MINE_MASK_AVX2(p + column - stride - 1), MINE_MASK_AVX2(p + column - stride)), MINE_MASK_AVX2(p + column - stride + 1));
+            sum = _mm256_add_epi8(sum, _mm256_add_epi8(_mm256_add_epi8(MINE_MASK_AVX2(p + column - 1), center_mine), MINE_MASK_AVX2(p + column + 1)));
+            sum = _mm256_add_epi8(sum, _mm256_add_epi8(_mm256_add_epi8(MINE_MASK_AVX2(p + column + stride - 1), MINE_MASK_AVX2(p + column + stride)), MINE_MASK_AVX2(p + column + stride + 1)));
+            sum = _mm256_sub_epi8(sum, center_mine);
+
+            // 非地雷方块：保留状态位，类型设为地雷数（0 - sum）；地雷方块保持不变
+            result = _mm256_or_si256(_mm256_and_si256(center, status_mask), _mm256_sub_epi8(_mm256_setzero_si256(), sum));
+            result = _mm256_blendv_epi8(result, center, center_mine);
+            _mm256_storeu_si256((__m256i *)(p + column), result);
+        }
+        CountRowScalar(p, stride, column, columns);
+    }
+
+#undef MINE_MASK_AVX2
+}
+
+#endif
+
+/**
+ * 根据处理器支持情况选择内核
+ *
+ * @param name              内核名称指针，可为空
+ * @return                  内核函数
+ */
+static NeighborKernel SelectNeighborKernel(const char **name) {
+    // 内核名称
+    const char *kernel_name = "scalar";
+    // 内核函数
+    NeighborKernel kernel = CountNeighborMinesScalar;
+
+#ifdef NEIGHBOR_KERNEL_X86
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx2")) {
+        kernel_name = "avx2";
+        kernel = CountNeighborMinesAvx2;
+    } else if (__builtin_cpu_supports("sse2")) {
+        kernel_name = "sse2";
+        kernel = CountNeighborMinesSse2;
+    }
+#endif
+
+    if (name) {
+        *name = kernel_name;
+    }
+    return kernel;
+}
+
+/**
+ * 计算方块表中若干行方块的周围地雷数
+ *
+ * 非地雷方块的类型被设置为周围地雷数（BLOCK_TYPE_BLANK ~ BLOCK_TYPE_NUMBER_8），状态位保持不变
+ *
+ * @param blocks            方块表指针（含四周的哨兵方块）
+ * @param stride            行跨度
+ * @param columns           列数
+ * @param row_begin         起始行下标
+ * @param row_end           结束行下标（不含）
+ */
+void CountNeighborMines(Block *blocks, int stride, int columns, int row_begin, int row_end) {
+    SelectNeighborKernel(NULL)(blocks, stride, columns, row_begin, row_end);
+}
+
+/**
+ * 当前使用的内核名称
+ *
+ * @return                  内核名称
+ */
+const char * NeighborKernelName() {
+    // 内核名称
+    const char *name;
+
+    SelectNeighborKernel(&name);
+    return name;
+}
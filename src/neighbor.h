@@ -0,0 +1,25 @@
+/**
+ * ----------------------------------------------------------------------------
+ * [头文件] 周围地雷数
+ * ----------------------------------------------------------------------------
+ *
+ * 定义计算方块周围地雷数的内核函数原型
+ *
+ */
+
+
+#ifndef MINESWEEPING_NEIGHBOR_H
+#define MINESWEEPING_NEIGHBOR_H
+
+#include "game.h"
+
+/*
+ * 函数原型
+ */
+
+// 计算方块表中若干行方块的周围地雷数
+void CountNeighborMines(Block *blocks, int stride, int columns, int row_begin, int row_end);
+// 当前使用的内核名称
+const char * NeighborKernelName();
+
+#endif //MINESWEEPING_NEIGHBOR_H
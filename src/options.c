@@ -0,0 +1,266 @@
+/**
+ * ----------------------------------------------------------------------------
+ * [源文件] 命令行选项
+ * ----------------------------------------------------------------------------
+ *
+ * 定义解析命令行选项的各个函数
+ *
+ */
+
+
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+
+#include "options.h"
+#include "generator.h"
+
+
+/**
+ * 解析十进制整数
+ *
+ * @param text              文本
+ * @param min               最小值
+ * @param max               最大值
+ * @param value             整数指针
+ * @return                  是否为范围内的整数
+ */
+_Bool ParseInteger(const char *text, long long min, long long max, long long *value) {
+    // 解析结束的位置
+    char *end;
+
+    errno = 0;
+    *value = strtoll(text, &end, 10);
+
+    return errno == 0 && end != text && *end == '\0' && *value >= min && *value <= max;
+}
+
+/**
+ * 解析随机数种子
+ *
+ * @param text              文本
+ * @param seed              随机数种子指针
+ * @return                  是否为64位无符号整数
+ */
+_Bool ParseSeed(const char *text, uint64_t *seed) {
+    // 解析结束的位置
+    char *end;
+
+    errno = 0;
+    *seed = (uint64_t)strtoull(text, &end, 10);
+
+    return errno == 0 && end != text && *end == '\0' && text[0] != '-';
+}
+
+/**
+ * 解析难度
+ *
+ * @param text              文本：low、middle、high，或对应的编号1、2、3
+ * @param difficulty        难度指针
+ * @return                  是否为预设难度
+ */
+_Bool ParseDifficulty(const char *text, GameDifficulty *difficulty) {
+    if (strcmp(text, "low") == 0 || strcmp(text, "1") == 0) {
+        *difficulty = GAME_DIFFICULTY_LOW;
+    } else if (strcmp(text, "middle") == 0 || strcmp(text, "2") == 0) {
+        *difficulty = GAME_DIFFICULTY_MIDDLE;
+    } else if (strcmp(text, "high") == 0 || strcmp(text, "3") == 0) {
+        *difficulty = GAME_DIFFICULTY_HIGH;
+    } else {
+        return 0;
+    }
+
+    return 1;
+}
+
+/**
+ * 解析命令行选项
+ *
+ * 难度确定默认的行数、列数和地雷数，单独指定的行数、列数、地雷数优先。
+ * 只指定了行数、列数、地雷数中的一部分时，其余的取高级难度的值。
+ *
+ * @param options           命令行选项指针
+ * @param argc              参数个数
+ * @param argv              参数列表
+ * @return                  0继续运行，1已输出帮助信息，2参数有误
+ */
+int ParseOptions(Options *options, int argc, char *argv[]) {
+    // 参数下标
+    int i;
+    // 选项名
+    const char *name;
+    // 选项值
+    const char *value;
+    // 解析出的整数
+    long long number;
+    // 难度
+    GameDifficulty difficulty = GAME_DIFFICULTY_HIGH;
+    // 单独指定的行数、列数、地雷数，未指定时为-1
+    long long rows = -1, columns = -1, mines = -1;
+    // 选项值是否有效
+    _Bool is_valid;
+
+    options->has_size = 0;
+    options->seed = 0;
+    options->threads = 1;
+    options->is_lazy = 0;
+    options->mode = OUTPUT_MODE_INTERACTIVE;
+    options->batch_file = NULL;
+    options->report_interval = 0;
+    options->is_board_dumped = 0;
+
+    for (i = 1; i < argc; i++) {
+        name = argv[i];
+
+        /*
+         * 不带值的选项
+         */
+
+        if (strcmp(name, "-h") == 0 || strcmp(name, "--help") == 0) {
+            PrintUsage(stdout, argv[0]);
+            return 1;
+        } else if (strcmp(name, "--lazy") == 0) {
+            options->is_lazy = 1;
+            continue;
+        } else if (strcmp(name, "--dump-board") == 0) {
+            options->is_board_dumped = 1;
+            continue;
+        } else if (strcmp(name, "--quiet") == 0) {
+            options->mode = OUTPUT_MODE_QUIET;
+            continue;
+        } else if (strcmp(name, "--batch") == 0) {
+            // 文件名可省略
+            options->mode = OUTPUT_MODE_BATCH;
+            if (i + 1 < argc && (argv[i + 1][0] != '-' || strcmp(argv[i + 1], "-") == 0)) {
+                options->batch_file = argv[++i];
+            }
+            continue;
+        }
+
+        /*
+         * 带值的选项
+         */
+
+        if (i + 1 >= argc) {
+            fprintf(stderr, "选项 %s 无效或缺少值！\n", name);
+            return 2;
+        }
+        value = argv[++i];
+
+        if (strcmp(name, "-d") == 0 || strcmp(name, "--difficulty") == 0) {
+            is_valid = ParseDifficulty(value, &difficulty);
+            options->has_size = 1;
+        } else if (strcmp(name, "-r") == 0 || strcmp(name, "--rows") == 0) {
+            is_valid = ParseInteger(value, 2, MAX_BLOCK_TABLE_SIZE, &rows);
+            options->has_size = 1;
+        } else if (strcmp(name, "-c") == 0 || strcmp(name, "--columns") == 0) {
+            is_valid = ParseInteger(value, 2, MAX_BLOCK_TABLE_SIZE, &columns);
+            options->has_size = 1;
+        } else if (strcmp(name, "-m") == 0 || strcmp(name, "--mines") == 0) {
+            is_valid = ParseInteger(value, 1, MAX_BLOCK_TABLE_SIZE, &mines);
+            options->has_size = 1;
+        } else if (strcmp(name, "-s") == 0 || strcmp(name, "--seed") == 0) {
+            is_valid = ParseSeed(value, &options->seed);
+        } else if (strcmp(name, "-t") == 0 || strcmp(name, "--threads") == 0) {
+            is_valid = ParseInteger(value, 0, 1024, &number);
+            // 0表示使用全部处理器核心
+            options->threads = is_valid && number == 0 ? NumberOfProcessors() : (int)number;
+        } else if (strcmp(name, "--mode") == 0) {
+            is_valid = 1;
+            if (strcmp(value, "interactive") == 0) {
+                options->mode = OUTPUT_MODE_INTERACTIVE;
+            } else if (strcmp(value, "batch") == 0) {
+                options->mode = OUTPUT_MODE_BATCH;
+            } else if (strcmp(value, "quiet") == 0) {
+                options->mode = OUTPUT_MODE_QUIET;
+            } else {
+                is_valid = 0;
+            }
+        } else if (strcmp(name, "--input") == 0) {
+            is_valid = 1;
+            options->batch_file = value;
+        } else if (strcmp(name, "--report") == 0) {
+            is_valid = ParseInteger(value, 0, LLONG_MAX, &options->report_interval);
+        } else {
+            fprintf(stderr, "未知选项：%s\n", name);
+            PrintUsage(stderr, argv[0]);
+            return 2;
+        }
+
+        if (! is_valid) {
+            fprintf(stderr, "选项 %s 的值无效：%s\n", name, value);
+            return 2;
+        }
+    }
+
+    // 确定地图大小
+    GetDifficultySize(difficulty, &options->rows, &options->columns, &options->mines);
+    rows = rows >= 0 ? rows : options->rows;
+    columns = columns >= 0 ? columns : options->columns;
+    mines = mines >= 0 ? mines : options->mines;
+    if (options->has_size && ! IsValidGameSize(rows, columns, mines)) {
+        fprintf(stderr, "地图大小无效：%lld行 x %lld列，%lld个地雷！\n", rows, columns, mines);
+        return 2;
+    }
+    options->rows = (int)rows;
+    options->columns = (int)columns;
+    options->mines = (int)mines;
+
+    return 0;
+}
+
+/**
+ * 输出用法说明
+ *
+ * @param file              输出文件
+ * @param program           程序名
+ */
+void PrintUsage(FILE *file, const char *program) {
+    fprintf(file, "用法：%s [选项]\n", program);
+    fprintf(file, "\n");
+    fprintf(file, "地图：指定任意一项后跳过开始界面\n");
+    fprintf(file, "  -d, --difficulty 难度    low、middle、high，或编号1、2、3\n");
+    fprintf(file, "  -r, --rows 行数\n");
+    fprintf(file, "  -c, --columns 列数\n");
+    fprintf(file, "  -m, --mines 地雷数       只指定一部分时其余取难度的值（默认高级）\n");
+    fprintf(file, "  -s, --seed 种子          随机数种子，为0时自动生成\n");
+    fprintf(file, "  -t, --threads 线程数     多线程散布地雷，为0时使用全部处理器核心，不影响生成的地图\n");
+    fprintf(file, "      --lazy               翻开方块时才计算数值\n");
+    fprintf(file, "\n");
+    fprintf(file, "输出：\n");
+    fprintf(file, "      --mode 模式          interactive（默认）、batch或quiet\n");
+    fprintf(file, "      --batch [文件]       批处理模式，从文件或标准输入读取命令\n");
+    fprintf(file, "      --quiet              安静模式，同批处理模式，但只输出游戏结果\n");
+    fprintf(file, "      --input 文件         批处理输入文件，默认为标准输入\n");
+    fprintf(file, "      --report 命令数      批处理模式下每读取多少条命令输出一次状态\n");
+    fprintf(file, "      --dump-board         批处理模式结束时输出整个地图\n");
+    fprintf(file, "  -h, --help               显示本说明\n");
+}
+
+/**
+ * 按命令行选项开始一局新游戏
+ *
+ * 地图大小由调用者给出，延迟计算数值、线程数等选项取自命令行选项。
+ * 地雷总是按行带散布，同一种子在任何线程数下生成同样的地图
+ *
+ * @param game              游戏指针
+ * @param options           命令行选项指针
+ * @param rows              行数
+ * @param columns           列数
+ * @param mines             地雷数
+ * @param seed              随机数种子，为0时自动生成
+ * @return                  地图是否创建成功，内存不足时返回0
+ */
+_Bool StartConfiguredGame(Game *game, const Options *options, int rows, int columns, int mines, uint64_t seed) {
+    if (! ResetGame(game, rows, columns, mines)) {
+        return 0;
+    }
+
+    game->map->is_lazy = options->is_lazy;
+    // 无论线程数多少都按行带散布，同一种子生成的地图与线程数无关
+    if (! ParallelDistributeMines(game->map, seed, options->threads < 1 ? 1 : options->threads)) {
+        return 0;
+    }
+
+    return 1;
+}
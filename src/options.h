@@ -0,0 +1,76 @@
+/**
+ * ----------------------------------------------------------------------------
+ * [头文件] 命令行选项
+ * ----------------------------------------------------------------------------
+ *
+ * 定义命令行选项的数据结构和函数原型
+ *
+ */
+
+
+#ifndef MINESWEEPING_OPTIONS_H
+#define MINESWEEPING_OPTIONS_H
+
+#include <stdio.h>
+#include <stdint.h>
+
+#include "game.h"
+
+/*
+ * 数据结构定义
+ */
+
+// 枚举：输出模式
+typedef enum {
+    // 交互模式：显示终端界面
+    OUTPUT_MODE_INTERACTIVE,
+    // 批处理模式：从输入流读取命令，输出状态
+    OUTPUT_MODE_BATCH,
+    // 安静模式：从输入流读取命令，只输出游戏结果
+    OUTPUT_MODE_QUIET,
+} OutputMode;
+
+// 结构体：命令行选项
+typedef struct {
+    // 是否已指定地图大小（难度或行数、列数、地雷数），指定后不再显示开始界面
+    _Bool has_size;
+    // 行数
+    int rows;
+    // 列数
+    int columns;
+    // 地雷数
+    int mines;
+    // 随机数种子，为0时自动生成
+    uint64_t seed;
+    // 散布地雷使用的线程数，不影响生成的地图
+    int threads;
+    // 是否延迟计算数值
+    _Bool is_lazy;
+    // 输出模式
+    OutputMode mode;
+    // 批处理输入文件名，为空时读取标准输入
+    const char *batch_file;
+    // 批处理状态输出间隔，为0时只在结束时输出
+    long long report_interval;
+    // 批处理结束时是否输出整个地图
+    _Bool is_board_dumped;
+} Options;
+
+/*
+ * 函数原型
+ */
+
+// 解析十进制整数
+_Bool ParseInteger(const char *text, long long min, long long max, long long *value);
+// 解析随机数种子
+_Bool ParseSeed(const char *text, uint64_t *seed);
+// 解析难度
+_Bool ParseDifficulty(const char *text, GameDifficulty *difficulty);
+// 解析命令行选项
+int ParseOptions(Options *options, int argc, char *argv[]);
+// 输出用法说明
+void PrintUsage(FILE *file, const char *program);
+// 按命令行选项开始一局新游戏
+_Bool StartConfiguredGame(Game *game, const Options *options, int rows, int columns, int mines, uint64_t seed);
+
+#endif //MINESWEEPING_OPTIONS_H
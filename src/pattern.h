@@ -0,0 +1,74 @@
+/**
+ * ----------------------------------------------------------------------------
+ * [头文件] 局部模式
+ * ----------------------------------------------------------------------------
+ *
+ * 定义局部模式查找表的键和表项格式
+ *
+ * 一个数字周围3 x 3个方块的约束只取决于剩余的地雷数和其中未翻开的方块；
+ * 两个相邻数字（另一个数字在以当前数字为中心的5 x 5范围内）的推理结果则只取决于
+ * 两者剩余的地雷数，以及未翻开方块分成的三组（只属于A、共有、只属于B）各有几个方块。
+ * 组内的方块地位相同，按组给出的结论是精确的，因此只用这5个数作键，
+ * 而不必为窗口中每个方块的状态建表。表由构建时运行的生成器枚举得到。
+ *
+ */
+
+
+#ifndef MINESWEEPING_PATTERN_H
+#define MINESWEEPING_PATTERN_H
+
+#include <stdint.h>
+
+/*
+ * 宏定义
+ */
+
+// 键中每个数的取值个数：剩余地雷数和组内方块数都在0 ~ 8之间
+#define PATTERN_RADIX         9
+// 查找表的表项数
+#define PATTERN_TABLE_SIZE    (PATTERN_RADIX * PATTERN_RADIX * PATTERN_RADIX * PATTERN_RADIX * PATTERN_RADIX)
+
+// 由A剩余的地雷数、只属于A的方块数、共有的方块数、B剩余的地雷数、只属于B的方块数组成键，
+// 单个数字的约束是B为空的特例
+#define PATTERN_KEY(remaining_a, only_a, shared, remaining_b, only_b) \
+    (((((remaining_a) * PATTERN_RADIX + (only_a)) * PATTERN_RADIX + (shared)) * PATTERN_RADIX \
+      + (remaining_b)) * PATTERN_RADIX + (only_b))
+
+// 表项中每组的结论占2位
+#define PATTERN_GROUP_BITS    2
+// 组的结论：不确定
+#define PATTERN_UNKNOWN       0
+// 组的结论：全部安全
+#define PATTERN_SAFE          1
+// 组的结论：全部是地雷
+#define PATTERN_MINE          2
+// 表项的标记位：没有满足约束的地雷分布（数字与旗标矛盾）
+#define PATTERN_INCONSISTENT  0x40
+
+// 表项中一组的结论
+#define PATTERN_RESULT_OF(entry, group) (((entry) >> ((group) * PATTERN_GROUP_BITS)) & 3)
+
+/*
+ * 数据结构定义
+ */
+
+// 枚举：未翻开方块的组
+typedef enum {
+    // 只属于A
+    PATTERN_GROUP_ONLY_A,
+    // 共有
+    PATTERN_GROUP_SHARED,
+    // 只属于B
+    PATTERN_GROUP_ONLY_B,
+    // 组数
+    NUMBER_OF_PATTERN_GROUPS,
+} PatternGroup;
+
+/*
+ * 全局变量
+ */
+
+// 局部模式查找表，由构建时运行的生成器生成
+extern const uint8_t PATTERN_TABLE[PATTERN_TABLE_SIZE];
+
+#endif //MINESWEEPING_PATTERN_H
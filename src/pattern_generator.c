@@ -0,0 +1,145 @@
+/**
+ * ----------------------------------------------------------------------------
+ * [源文件] 局部模式查找表生成器
+ * ----------------------------------------------------------------------------
+ *
+ * 定义构建时生成局部模式查找表的主函数
+ *
+ * 对每个键枚举三组中各有几个地雷的全部组合，保留同时满足A、B两个约束的组合：
+ * 某组在所有组合中都没有地雷则全部安全，都全是地雷则全部是地雷。
+ * 组内各方块地位相同，只枚举地雷个数即可，不必枚举具体的分布。
+ *
+ */
+
+
+#include <stdio.h>
+
+#include "pattern.h"
+
+
+/**
+ * 计算一个键的表项
+ *
+ * @param remaining_a       A剩余的地雷数
+ * @param only_a            只属于A的方块数
+ * @param shared            共有的方块数
+ * @param remaining_b       B剩余的地雷数
+ * @param only_b            只属于B的方块数
+ * @return                  表项
+ */
+static unsigned GeneratePatternEntry(int remaining_a, int only_a, int shared, int remaining_b, int only_b) {
+    // 各组的方块数
+    int sizes[NUMBER_OF_PATTERN_GROUPS] = {only_a, shared, only_b};
+    // 各组在满足约束的组合中是否出现过安全的方块、是否出现过地雷
+    _Bool has_safe[NUMBER_OF_PATTERN_GROUPS] = {0}, has_mine[NUMBER_OF_PATTERN_GROUPS] = {0};
+    // 是否有满足约束的组合
+    _Bool is_consistent = 0;
+    // 各组的地雷数
+    int mines[NUMBER_OF_PATTERN_GROUPS];
+    // 组序号
+    int group;
+    // 表项
+    unsigned entry = 0;
+
+    // 超出一个数字周围8个方块的键不会出现
+    if (only_a + shared > 8 || shared + only_b > 8) {
+        return PATTERN_INCONSISTENT;
+    }
+
+    for (mines[PATTERN_GROUP_SHARED] = 0; mines[PATTERN_GROUP_SHARED] <= shared; mines[PATTERN_GROUP_SHARED]++) {
+        mines[PATTERN_GROUP_ONLY_A] = remaining_a - mines[PATTERN_GROUP_SHARED];
+        mines[PATTERN_GROUP_ONLY_B] = remaining_b - mines[PATTERN_GROUP_SHARED];
+        if (mines[PATTERN_GROUP_ONLY_A] < 0 || mines[PATTERN_GROUP_ONLY_A] > only_a
+            || mines[PATTERN_GROUP_ONLY_B] < 0 || mines[PATTERN_GROUP_ONLY_B] > only_b) {
+            continue;
+        }
+
+        is_consistent = 1;
+        for (group = 0; group < NUMBER_OF_PATTERN_GROUPS; group++) {
+            has_safe[group] |= mines[group] < sizes[group];
+            has_mine[group] |= mines[group] > 0;
+        }
+    }
+
+    if (! is_consistent) {
+        return PATTERN_INCONSISTENT;
+    }
+
+    // 空组不给出结论
+    for (group = 0; group < NUMBER_OF_PATTERN_GROUPS; group++) {
+        if (sizes[group] > 0 && ! has_mine[group]) {
+            entry |= PATTERN_SAFE << (group * PATTERN_GROUP_BITS);
+        } else if (sizes[group] > 0 && ! has_safe[group]) {
+            entry |= PATTERN_MINE << (group * PATTERN_GROUP_BITS);
+        }
+    }
+
+    return entry;
+}
+
+/**
+ * 主函数
+ *
+ * @param argc              参数个数
+ * @param argv              参数列表，第1个参数为输出的源文件路径
+ * @return                  程序运行状态码
+ */
+int main(int argc, char *argv[]) {
+    // 输出文件
+    FILE *file;
+    // 键的各个数
+    int remaining_a, only_a, shared, remaining_b, only_b;
+    // 已输出的表项数
+    int count = 0;
+
+    if (argc != 2) {
+        fprintf(stderr, "用法：%s <输出文件>\n", argv[0]);
+        return 2;
+    }
+
+    file = fopen(argv[1], "w");
+    if (! file) {
+        perror(argv[1]);
+        return 1;
+    }
+
+    fprintf(file, "/**\n"
+                  " * ----------------------------------------------------------------------------\n"
+                  " * [源文件] 局部模式查找表\n"
+                  " * ----------------------------------------------------------------------------\n"
+                  " *\n"
+                  " * 由局部模式查找表生成器在构建时生成，请勿手工修改\n"
+                  " *\n"
+                  " */\n"
+                  "\n"
+                  "\n"
+                  "#include \"pattern.h\"\n"
+                  "\n"
+                  "\n"
+                  "const uint8_t PATTERN_TABLE[PATTERN_TABLE_SIZE] = {\n");
+
+    // 按键的顺序逐项输出
+    for (remaining_a = 0; remaining_a < PATTERN_RADIX; remaining_a++) {
+        for (only_a = 0; only_a < PATTERN_RADIX; only_a++) {
+            for (shared = 0; shared < PATTERN_RADIX; shared++) {
+                for (remaining_b = 0; remaining_b < PATTERN_RADIX; remaining_b++) {
+                    for (only_b = 0; only_b < PATTERN_RADIX; only_b++) {
+                        fprintf(file, "%s0x%02X,%s", count % 16 == 0 ? "    " : "",
+                                GeneratePatternEntry(remaining_a, only_a, shared, remaining_b, only_b),
+                                count % 16 == 15 ? "\n" : " ");
+                        count++;
+                    }
+                }
+            }
+        }
+    }
+
+    fprintf(file, "%s};\n", count % 16 == 0 ? "" : "\n");
+
+    if (fclose(file) != 0) {
+        perror(argv[1]);
+        return 1;
+    }
+
+    return 0;
+}
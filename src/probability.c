@@ -0,0 +1,827 @@
+/**
+ * ----------------------------------------------------------------------------
+ * [源文件] 地雷概率
+ * ----------------------------------------------------------------------------
+ *
+ * 定义精确计算每个未翻开方块是地雷的概率的各个函数
+ *
+ * 每个已翻开的数字给出一条约束：周围未翻开的方块中恰好有（数字 - 周围已知的地雷数）个地雷。
+ * 不共享任何约束的两组前沿方块互不影响，只通过地雷总数相关联，
+ * 因此按连通分量分别枚举，记录每个分量含k个地雷的解数和各方块是地雷的次数，
+ * 再把各分量的解数分布卷积起来，乘以其余地雷放在内部方块中的组合数加权。
+ * 枚举的代价是各分量解数之和，而不是整个前沿解数之积。
+ *
+ */
+
+
+// 使用可重入的lgamma_r
+#define _DEFAULT_SOURCE
+
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+
+#include "probability.h"
+
+
+/**
+ * 按需扩大缓冲区
+ *
+ * 容量不足时扩容为所需容量和原容量2倍中的较大者，内存不足时保留原缓冲区
+ *
+ * @param buffer            缓冲区指针的指针
+ * @param capacity          容量指针（元素数）
+ * @param required          所需容量（元素数）
+ * @param size              每个元素的字节数
+ * @return                  容量是否足够
+ */
+static _Bool Reserve(void **buffer, size_t *capacity, size_t required, size_t size) {
+    // 新容量
+    size_t new_capacity;
+    // 新的缓冲区
+    void *new_buffer;
+
+    if (required <= *capacity) {
+        return 1;
+    }
+
+    new_capacity = *capacity * 2 > required ? *capacity * 2 : required;
+    new_buffer = realloc(*buffer, size * new_capacity);
+    if (! new_buffer) {
+        return 0;
+    }
+    *buffer = new_buffer;
+    *capacity = new_capacity;
+
+    return 1;
+}
+
+/**
+ * 重新分配一个缓冲区
+ *
+ * @param buffer            缓冲区指针的指针
+ * @param count             元素数
+ * @param size              每个元素的字节数
+ * @return                  是否分配成功，失败时保留原缓冲区
+ */
+static _Bool Resize(void **buffer, size_t count, size_t size) {
+    // 新的缓冲区
+    void *new_buffer = realloc(*buffer, size * count);
+
+    if (! new_buffer) {
+        return 0;
+    }
+    *buffer = new_buffer;
+
+    return 1;
+}
+
+/**
+ * 按需扩大前沿方块缓冲区
+ *
+ * 各缓冲区逐个重新分配，只有全部成功后才更新容量，部分成功时下次会重新分配全部缓冲区
+ *
+ * @param engine            概率计算器指针
+ * @param required          所需容量（方块数）
+ * @return                  容量是否足够
+ */
+static _Bool ReserveCells(ProbabilityEngine *engine, size_t required) {
+    // 新容量
+    size_t capacity;
+
+    if (required <= engine->cell_capacity) {
+        return 1;
+    }
+
+    capacity = engine->cell_capacity * 2 > required ? engine->cell_capacity * 2 : required;
+    if (! Resize((void **)&engine->cells, capacity, sizeof(int))
+        || ! Resize((void **)&engine->cell_constraints, capacity * 8, sizeof(int))
+        || ! Resize((void **)&engine->cell_constraint_counts, capacity, sizeof(int))
+        || ! Resize((void **)&engine->order, capacity, sizeof(int))
+        || ! Resize((void **)&engine->assigned, capacity, sizeof(signed char))
+        || ! Resize((void **)&engine->next_values, capacity, sizeof(signed char))
+        || ! Resize((void **)&engine->component_starts, capacity + 1, sizeof(int))) {
+        return 0;
+    }
+    engine->cell_capacity = capacity;
+
+    return 1;
+}
+
+/**
+ * 按需扩大约束缓冲区
+ *
+ * @param engine            概率计算器指针
+ * @param required          所需容量（约束数）
+ * @return                  容量是否足够
+ */
+static _Bool ReserveConstraints(ProbabilityEngine *engine, size_t required) {
+    // 新容量
+    size_t capacity;
+
+    if (required <= engine->constraint_capacity) {
+        return 1;
+    }
+
+    capacity = engine->constraint_capacity * 2 > required ? engine->constraint_capacity * 2 : required;
+    if (! Resize((void **)&engine->constraint_cells, capacity * 8, sizeof(int))
+        || ! Resize((void **)&engine->constraint_counts, capacity, sizeof(int))
+        || ! Resize((void **)&engine->constraint_remaining, capacity, sizeof(int))
+        || ! Resize((void **)&engine->constraint_unassigned, capacity, sizeof(int))) {
+        return 0;
+    }
+    engine->constraint_capacity = capacity;
+
+    return 1;
+}
+
+/**
+ * 创建概率计算器
+ *
+ * @param map               地图指针，计算器销毁前地图大小不能改变
+ * @return                  分配的内存地址
+ */
+ProbabilityEngine * CreateProbabilityEngine(Map *map) {
+    // 概率计算器指针
+    ProbabilityEngine *engine;
+    // 方块表的方块数
+    size_t size = (size_t)(map->number_of_rows + 2) * (size_t)map->stride;
+    // 方块下标
+    size_t index;
+
+    engine = (ProbabilityEngine *)calloc(1, sizeof(ProbabilityEngine));
+    if (! engine) {
+        return NULL;
+    }
+
+    engine->map = map;
+    engine->node_budget = PROBABILITY_NODE_BUDGET;
+    engine->probabilities = (double *)malloc(sizeof(double) * size);
+    engine->block_cells = (int *)malloc(sizeof(int) * size);
+    // 没有前沿方块时也需要分量起始位置等缓冲区
+    if (! engine->probabilities || ! engine->block_cells || ! ReserveCells(engine, 64)) {
+        DestroyProbabilityEngine(&engine);
+        return NULL;
+    }
+
+    for (index = 0; index < size; index++) {
+        engine->probabilities[index] = -1;
+        engine->block_cells[index] = -1;
+    }
+
+    return engine;
+}
+
+/**
+ * 销毁概率计算器
+ *
+ * @param engine            概率计算器指针的指针
+ */
+void DestroyProbabilityEngine(ProbabilityEngine **engine) {
+    free((*engine)->probabilities);
+    free((*engine)->block_cells);
+    free((*engine)->cells);
+    free((*engine)->cell_constraints);
+    free((*engine)->cell_constraint_counts);
+    free((*engine)->constraint_cells);
+    free((*engine)->constraint_counts);
+    free((*engine)->constraint_remaining);
+    free((*engine)->constraint_unassigned);
+    free((*engine)->order);
+    free((*engine)->assigned);
+    free((*engine)->next_values);
+    free((*engine)->component_starts);
+    free((*engine)->weights);
+    free((*engine)->counts);
+    free((*engine)->convolutions);
+    free(*engine);
+    *engine = NULL;
+}
+
+/**
+ * 方块是否是调用者给出的已知地雷
+ *
+ * @param engine            概率计算器指针
+ * @param index             方块在方块表中的下标
+ * @return                  是否是未翻开的已知地雷
+ */
+static _Bool IsKnownMine(ProbabilityEngine *engine, int index) {
+    return engine->known_mines && engine->known_mines[index]
+           && BLOCK_STATUS_OF(engine->map->blocks[index]) != BLOCK_STATUS_VISIBLE;
+}
+
+/**
+ * 收集前沿方块和约束
+ *
+ * 每个周围有未翻开方块的已翻开数字（含空白）成为一条约束，
+ * 这些未翻开方块依次编号为前沿方块，旗标和疑问标当作未翻开处理，已知的地雷从约束中减去
+ *
+ * @param engine            概率计算器指针
+ * @param known             已知地雷数指针，用于计算剩余的地雷数
+ * @return                  是否成功：内存不足或数字与已知地雷矛盾时失败
+ */
+static _Bool CollectFrontier(ProbabilityEngine *engine, long long *known) {
+    // 地图指针
+    Map *map = engine->map;
+    // 行下标、列下标（方块表中，含哨兵行、列）
+    int row, column;
+    // 方块下标、邻居下标
+    int index, neighbor;
+    // 邻居序号
+    int k;
+    // 方块
+    Block block;
+    // 约束编号、前沿编号
+    int constraint, cell;
+    // 前沿方块数、约束数
+    int cells = 0, constraints = 0;
+
+    *known = 0;
+    for (row = 1; row <= map->number_of_rows; row++) {
+        for (column = 1; column <= map->number_of_columns; column++) {
+            index = row * map->stride + column;
+            block = map->blocks[index];
+            if (IsKnownMine(engine, index)) {
+                (*known)++;
+            }
+            if (BLOCK_STATUS_OF(block) != BLOCK_STATUS_VISIBLE || BLOCK_TYPE_OF(block) == BLOCK_TYPE_MINE) {
+                continue;
+            }
+
+            if (! ReserveConstraints(engine, (size_t)constraints + 1) || ! ReserveCells(engine, (size_t)cells + 8)) {
+                engine->number_of_frontier_blocks = cells;
+                return 0;
+            }
+
+            constraint = constraints;
+            engine->constraint_counts[constraint] = 0;
+            engine->constraint_remaining[constraint] = BLOCK_TYPE_OF(block);
+            for (k = 0; k < 8; k++) {
+                neighbor = index + map->neighbor_offsets[k];
+                if (IsKnownMine(engine, neighbor)) {
+                    engine->constraint_remaining[constraint]--;
+                } else if (BLOCK_STATUS_OF(map->blocks[neighbor]) != BLOCK_STATUS_VISIBLE) {
+                    cell = engine->block_cells[neighbor];
+                    if (cell < 0) {
+                        cell = cells++;
+                        engine->block_cells[neighbor] = cell;
+                        engine->cells[cell] = neighbor;
+                        engine->cell_constraint_counts[cell] = 0;
+                    }
+                    engine->cell_constraints[cell * 8 + engine->cell_constraint_counts[cell]++] = constraint;
+                    engine->constraint_cells[constraint * 8 + engine->constraint_counts[constraint]++] = cell;
+                }
+            }
+
+            // 周围全部翻开的数字不构成约束
+            if (engine->constraint_counts[constraint] == 0) {
+                if (engine->constraint_remaining[constraint] != 0) {
+                    engine->number_of_frontier_blocks = cells;
+                    return 0;
+                }
+                continue;
+            }
+            if (engine->constraint_remaining[constraint] < 0
+                || engine->constraint_remaining[constraint] > engine->constraint_counts[constraint]) {
+                engine->number_of_frontier_blocks = cells;
+                return 0;
+            }
+            engine->constraint_unassigned[constraint] = engine->constraint_counts[constraint];
+            constraints++;
+        }
+    }
+
+    engine->number_of_frontier_blocks = cells;
+
+    return 1;
+}
+
+/**
+ * 按连通分量排列前沿方块
+ *
+ * 分量内按广度优先顺序排列，使枚举时约束尽早被全部赋值，尽早剪枝
+ *
+ * @param engine            概率计算器指针
+ */
+static void FindComponents(ProbabilityEngine *engine) {
+    // 前沿方块数
+    int cells = engine->number_of_frontier_blocks;
+    // 起点、队首、队尾
+    int start, head, tail = 0;
+    // 前沿编号、邻居前沿编号
+    int cell, other;
+    // 约束序号、方块序号
+    int i, j;
+    // 约束编号
+    int constraint;
+
+    // 借用赋值数组标记已入队的方块
+    memset(engine->assigned, 0, (size_t)cells);
+
+    engine->number_of_components = 0;
+    engine->largest_component = 0;
+    for (start = 0; start < cells; start++) {
+        if (engine->assigned[start]) {
+            continue;
+        }
+
+        engine->component_starts[engine->number_of_components++] = tail;
+        head = tail;
+        engine->order[tail++] = start;
+        engine->assigned[start] = 1;
+        while (head < tail) {
+            cell = engine->order[head++];
+            for (i = 0; i < engine->cell_constraint_counts[cell]; i++) {
+                constraint = engine->cell_constraints[cell * 8 + i];
+                for (j = 0; j < engine->constraint_counts[constraint]; j++) {
+                    other = engine->constraint_cells[constraint * 8 + j];
+                    if (! engine->assigned[other]) {
+                        engine->assigned[other] = 1;
+                        engine->order[tail++] = other;
+                    }
+                }
+            }
+        }
+
+        if (tail - engine->component_starts[engine->number_of_components - 1] > engine->largest_component) {
+            engine->largest_component = tail - engine->component_starts[engine->number_of_components - 1];
+        }
+    }
+    engine->component_starts[engine->number_of_components] = tail;
+
+    memset(engine->assigned, -1, (size_t)cells);
+}
+
+/**
+ * 给一个前沿方块赋值
+ *
+ * 赋值后所在的每条约束剩余的地雷数须不小于0，且不多于尚未赋值的方块数，否则不赋值
+ *
+ * @param engine            概率计算器指针
+ * @param cell              前沿编号
+ * @param value             1为地雷，0为安全
+ * @return                  是否赋值成功
+ */
+static _Bool Assign(ProbabilityEngine *engine, int cell, int value) {
+    // 约束序号
+    int i;
+    // 约束编号
+    int constraint;
+
+    for (i = 0; i < engine->cell_constraint_counts[cell]; i++) {
+        constraint = engine->cell_constraints[cell * 8 + i];
+        if (engine->constraint_remaining[constraint] < value
+            || engine->constraint_remaining[constraint] - value > engine->constraint_unassigned[constraint] - 1) {
+            return 0;
+        }
+    }
+
+    for (i = 0; i < engine->cell_constraint_counts[cell]; i++) {
+        constraint = engine->cell_constraints[cell * 8 + i];
+        engine->constraint_remaining[constraint] -= value;
+        engine->constraint_unassigned[constraint]--;
+    }
+    engine->assigned[cell] = (signed char)value;
+
+    return 1;
+}
+
+/**
+ * 撤销一个前沿方块的赋值
+ *
+ * @param engine            概率计算器指针
+ * @param cell              前沿编号
+ */
+static void Unassign(ProbabilityEngine *engine, int cell) {
+    // 约束序号
+    int i;
+    // 约束编号
+    int constraint;
+
+    for (i = 0; i < engine->cell_constraint_counts[cell]; i++) {
+        constraint = engine->cell_constraints[cell * 8 + i];
+        engine->constraint_remaining[constraint] += engine->assigned[cell];
+        engine->constraint_unassigned[constraint]++;
+    }
+    engine->assigned[cell] = -1;
+}
+
+/**
+ * 枚举一个连通分量的全部解
+ *
+ * 深度优先逐个方块尝试安全和地雷，违反约束或地雷总数不够时剪枝。
+ * 全部方块赋值后分量内的约束都已满足，记入该分量含k个地雷的解数和各方块是地雷的次数。
+ *
+ * @param engine            概率计算器指针
+ * @param component         分量编号
+ * @param weights           该分量的解数，（方块数 + 1）个元素
+ * @param counts            该分量各方块是地雷的次数，（方块数 + 1） x 方块数个元素
+ * @param mines             剩余的地雷数
+ * @return                  是否在节点预算内完成
+ */
+static _Bool EnumerateComponent(ProbabilityEngine *engine, int component, double *weights, double *counts,
+                                long long mines) {
+    // 分量在排列中的起止位置
+    int start = engine->component_starts[component], end = engine->component_starts[component + 1];
+    // 分量的方块数
+    int size = end - start;
+    // 当前层
+    int level = start;
+    // 当前方块的前沿编号
+    int cell;
+    // 已赋值的地雷数
+    int assigned_mines = 0;
+    // 排列中的位置
+    int i;
+
+    memset(weights, 0, sizeof(double) * (size_t)(size + 1));
+    memset(counts, 0, sizeof(double) * (size_t)(size + 1) * (size_t)size);
+
+    engine->next_values[level] = 0;
+    while (level >= start) {
+        if (level == end) {
+            weights[assigned_mines] += 1;
+            for (i = start; i < end; i++) {
+                counts[(size_t)assigned_mines * size + (i - start)] += engine->assigned[engine->order[i]];
+            }
+            level--;
+            continue;
+        }
+
+        cell = engine->order[level];
+        if (engine->assigned[cell] >= 0) {
+            assigned_mines -= engine->assigned[cell];
+            Unassign(engine, cell);
+        }
+
+        while (engine->next_values[level] <= 1
+               && (assigned_mines + engine->next_values[level] > mines
+                   || ! Assign(engine, cell, engine->next_values[level]))) {
+            engine->next_values[level]++;
+        }
+        if (engine->next_values[level] > 1) {
+            level--;
+            continue;
+        }
+
+        assigned_mines += engine->next_values[level]++;
+        if (++level < end) {
+            engine->next_values[level] = 0;
+        }
+        if (++engine->number_of_nodes > engine->node_budget) {
+            // 撤销全部赋值，使约束恢复原状
+            for (i = start; i < end; i++) {
+                if (engine->assigned[engine->order[i]] >= 0) {
+                    Unassign(engine, engine->order[i]);
+                }
+            }
+            return 0;
+        }
+    }
+
+    return 1;
+}
+
+/**
+ * 将两个解数分布卷积
+ *
+ * 结果超过最大长度的部分地雷数超过剩余的地雷数，直接截去
+ *
+ * @param a                 第一个分布
+ * @param a_length          第一个分布的长度
+ * @param b                 第二个分布
+ * @param b_length          第二个分布的长度
+ * @param result            结果，不能与输入重叠
+ * @param max_length        结果的最大长度
+ * @return                  结果的长度
+ */
+static int Convolve(const double *a, int a_length, const double *b, int b_length, double *result, int max_length) {
+    // 结果的长度
+    int length = a_length + b_length - 1 < max_length ? a_length + b_length - 1 : max_length;
+    // 下标
+    int i, j;
+
+    memset(result, 0, sizeof(double) * (size_t)length);
+    for (i = 0; i < a_length && i < length; i++) {
+        if (a[i] == 0) {
+            continue;
+        }
+        for (j = 0; j < b_length && i + j < length; j++) {
+            result[i + j] += a[i] * b[j];
+        }
+    }
+
+    return length;
+}
+
+/**
+ * 合并各分量的枚举结果，计算每个方块是地雷的概率
+ *
+ * 前沿共有F个地雷时，其余 M - F 个地雷在I个内部方块中有C(I, M - F)种放法。
+ * 组合数跨越的数量级很大，按对数计算后除以最大值；各分量的解数也按总数归一化，
+ * 比值不变而不会溢出。
+ * 每个分量的方块概率需要除该分量外其余分量的卷积，由前缀卷积和后缀卷积相乘得到。
+ *
+ * @param engine            概率计算器指针
+ * @param mines             剩余的地雷数M
+ * @return                  是否成功：内存不足、超出预算或没有任何相容的布局时失败
+ */
+static _Bool CombineComponents(ProbabilityEngine *engine, long long mines) {
+    // 分量数
+    int components = engine->number_of_components;
+    // 内部方块数
+    long long interior = engine->number_of_interior_blocks;
+    // 分布的最大长度：前沿地雷数不超过前沿方块数和剩余的地雷数
+    int length = (engine->number_of_frontier_blocks < mines ? engine->number_of_frontier_blocks : (int)mines) + 1;
+    // 所需的元素数
+    size_t required = (size_t)(components + 1) * (size_t)length + (size_t)length * 3
+                      + (size_t)engine->largest_component + 1;
+    // 各分量解数、次数在缓冲区中的起始位置
+    size_t weight_offset, count_offset;
+    // 后缀卷积：第j个分布为第j个及以后各分量的卷积，每个分布占length个元素
+    double *suffix;
+    // 前缀卷积、除当前分量外的卷积、内部组合数权重、当前分量含k个地雷时其余部分的总权重
+    double *prefix, *rest, *binomials, *others;
+    // 各分布的长度
+    int suffix_length, prefix_length, rest_length;
+    // 分量编号、分量大小
+    int component, size;
+    // 下标
+    int i, k, f;
+    // 对数组合数的最大值、总权重、单个分量的解数之和
+    double max_log, total, sum;
+    // 概率
+    double probability;
+    // Gamma函数的符号（参数为正，总是1）
+    int sign;
+
+    // 卷积的计算量与缓冲区大小相当，一并计入节点预算
+    if ((long long)required > engine->node_budget - engine->number_of_nodes
+        || ! Reserve((void **)&engine->convolutions, &engine->convolution_capacity, required, sizeof(double))) {
+        return 0;
+    }
+    engine->number_of_nodes += (long long)required;
+    suffix = engine->convolutions;
+    prefix = suffix + (size_t)(components + 1) * length;
+    rest = prefix + length;
+    binomials = rest + length;
+    others = binomials + length;
+
+    // 各分量的解数和次数按总解数归一化
+    weight_offset = 0;
+    count_offset = 0;
+    for (component = 0; component < components; component++) {
+        size = engine->component_starts[component + 1] - engine->component_starts[component];
+        sum = 0;
+        for (k = 0; k <= size; k++) {
+            sum += engine->weights[weight_offset + k];
+        }
+        if (sum == 0) {
+            return 0;
+        }
+        for (k = 0; k <= size; k++) {
+            engine->weights[weight_offset + k] /= sum;
+        }
+        for (i = 0; i < (size + 1) * size; i++) {
+            engine->counts[count_offset + i] /= sum;
+        }
+        weight_offset += (size_t)size + 1;
+        count_offset += (size_t)(size + 1) * size;
+    }
+
+    // 后缀卷积从空分布开始，逐个分量向前推进；
+    // 第j个分布的长度为 min(第j个及以后各分量的方块数, 前沿地雷数的最大值) + 1
+    suffix[(size_t)components * length] = 1;
+    suffix_length = 1;
+    for (component = components - 1; component >= 0; component--) {
+        size = engine->component_starts[component + 1] - engine->component_starts[component];
+        weight_offset -= (size_t)size + 1;
+        suffix_length = Convolve(engine->weights + weight_offset, size + 1,
+                                 suffix + (size_t)(component + 1) * length, suffix_length,
+                                 suffix + (size_t)component * length, length);
+    }
+
+    // 内部组合数权重
+    max_log = -INFINITY;
+    for (f = 0; f < length; f++) {
+        if (mines - f > interior) {
+            binomials[f] = -INFINITY;
+        } else {
+            // lgamma会写入全局变量signgam，多个线程同时计算时存在数据竞争，因此使用lgamma_r
+            binomials[f] = lgamma_r((double)interior + 1, &sign) - lgamma_r((double)(mines - f) + 1, &sign)
+                           - lgamma_r((double)(interior - mines + f) + 1, &sign);
+        }
+        if (binomials[f] > max_log) {
+            max_log = binomials[f];
+        }
+    }
+    if (max_log == -INFINITY) {
+        return 0;
+    }
+    for (f = 0; f < length; f++) {
+        binomials[f] = exp(binomials[f] - max_log);
+    }
+
+    // 总权重和内部方块的概率
+    total = 0;
+    probability = 0;
+    for (f = 0; f < suffix_length; f++) {
+        total += suffix[f] * binomials[f];
+        probability += suffix[f] * binomials[f] * (double)(mines - f);
+    }
+    if (total <= 0) {
+        return 0;
+    }
+    engine->interior_probability = interior > 0 ? probability / total / (double)interior : -1;
+
+    // 前缀卷积从空分布开始，逐个分量向后推进
+    prefix[0] = 1;
+    prefix_length = 1;
+    count_offset = 0;
+    for (component = 0; component < components; component++) {
+        size = engine->component_starts[component + 1] - engine->component_starts[component];
+        suffix_length = engine->number_of_frontier_blocks - engine->component_starts[component + 1] + 1;
+        suffix_length = suffix_length < length ? suffix_length : length;
+
+        // 除当前分量外的卷积，及当前分量含k个地雷时其余部分的总权重
+        rest_length = Convolve(prefix, prefix_length, suffix + (size_t)(component + 1) * length, suffix_length,
+                               rest, length);
+        engine->number_of_nodes += (long long)prefix_length * suffix_length;
+        for (k = 0; k <= size; k++) {
+            others[k] = 0;
+            for (f = 0; f < rest_length && f + k < length; f++) {
+                others[k] += rest[f] * binomials[f + k];
+            }
+        }
+
+        for (i = 0; i < size; i++) {
+            probability = 0;
+            for (k = 0; k <= size; k++) {
+                probability += engine->counts[count_offset + (size_t)k * size + i] * others[k];
+            }
+            engine->probabilities[engine->cells[engine->order[engine->component_starts[component] + i]]]
+                = probability / total;
+        }
+
+        // 把当前分量并入前缀卷积
+        prefix_length = Convolve(prefix, prefix_length, engine->weights + weight_offset, size + 1, rest, length);
+        memcpy(prefix, rest, sizeof(double) * (size_t)prefix_length);
+        weight_offset += (size_t)size + 1;
+        count_offset += (size_t)(size + 1) * size;
+
+        if (engine->number_of_nodes > engine->node_budget) {
+            return 0;
+        }
+    }
+
+    return 1;
+}
+
+/**
+ * 计算每个未翻开方块是地雷的概率
+ *
+ * 旗标当作未翻开的方块，插错的旗标不影响结果；剩余的地雷数为地雷总数减已知地雷数。
+ * 失败时概率表的内容不可用。
+ *
+ * @param engine            概率计算器指针
+ * @return                  是否成功：内存不足、超出节点预算，
+ *                          或数字、已知地雷和地雷数互相矛盾时失败
+ */
+_Bool ComputeProbabilities(ProbabilityEngine *engine) {
+    // 地图指针
+    Map *map = engine->map;
+    // 已知地雷数
+    long long known;
+    // 剩余的地雷数
+    long long mines;
+    // 行下标、列下标（方块表中，含哨兵行、列）
+    int row, column;
+    // 方块下标
+    int index;
+    // 方块状态
+    BlockStatus status;
+    // 分量编号、分量大小
+    int component, size;
+    // 各分量解数、次数在缓冲区中的起始位置
+    size_t weight_offset, count_offset;
+    // 前沿编号
+    int cell;
+    // 是否成功
+    _Bool is_successful = 0;
+
+    engine->number_of_nodes = 0;
+    engine->number_of_components = 0;
+    engine->largest_component = 0;
+    engine->interior_probability = -1;
+
+    if (! CollectFrontier(engine, &known)) {
+        goto cleanup;
+    }
+    FindComponents(engine);
+
+    // 内部方块
+    mines = map->number_of_mines - known;
+    engine->number_of_interior_blocks = 0;
+    for (row = 1; row <= map->number_of_rows; row++) {
+        for (column = 1; column <= map->number_of_columns; column++) {
+            index = row * map->stride + column;
+            status = BLOCK_STATUS_OF(map->blocks[index]);
+            if (status == BLOCK_STATUS_VISIBLE || IsKnownMine(engine, index)) {
+                engine->probabilities[index] = -1;
+            } else if (engine->block_cells[index] < 0) {
+                engine->number_of_interior_blocks++;
+            }
+        }
+    }
+    if (mines < 0) {
+        goto cleanup;
+    }
+
+    // 逐个分量枚举
+    weight_offset = 0;
+    count_offset = 0;
+    for (component = 0; component < engine->number_of_components; component++) {
+        size = engine->component_starts[component + 1] - engine->component_starts[component];
+        if (! Reserve((void **)&engine->weights, &engine->weight_capacity, weight_offset + size + 1, sizeof(double))
+            || ! Reserve((void **)&engine->counts, &engine->count_capacity,
+                         count_offset + (size_t)(size + 1) * size, sizeof(double))
+            || ! EnumerateComponent(engine, component, engine->weights + weight_offset,
+                                    engine->counts + count_offset, mines)) {
+            goto cleanup;
+        }
+        weight_offset += (size_t)size + 1;
+        count_offset += (size_t)(size + 1) * size;
+    }
+
+    if (! CombineComponents(engine, mines)) {
+        goto cleanup;
+    }
+
+    // 内部方块的概率相同
+    for (row = 1; row <= map->number_of_rows; row++) {
+        for (column = 1; column <= map->number_of_columns; column++) {
+            index = row * map->stride + column;
+            status = BLOCK_STATUS_OF(map->blocks[index]);
+            if (status != BLOCK_STATUS_VISIBLE && ! IsKnownMine(engine, index) && engine->block_cells[index] < 0) {
+                engine->probabilities[index] = engine->interior_probability;
+            }
+        }
+    }
+    is_successful = 1;
+
+cleanup:
+    // 只清除本次用到的前沿编号，不再扫描整个方块表
+    for (cell = 0; cell < engine->number_of_frontier_blocks; cell++) {
+        engine->block_cells[engine->cells[cell]] = -1;
+    }
+
+    return is_successful;
+}
+
+/**
+ * 查询方块是地雷的概率
+ *
+ * @param engine            概率计算器指针
+ * @param row               行下标
+ * @param column            列下标
+ * @return                  上次计算的概率，已翻开的方块和已知的地雷为-1
+ */
+double GetMineProbability(ProbabilityEngine *engine, int row, int column) {
+    return engine->probabilities[BLOCK_INDEX(engine->map, row, column)];
+}
+
+/**
+ * 找出是地雷的概率最小的未翻开方块
+ *
+ * 概率相同时取最靠前的方块；插了旗标但不是已知地雷的方块也参与比较
+ *
+ * @param engine            概率计算器指针，须已成功计算概率
+ * @param row               行下标指针
+ * @param column            列下标指针
+ * @return                  是否找到
+ */
+_Bool FindSafestBlock(ProbabilityEngine *engine, int *row, int *column) {
+    // 地图指针
+    Map *map = engine->map;
+    // 方块下标
+    int index;
+    // 最小概率方块的下标
+    int best = -1;
+    // 概率
+    double probability;
+
+    for (index = map->stride; index < (map->number_of_rows + 1) * map->stride; index++) {
+        probability = engine->probabilities[index];
+        if (probability >= 0 && (best < 0 || probability < engine->probabilities[best])) {
+            best = index;
+        }
+    }
+    if (best < 0) {
+        return 0;
+    }
+
+    *row = best / map->stride - 1;
+    *column = best % map->stride - 1;
+
+    return 1;
+}
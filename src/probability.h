@@ -0,0 +1,119 @@
+/**
+ * ----------------------------------------------------------------------------
+ * [头文件] 地雷概率
+ * ----------------------------------------------------------------------------
+ *
+ * 定义精确计算每个未翻开方块是地雷的概率的数据结构和函数原型
+ *
+ * 与已翻开的数字相邻的未翻开方块构成前沿，前沿按共同的数字约束划分为互相独立的连通分量，
+ * 每个分量单独枚举所有满足约束的地雷分布，再按其余地雷在内部方块中的组合数加权合并。
+ * 旗标不被当作地雷，有旗标的方块与其他未翻开的方块一样计算概率；
+ * 只有调用者给出的已知地雷（例如解机自己推出的地雷）才从约束和剩余的地雷数中减去。
+ *
+ */
+
+
+#ifndef MINESWEEPING_PROBABILITY_H
+#define MINESWEEPING_PROBABILITY_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include "game.h"
+
+/*
+ * 宏定义
+ */
+
+// 默认的搜索节点预算，超出时放弃计算
+#define PROBABILITY_NODE_BUDGET 20000000LL
+
+/*
+ * 数据结构定义
+ */
+
+// 结构体：概率计算器
+typedef struct {
+    // 地图，计算器不拥有地图
+    Map *map;
+    // 已知是地雷的方块，按方块表下标存放，非0为地雷；为NULL时没有已知的地雷。计算器不拥有这个数组
+    const uint8_t *known_mines;
+    // 每个方块是地雷的概率，按方块表下标存放，已翻开的方块、已知的地雷和哨兵方块为-1
+    double *probabilities;
+    // 内部方块（不与任何已翻开的数字相邻的未翻开方块）是地雷的概率
+    double interior_probability;
+    // 前沿方块数
+    int number_of_frontier_blocks;
+    // 内部方块数
+    long long number_of_interior_blocks;
+    // 连通分量数
+    int number_of_components;
+    // 最大连通分量的方块数
+    int largest_component;
+    // 上次计算的搜索节点数
+    long long number_of_nodes;
+    // 搜索节点预算
+    long long node_budget;
+
+    /*
+     * 以下为计算时使用的缓冲区，在多次计算间复用
+     */
+
+    // 每个方块的前沿编号，按方块表下标存放，不是前沿方块时为-1
+    int *block_cells;
+    // 前沿方块在方块表中的下标，按前沿编号存放
+    int *cells;
+    // 每个前沿方块所在的约束编号，每个方块8个位置
+    int *cell_constraints;
+    // 每个前沿方块所在的约束数
+    int *cell_constraint_counts;
+    // 前沿方块缓冲区容量（方块数）
+    size_t cell_capacity;
+    // 每个约束包含的前沿编号，每个约束8个位置
+    int *constraint_cells;
+    // 每个约束包含的前沿方块数
+    int *constraint_counts;
+    // 每个约束剩余的地雷数
+    int *constraint_remaining;
+    // 每个约束中尚未赋值的方块数
+    int *constraint_unassigned;
+    // 约束缓冲区容量（约束数）
+    size_t constraint_capacity;
+    // 按连通分量分组、分量内按广度优先顺序排列的前沿编号
+    int *order;
+    // 每个前沿方块的赋值（1为地雷，0为安全），-1表示尚未赋值
+    signed char *assigned;
+    // 搜索时每层下一个要尝试的值
+    signed char *next_values;
+    // 每个连通分量在排列中的起始位置，最后一个元素为前沿方块数
+    int *component_starts;
+    // 每个连通分量含k个地雷的解数，各分量依次存放，分量j占（方块数 + 1）个
+    double *weights;
+    // 每个连通分量含k个地雷的解中各方块是地雷的次数，分量j占（方块数 + 1） x 方块数个
+    double *counts;
+    // 解数缓冲区容量（元素数）
+    size_t weight_capacity;
+    // 次数缓冲区容量（元素数）
+    size_t count_capacity;
+    // 合并分量时使用的卷积缓冲区：各分量的后缀卷积、前缀卷积、临时卷积和内部组合数权重
+    double *convolutions;
+    // 卷积缓冲区容量（元素数）
+    size_t convolution_capacity;
+} ProbabilityEngine;
+
+/*
+ * 函数原型
+ */
+
+// 创建概率计算器
+ProbabilityEngine * CreateProbabilityEngine(Map *map);
+// 销毁概率计算器
+void DestroyProbabilityEngine(ProbabilityEngine **engine);
+// 计算每个未翻开方块是地雷的概率
+_Bool ComputeProbabilities(ProbabilityEngine *engine);
+// 查询方块是地雷的概率
+double GetMineProbability(ProbabilityEngine *engine, int row, int column);
+// 找出是地雷的概率最小的未翻开方块
+_Bool FindSafestBlock(ProbabilityEngine *engine, int *row, int *column);
+
+#endif //MINESWEEPING_PROBABILITY_H
@@ -0,0 +1,207 @@
+/**
+ * ----------------------------------------------------------------------------
+ * [源文件] 密度金字塔
+ * ----------------------------------------------------------------------------
+ *
+ * 定义多分辨率统计金字塔的各个函数
+ *
+ * 方块状态每改变一次，只需更新每层中包含该方块的一个瓦片，开销与层数成正比；
+ * 绘制总览图时直接读取合适层的瓦片，开销与屏幕字符数成正比，无需扫描方块表。
+ *
+ */
+
+
+#include <stdlib.h>
+#include <string.h>
+
+#include "pyramid.h"
+
+
+/**
+ * 创建密度金字塔
+ *
+ * @param rows              地图行数
+ * @param columns           地图列数
+ * @return                  密度金字塔指针，分配失败返回NULL
+ */
+Pyramid * CreatePyramid(int rows, int columns) {
+    // 密度金字塔指针
+    Pyramid *pyramid;
+    // 层序号
+    int level;
+    // 瓦片边长的以2为底的对数
+    int shift;
+    // 全部层的瓦片总数
+    size_t total = 0;
+    // 各层瓦片的起始位置
+    size_t offsets[PYRAMID_MAX_LEVELS];
+
+    pyramid = (Pyramid *)malloc(sizeof(Pyramid));
+    if (! pyramid) {
+        return NULL;
+    }
+
+    pyramid->number_of_rows = rows;
+    pyramid->number_of_columns = columns;
+
+    // 逐层加倍瓦片边长，直到整个地图只有一个瓦片
+    level = 0;
+    do {
+        shift = PYRAMID_BASE_SHIFT + level;
+        pyramid->tile_rows[level] = (int)(((long long)rows + (1LL << shift) - 1) >> shift);
+        pyramid->tile_columns[level] = (int)(((long long)columns + (1LL << shift) - 1) >> shift);
+        offsets[level] = total;
+        total += (size_t)pyramid->tile_rows[level] * (size_t)pyramid->tile_columns[level];
+        level++;
+    } while ((pyramid->tile_rows[level - 1] > 1 || pyramid->tile_columns[level - 1] > 1) && level < PYRAMID_MAX_LEVELS);
+    pyramid->number_of_levels = level;
+
+    pyramid->levels[0] = (PyramidTile *)calloc(total, sizeof(PyramidTile));
+    if (! pyramid->levels[0]) {
+        free(pyramid);
+        return NULL;
+    }
+    for (level = 1; level < pyramid->number_of_levels; level++) {
+        pyramid->levels[level] = pyramid->levels[0] + offsets[level];
+    }
+
+    return pyramid;
+}
+
+/**
+ * 销毁密度金字塔
+ *
+ * @param pyramid           密度金字塔指针的指针
+ */
+void DestroyPyramid(Pyramid **pyramid) {
+    if (*pyramid) {
+        free((*pyramid)->levels[0]);
+        free(*pyramid);
+    }
+    *pyramid = NULL;
+}
+
+/**
+ * 清空全部统计
+ *
+ * @param pyramid           密度金字塔指针
+ */
+void ClearPyramid(Pyramid *pyramid) {
+    // 层序号
+    int level;
+
+    for (level = 0; level < pyramid->number_of_levels; level++) {
+        memset(pyramid->levels[level], 0, sizeof(PyramidTile) * (size_t)pyramid->tile_rows[level] * (size_t)pyramid->tile_columns[level]);
+    }
+}
+
+/**
+ * 由第0层的统计汇总出其他各层
+ *
+ * 上层每个瓦片是下层2 x 2个瓦片之和，总开销与第0层瓦片数成正比
+ *
+ * @param pyramid           密度金字塔指针
+ */
+void AccumulatePyramid(Pyramid *pyramid) {
+    // 层序号
+    int level;
+    // 下层瓦片行下标、列下标
+    int tile_row, tile_column;
+    // 下层瓦片
+    PyramidTile *child;
+    // 上层瓦片
+    PyramidTile *parent;
+
+    for (level = 1; level < pyramid->number_of_levels; level++) {
+        memset(pyramid->levels[level], 0, sizeof(PyramidTile) * (size_t)pyramid->tile_rows[level] * (size_t)pyramid->tile_columns[level]);
+        for (tile_row = 0; tile_row < pyramid->tile_rows[level - 1]; tile_row++) {
+            for (tile_column = 0; tile_column < pyramid->tile_columns[level - 1]; tile_column++) {
+                child = GetPyramidTile(pyramid, level - 1, tile_row, tile_column);
+                parent = GetPyramidTile(pyramid, level, tile_row >> 1, tile_column >> 1);
+                parent->visible += child->visible;
+                parent->flags += child->flags;
+            }
+        }
+    }
+}
+
+/**
+ * 方块状态改变时更新各层统计
+ *
+ * @param pyramid           密度金字塔指针
+ * @param row               方块行下标
+ * @param column            方块列下标
+ * @param visible_delta     已翻开方块数的变化量
+ * @param flag_delta        旗标数的变化量
+ */
+void AdjustPyramid(Pyramid *pyramid, int row, int column, int visible_delta, int flag_delta) {
+    // 层序号
+    int level;
+    // 瓦片
+    PyramidTile *tile;
+
+    for (level = 0; level < pyramid->number_of_levels; level++) {
+        tile = GetPyramidTile(pyramid, level, row >> (PYRAMID_BASE_SHIFT + level), column >> (PYRAMID_BASE_SHIFT + level));
+        tile->visible += (uint32_t)visible_delta;
+        tile->flags += (uint32_t)flag_delta;
+    }
+}
+
+/**
+ * 取得瓦片统计
+ *
+ * @param pyramid           密度金字塔指针
+ * @param level             层序号
+ * @param tile_row          瓦片行下标
+ * @param tile_column       瓦片列下标
+ * @return                  瓦片指针
+ */
+PyramidTile * GetPyramidTile(Pyramid *pyramid, int level, int tile_row, int tile_column) {
+    return pyramid->levels[level] + (size_t)tile_row * (size_t)pyramid->tile_columns[level] + (size_t)tile_column;
+}
+
+/**
+ * 瓦片中的方块数
+ *
+ * 位于地图右边缘和下边缘的瓦片可能不完整
+ *
+ * @param pyramid           密度金字塔指针
+ * @param level             层序号
+ * @param tile_row          瓦片行下标
+ * @param tile_column       瓦片列下标
+ * @return                  方块数
+ */
+long long PyramidTileBlocks(Pyramid *pyramid, int level, int tile_row, int tile_column) {
+    // 瓦片边长的以2为底的对数
+    int shift = PYRAMID_BASE_SHIFT + level;
+    // 瓦片的起始行、起始列
+    long long top = (long long)tile_row << shift, left = (long long)tile_column << shift;
+    // 瓦片的行数、列数
+    long long rows = pyramid->number_of_rows - top, columns = pyramid->number_of_columns - left;
+
+    rows = rows < (1LL << shift) ? rows : (1LL << shift);
+    columns = columns < (1LL << shift) ? columns : (1LL << shift);
+
+    return rows * columns;
+}
+
+/**
+ * 选择瓦片行数和列数不超过指定值的最精细的层
+ *
+ * @param pyramid           密度金字塔指针
+ * @param rows              最大瓦片行数
+ * @param columns           最大瓦片列数
+ * @return                  层序号，没有满足条件的层时返回最高层
+ */
+int ChoosePyramidLevel(Pyramid *pyramid, int rows, int columns) {
+    // 层序号
+    int level;
+
+    for (level = 0; level < pyramid->number_of_levels - 1; level++) {
+        if (pyramid->tile_rows[level] <= rows && pyramid->tile_columns[level] <= columns) {
+            break;
+        }
+    }
+
+    return level;
+}
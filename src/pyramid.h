@@ -0,0 +1,77 @@
+/**
+ * ----------------------------------------------------------------------------
+ * [头文件] 密度金字塔
+ * ----------------------------------------------------------------------------
+ *
+ * 定义多分辨率统计金字塔的数据结构和函数原型
+ *
+ * 地图被划分为正方形瓦片，每层瓦片的边长是下一层的2倍，
+ * 每个瓦片记录其中已翻开和插旗的方块数，用于绘制超大地图的总览图。
+ *
+ */
+
+
+#ifndef MINESWEEPING_PYRAMID_H
+#define MINESWEEPING_PYRAMID_H
+
+#include <stdint.h>
+
+/*
+ * 宏定义
+ */
+
+// 第0层瓦片边长的以2为底的对数（8 x 8个方块）
+#define PYRAMID_BASE_SHIFT 3
+// 最大层数
+#define PYRAMID_MAX_LEVELS 32
+
+/*
+ * 数据结构定义
+ */
+
+// 结构体：瓦片统计
+typedef struct {
+    // 已翻开方块数
+    uint32_t visible;
+    // 旗标数
+    uint32_t flags;
+} PyramidTile;
+
+// 结构体：密度金字塔
+typedef struct {
+    // 地图行数
+    int number_of_rows;
+    // 地图列数
+    int number_of_columns;
+    // 层数，最高层只有一个瓦片
+    int number_of_levels;
+    // 每层的瓦片行数
+    int tile_rows[PYRAMID_MAX_LEVELS];
+    // 每层的瓦片列数
+    int tile_columns[PYRAMID_MAX_LEVELS];
+    // 每层的瓦片，按行优先存放，各层共用一块内存
+    PyramidTile *levels[PYRAMID_MAX_LEVELS];
+} Pyramid;
+
+/*
+ * 函数原型
+ */
+
+// 创建密度金字塔
+Pyramid * CreatePyramid(int rows, int columns);
+// 销毁密度金字塔
+void DestroyPyramid(Pyramid **pyramid);
+// 清空全部统计
+void ClearPyramid(Pyramid *pyramid);
+// 由第0层的统计汇总出其他各层
+void AccumulatePyramid(Pyramid *pyramid);
+// 方块状态改变时更新各层统计
+void AdjustPyramid(Pyramid *pyramid, int row, int column, int visible_delta, int flag_delta);
+// 取得瓦片统计
+PyramidTile * GetPyramidTile(Pyramid *pyramid, int level, int tile_row, int tile_column);
+// 瓦片中的方块数
+long long PyramidTileBlocks(Pyramid *pyramid, int level, int tile_row, int tile_column);
+// 选择瓦片行数和列数不超过指定值的最精细的层
+int ChoosePyramidLevel(Pyramid *pyramid, int rows, int columns);
+
+#endif //MINESWEEPING_PYRAMID_H
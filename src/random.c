@@ -0,0 +1,131 @@
+/**
+ * ----------------------------------------------------------------------------
+ * [源文件] 随机数
+ * ----------------------------------------------------------------------------
+ *
+ * 定义伪随机数发生器的各个函数
+ *
+ */
+
+
+#include <time.h>
+#include <stdatomic.h>
+
+#include "random.h"
+
+
+/**
+ * SplitMix64混合函数，用于把种子扩展为发生器状态
+ *
+ * @param x                 输入值指针，调用后自增
+ * @return                  混合后的值
+ */
+static uint64_t SplitMix64(uint64_t *x) {
+    // 混合值
+    uint64_t z = (*x += 0x9E3779B97F4A7C15ULL);
+
+    z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+    z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+    return z ^ (z >> 31);
+}
+
+/**
+ * 循环左移
+ *
+ * @param x                 输入值
+ * @param k                 位数
+ * @return                  移位结果
+ */
+static uint64_t RotateLeft(uint64_t x, int k) {
+    return (x << k) | (x >> (64 - k));
+}
+
+/**
+ * 生成一个非零的随机数种子
+ *
+ * 由当前时间、处理器时间和调用次数混合而成，同一秒内多次调用也会得到不同的种子。
+ * 调用次数是原子计数器，多个线程同时调用时也各不相同。
+ *
+ * @return                  随机数种子
+ */
+uint64_t GenerateSeed() {
+    // 调用次数，进程内唯一的共享状态
+    static _Atomic uint64_t counter = 0;
+    // 混合输入
+    uint64_t x;
+    // 种子
+    uint64_t seed;
+
+    x = (uint64_t)time(NULL) ^ ((uint64_t)clock() << 32) ^ ((atomic_fetch_add(&counter, 1) + 1) * 0xD1B54A32D192ED03ULL);
+    do {
+        seed = SplitMix64(&x);
+    } while (seed == 0);
+
+    return seed;
+}
+
+/**
+ * 设置随机数种子
+ *
+ * @param random            随机数发生器指针
+ * @param seed              随机数种子
+ */
+void SeedRandom(Random *random, uint64_t seed) {
+    // 状态下标
+    int i;
+
+    for (i = 0; i < 4; i++) {
+        random->state[i] = SplitMix64(&seed);
+    }
+}
+
+/**
+ * 生成下一个64位随机数
+ *
+ * @param random            随机数发生器指针
+ * @return                  随机数
+ */
+uint64_t NextRandom(Random *random) {
+    // 状态
+    uint64_t *s = random->state;
+    // 结果
+    uint64_t result = RotateLeft(s[1] * 5, 7) * 9;
+    // 临时值
+    uint64_t t = s[1] << 17;
+
+    s[2] ^= s[0];
+    s[3] ^= s[1];
+    s[1] ^= s[2];
+    s[0] ^= s[3];
+    s[2] ^= t;
+    s[3] = RotateLeft(s[3], 45);
+
+    return result;
+}
+
+/**
+ * 生成[0, bound)范围内的随机数
+ *
+ * 取64位随机数与bound乘积的高64位，不使用除法，也没有拒绝重试，
+ * 偏差不超过bound / 2^64，对于地图规模可以忽略
+ *
+ * @param random            随机数发生器指针
+ * @param bound             上界（不含），必须大于0
+ * @return                  随机数
+ */
+uint64_t RandomBelow(Random *random, uint64_t bound) {
+    // 随机数
+    uint64_t x = NextRandom(random);
+    // 两个乘数的高、低32位
+    uint64_t x_high = x >> 32, x_low = x & 0xFFFFFFFFULL;
+    uint64_t b_high = bound >> 32, b_low = bound & 0xFFFFFFFFULL;
+    // 部分积
+    uint64_t low_low = x_low * b_low;
+    uint64_t high_low = x_high * b_low;
+    uint64_t low_high = x_low * b_high;
+    uint64_t high_high = x_high * b_high;
+    // 中间进位
+    uint64_t middle = (low_low >> 32) + (high_low & 0xFFFFFFFFULL) + low_high;
+
+    return high_high + (high_low >> 32) + (middle >> 32);
+}
@@ -0,0 +1,39 @@
+/**
+ * ----------------------------------------------------------------------------
+ * [头文件] 随机数
+ * ----------------------------------------------------------------------------
+ *
+ * 定义可显式设置种子的伪随机数发生器（xoshiro256**）
+ *
+ */
+
+
+#ifndef MINESWEEPING_RANDOM_H
+#define MINESWEEPING_RANDOM_H
+
+#include <stdint.h>
+
+/*
+ * 数据结构定义
+ */
+
+// 结构体：随机数发生器
+typedef struct {
+    // 内部状态
+    uint64_t state[4];
+} Random;
+
+/*
+ * 函数原型
+ */
+
+// 生成一个非零的随机数种子
+uint64_t GenerateSeed();
+// 设置随机数种子
+void SeedRandom(Random *random, uint64_t seed);
+// 生成下一个64位随机数
+uint64_t NextRandom(Random *random);
+// 生成[0, bound)范围内的随机数
+uint64_t RandomBelow(Random *random, uint64_t bound);
+
+#endif //MINESWEEPING_RANDOM_H
@@ -0,0 +1,1026 @@
+/**
+ * ----------------------------------------------------------------------------
+ * [源文件] 渲染
+ * ----------------------------------------------------------------------------
+ *
+ * 定义帧缓冲区和地图渲染的各个函数
+ *
+ * 一帧画面先完整地组装到可复用的帧缓冲区中，再用一次write写入终端，
+ * 方块的显示内容按（状态，类型）预先生成，渲染时只做查表和内存复制。
+ *
+ */
+
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <sys/ioctl.h>
+
+#include "render.h"
+
+
+// 结构体：方块显示内容
+typedef struct {
+    // 内容（含样式）
+    const char *text;
+    // 字节数
+    size_t length;
+} Glyph;
+
+// 由字符串字面量组成显示内容
+#define GLYPH(text) { text, sizeof(text) - 1 }
+// 数字方块的显示内容
+#define NUMBER_GLYPH(n) GLYPH(NUMBER_BLOCK_STYLE " " #n " " CLEAR_STYLE)
+
+// 不可见、旗标、疑问标方块的显示内容，与类型无关
+static const Glyph STATUS_GLYPHS[] = {
+    // 不可见
+    GLYPH(INVISIBLE_BLOCK_STYLE "   " CLEAR_STYLE),
+    // 旗标
+    GLYPH(FLAG_BLOCK_STYLE " F " CLEAR_STYLE),
+    // 疑问标
+    GLYPH(DOUBT_BLOCK_STYLE " ? " CLEAR_STYLE),
+};
+
+// 可见方块的显示内容，按类型索引
+static const Glyph VISIBLE_GLYPHS[] = {
+    // 空白
+    GLYPH("   "),
+    // 数字1 ~ 8
+    NUMBER_GLYPH(1),
+    NUMBER_GLYPH(2),
+    NUMBER_GLYPH(3),
+    NUMBER_GLYPH(4),
+    NUMBER_GLYPH(5),
+    NUMBER_GLYPH(6),
+    NUMBER_GLYPH(7),
+    NUMBER_GLYPH(8),
+    // 地雷
+    GLYPH(MINE_BLOCK_STYLE " * " CLEAR_STYLE),
+};
+
+// 游戏过程界面中地图以外部分占用的行数，含输入提示行和一行错误信息
+#define GAME_SCREEN_FIXED_LINES 30
+// 精简的操作说明比完整的操作说明少占用的行数
+#define COMPACT_HELP_SAVED_LINES 12
+// 地图放不下时，完整显示操作说明至少要保留的视口行数
+#define MIN_VIEWPORT_ROWS_WITH_HELP 8
+
+// 总览图瓦片的样式，按（类别，是否与视口相交）索引，类别依次为全部已翻开、有未翻开方块、有旗标
+static const char * const OVERVIEW_STYLES[][2] = {
+    { CLEAR_STYLE, CLEAR_STYLE OVERVIEW_VIEWPORT_STYLE },
+    { INVISIBLE_BLOCK_STYLE, INVISIBLE_BLOCK_STYLE OVERVIEW_VIEWPORT_STYLE },
+    { FLAG_BLOCK_STYLE, FLAG_BLOCK_STYLE OVERVIEW_VIEWPORT_STYLE },
+};
+
+// 打印地图使用的帧缓冲区，在多次打印间复用（只供终端界面的主线程使用）
+static FrameBuffer print_buffer = { NULL, 0, 0 };
+
+/**
+ * 确保帧缓冲区还能容纳指定字节数
+ *
+ * @param buffer            帧缓冲区指针
+ * @param length            需要追加的字节数
+ * @return                  是否有足够空间
+ */
+static _Bool ReserveFrameBuffer(FrameBuffer *buffer, size_t length) {
+    // 新容量
+    size_t capacity;
+    // 新数据
+    char *data;
+
+    if (buffer->length + length <= buffer->capacity) {
+        return 1;
+    }
+
+    capacity = buffer->capacity ? buffer->capacity : 4096;
+    while (capacity < buffer->length + length) {
+        capacity *= 2;
+    }
+    data = (char *)realloc(buffer->data, capacity);
+    if (! data) {
+        return 0;
+    }
+    buffer->data = data;
+    buffer->capacity = capacity;
+
+    return 1;
+}
+
+/**
+ * 追加字节
+ *
+ * @param buffer            帧缓冲区指针
+ * @param bytes             字节
+ * @param length            字节数
+ */
+void AppendBytes(FrameBuffer *buffer, const char *bytes, size_t length) {
+    if (ReserveFrameBuffer(buffer, length)) {
+        memcpy(buffer->data + buffer->length, bytes, length);
+        buffer->length += length;
+    }
+}
+
+/**
+ * 追加字符串
+ *
+ * @param buffer            帧缓冲区指针
+ * @param string            字符串
+ */
+void AppendString(FrameBuffer *buffer, const char *string) {
+    AppendBytes(buffer, string, strlen(string));
+}
+
+/**
+ * 追加若干个相同字符
+ *
+ * @param buffer            帧缓冲区指针
+ * @param character         字符
+ * @param count             个数，不大于0时不追加
+ */
+void AppendRepeat(FrameBuffer *buffer, char character, int count) {
+    if (count > 0 && ReserveFrameBuffer(buffer, (size_t)count)) {
+        memset(buffer->data + buffer->length, character, (size_t)count);
+        buffer->length += (size_t)count;
+    }
+}
+
+/**
+ * 追加格式化的整数
+ *
+ * @param buffer            帧缓冲区指针
+ * @param conversion        printf格式的转换说明，参数类型为long long
+ * @param value             整数
+ * @return                  追加的字节数
+ */
+int AppendInteger(FrameBuffer *buffer, const char *conversion, long long value) {
+    // 格式化结果
+    char text[64];
+    // 字节数
+    int length = snprintf(text, sizeof(text), conversion, value);
+
+    if (length <= 0) {
+        return 0;
+    }
+    length = length < (int)sizeof(text) ? length : (int)sizeof(text) - 1;
+    AppendBytes(buffer, text, (size_t)length);
+
+    return length;
+}
+
+/**
+ * 将帧缓冲区一次性写入标准输出，并清空缓冲区
+ *
+ * 写入前先刷新stdio缓冲区，保证与printf输出的先后顺序
+ *
+ * @param buffer            帧缓冲区指针
+ */
+void FlushFrameBuffer(FrameBuffer *buffer) {
+    // 已写入字节数
+    size_t written = 0;
+    // 本次写入字节数
+    ssize_t n;
+
+    fflush(stdout);
+    while (written < buffer->length) {
+        n = write(STDOUT_FILENO, buffer->data + written, buffer->length - written);
+        if (n <= 0) {
+            break;
+        }
+        written += (size_t)n;
+    }
+    buffer->length = 0;
+}
+
+/**
+ * 释放帧缓冲区
+ *
+ * @param buffer            帧缓冲区指针
+ */
+void DestroyFrameBuffer(FrameBuffer *buffer) {
+    free(buffer->data);
+    buffer->data = NULL;
+    buffer->length = 0;
+    buffer->capacity = 0;
+}
+
+/**
+ * 方块的显示内容（含样式）
+ *
+ * @param block             方块，可见方块的类型必须已计算
+ * @param length            字节数指针
+ * @return                  显示内容
+ */
+const char * BlockGlyph(Block block, size_t *length) {
+    // 显示内容
+    const Glyph *glyph;
+
+    if (BLOCK_STATUS_OF(block) == BLOCK_STATUS_VISIBLE) {
+        glyph = &VISIBLE_GLYPHS[BLOCK_TYPE_OF(block) <= BLOCK_TYPE_MINE ? BLOCK_TYPE_OF(block) : BLOCK_TYPE_MINE];
+    } else {
+        glyph = &STATUS_GLYPHS[BLOCK_STATUS_OF(block)];
+    }
+
+    *length = glyph->length;
+    return glyph->text;
+}
+
+/**
+ * 获取终端大小
+ *
+ * 标准输出不是终端或获取失败时，使用默认的控制台宽度和高度
+ *
+ * @param lines             终端行数指针
+ * @param columns           终端列数指针
+ */
+void GetTerminalSize(int *lines, int *columns) {
+    // 终端窗口大小
+    struct winsize size;
+
+    if (ioctl(STDOUT_FILENO, TIOCGWINSZ, &size) == 0 && size.ws_row > 0 && size.ws_col > 0) {
+        *lines = size.ws_row;
+        *columns = size.ws_col;
+    } else {
+        *lines = CONSOLE_HEIGHT;
+        *columns = CONSOLE_WIDTH;
+    }
+}
+
+/**
+ * 计算地图的排版参数
+ *
+ * 行编号和列编号的宽度按整个地图计算，滚动视口时表格不会变宽或变窄
+ *
+ * @param map               地图指针
+ * @param columns           显示的列数
+ * @param console_width     居中所依据的终端宽度
+ * @param row_number_width  行编号输出宽度指针
+ * @param column_number_width 列编号输出宽度指针
+ * @param center_prefix_space_number 居中前导空格数指针，可能为负数
+ */
+static void ComputeMapLayout(Map *map, int columns, int console_width, int *row_number_width, int *column_number_width, int *center_prefix_space_number) {
+    // 临时整数
+    int n;
+    // 输出宽度
+    int width;
+
+    // 计算行编号最大数字位数
+    *row_number_width = 0;
+    for (n = map->number_of_rows; n; n /= 10) {
+        (*row_number_width)++;
+    }
+
+    // 计算列编号最大数字位数，最小宽度为3
+    *column_number_width = 0;
+    for (n = map->number_of_columns; n; n /= 10) {
+        (*column_number_width)++;
+    }
+    *column_number_width = *column_number_width >= 3 ? *column_number_width : 3;
+
+    // 计算输出宽度和居中前导空格数
+    width = *row_number_width + 1 + (1 + *column_number_width) * columns + 1;
+    *center_prefix_space_number = (console_width - width) / 2;
+}
+
+/**
+ * 终端一行能容纳的地图列数
+ *
+ * @param map               地图指针
+ * @param console_width     终端宽度
+ * @return                  列数，介于1和地图列数之间
+ */
+static int FitMapColumns(Map *map, int console_width) {
+    // 行编号输出宽度
+    int row_number_width;
+    // 列编号输出宽度
+    int column_number_width;
+    // 居中前导空格数
+    int center_prefix_space_number;
+    // 列数
+    int columns;
+
+    ComputeMapLayout(map, 0, console_width, &row_number_width, &column_number_width, &center_prefix_space_number);
+    columns = (console_width - row_number_width - 2) / (1 + column_number_width);
+
+    return columns < 1 ? 1 : (columns > map->number_of_columns ? map->number_of_columns : columns);
+}
+
+/**
+ * 将视口限制在地图范围内
+ *
+ * @param viewport          视口指针，行数和列数不超过地图的行数和列数
+ * @param map               地图指针
+ */
+static void ClampViewport(Viewport *viewport, Map *map) {
+    if (viewport->top > map->number_of_rows - viewport->rows) {
+        viewport->top = map->number_of_rows - viewport->rows;
+    }
+    if (viewport->top < 0) {
+        viewport->top = 0;
+    }
+    if (viewport->left > map->number_of_columns - viewport->columns) {
+        viewport->left = map->number_of_columns - viewport->columns;
+    }
+    if (viewport->left < 0) {
+        viewport->left = 0;
+    }
+}
+
+/**
+ * 将地图的一个窗口渲染到帧缓冲区
+ *
+ * 只访问窗口内的方块，开销与窗口大小成正比，与地图大小无关。
+ * 行编号和列编号显示方块在整个地图中的真实编号。
+ *
+ * @param buffer            帧缓冲区指针
+ * @param map               地图指针
+ * @param window            窗口指针，必须在地图范围内
+ * @param console_width     居中所依据的终端宽度
+ */
+void RenderMap(FrameBuffer *buffer, Map *map, const Viewport *window, int console_width) {
+    // 行编号输出宽度
+    int row_number_width;
+    // 列编号输出宽度
+    int column_number_width;
+    // 列编号转换说明
+    char column_number_conversion[32];
+    // 行编号转换说明
+    char row_number_conversion[32];
+    // 行下标
+    int row;
+    // 列下标
+    int column;
+    // 居中前导空格数
+    int center_prefix_space_number;
+    // 标尺线（含前导空格）
+    FrameBuffer ruler = { NULL, 0, 0 };
+    // 方块左侧和右侧的表格内容
+    FrameBuffer cell_prefix = { NULL, 0, 0 }, cell_suffix = { NULL, 0, 0 };
+    // 方块显示内容
+    const char *glyph;
+    // 方块显示内容字节数
+    size_t glyph_length;
+    // 方块指针
+    Block *block;
+
+    // 计算排版参数
+    ComputeMapLayout(map, window->columns, console_width, &row_number_width, &column_number_width, &center_prefix_space_number);
+    sprintf(row_number_conversion, "%%%dlld ", row_number_width);
+    sprintf(column_number_conversion, " %%-%dlld", column_number_width);
+
+    // 预先生成标尺线
+    AppendRepeat(&ruler, ' ', center_prefix_space_number);
+    AppendRepeat(&ruler, ' ', row_number_width + 1);
+    for (column = 0; column < window->columns; column++) {
+        AppendBytes(&ruler, "+", 1);
+        AppendRepeat(&ruler, '-', column_number_width);
+    }
+    AppendBytes(&ruler, "+\n", 2);
+
+    // 预先生成方块两侧的表格内容
+    AppendString(&cell_prefix, BLOCK_TABLE_STYLE "|");
+    AppendRepeat(&cell_prefix, ' ', (column_number_width - 1) / 2 - 1);
+    AppendString(&cell_prefix, CLEAR_STYLE);
+    AppendString(&cell_suffix, BLOCK_TABLE_STYLE);
+    AppendRepeat(&cell_suffix, ' ', (column_number_width - 1) - ((column_number_width - 1) / 2) - 1);
+    AppendString(&cell_suffix, CLEAR_STYLE);
+
+    /*
+     * 表头
+     */
+
+    // 第一行：列编号
+    AppendString(buffer, BLOCK_TABLE_STYLE);
+    AppendRepeat(buffer, ' ', center_prefix_space_number);
+    AppendRepeat(buffer, ' ', row_number_width + 1);
+    for (column = window->left; column < window->left + window->columns; column++) {
+        AppendInteger(buffer, column_number_conversion, column + 1);
+    }
+    AppendBytes(buffer, " \n", 2);
+    // 第二行：顶部标尺线
+    AppendBytes(buffer, ruler.data, ruler.length);
+    AppendString(buffer, CLEAR_STYLE);
+
+    /*
+     * 每一行
+     */
+
+    for (row = window->top; row < window->top + window->rows; row++) {
+        // 第一行：行编号和方块
+        AppendRepeat(buffer, ' ', center_prefix_space_number);
+        AppendString(buffer, BLOCK_TABLE_STYLE);
+        AppendInteger(buffer, row_number_conversion, row + 1);
+        AppendString(buffer, CLEAR_STYLE);
+
+        block = &BLOCK_AT(map, row, window->left);
+        for (column = 0; column < window->columns; column++) {
+            glyph = BlockGlyph(block[column], &glyph_length);
+            AppendBytes(buffer, cell_prefix.data, cell_prefix.length);
+            AppendBytes(buffer, glyph, glyph_length);
+            AppendBytes(buffer, cell_suffix.data, cell_suffix.length);
+        }
+        AppendString(buffer, BLOCK_TABLE_STYLE "|\n" CLEAR_STYLE);
+
+        // 第二行：行间分隔标尺线
+        AppendString(buffer, BLOCK_TABLE_STYLE);
+        AppendBytes(buffer, ruler.data, ruler.length);
+        AppendString(buffer, CLEAR_STYLE);
+    }
+
+    DestroyFrameBuffer(&ruler);
+    DestroyFrameBuffer(&cell_prefix);
+    DestroyFrameBuffer(&cell_suffix);
+}
+
+/**
+ * 将地图的总览图渲染到帧缓冲区
+ *
+ * 每个字符表示密度金字塔中的一个瓦片，选择能放进指定区域的最精细的层，
+ * 开销与输出的字符数成正比，不访问方块表。
+ * 全部已翻开的瓦片显示为空白，有旗标的显示为F，其余按未翻开的比例显示为#、+或.，
+ * 与视口相交的瓦片反色显示。
+ *
+ * @param buffer            帧缓冲区指针
+ * @param map               地图指针
+ * @param viewport          视口指针
+ * @param lines             占用的行数，不足时以空行补齐
+ * @param console_width     终端宽度
+ */
+void RenderOverview(FrameBuffer *buffer, Map *map, const Viewport *viewport, int lines, int console_width) {
+    // 密度金字塔
+    Pyramid *pyramid = map->pyramid;
+    // 层序号
+    int level;
+    // 瓦片边长的以2为底的对数
+    int shift;
+    // 瓦片行下标、列下标
+    int tile_row, tile_column;
+    // 瓦片
+    PyramidTile *tile;
+    // 瓦片中的方块数、未翻开的方块数
+    long long blocks, unexplored;
+    // 瓦片是否与视口相交
+    _Bool is_in_viewport;
+    // 瓦片类别
+    int kind;
+    // 瓦片样式、上一个瓦片的样式
+    const char *style, *previous_style;
+    // 瓦片显示字符
+    char glyph;
+    // 已输出的行数
+    int line = 0;
+
+    if (! pyramid) {
+        AppendString(buffer, "    " ERROR_MESSAGE_STYLE "内存不足，无法显示总览图" CLEAR_STYLE "\n");
+        AppendRepeat(buffer, '\n', lines - 1);
+        return;
+    }
+
+    // 第1行为说明，第2行空行
+    level = ChoosePyramidLevel(pyramid, lines - 2, console_width);
+    shift = PYRAMID_BASE_SHIFT + level;
+    AppendString(buffer, "    总览图: 每个字符表示 " HIGHLIGHT_STYLE);
+    AppendInteger(buffer, "%lld", 1LL << shift);
+    AppendString(buffer, " x ");
+    AppendInteger(buffer, "%lld", 1LL << shift);
+    AppendString(buffer, CLEAR_STYLE " 个方块  #未翻开 +多数未翻开 .少数未翻开 F有旗标\n\n");
+    line += 2;
+
+    for (tile_row = 0; tile_row < pyramid->tile_rows[level] && line < lines; tile_row++, line++) {
+        AppendRepeat(buffer, ' ', (console_width - pyramid->tile_columns[level]) / 2);
+        previous_style = NULL;
+        for (tile_column = 0; tile_column < pyramid->tile_columns[level]; tile_column++) {
+            tile = GetPyramidTile(pyramid, level, tile_row, tile_column);
+            blocks = PyramidTileBlocks(pyramid, level, tile_row, tile_column);
+            unexplored = blocks - tile->visible - tile->flags;
+
+            if (tile->flags) {
+                kind = 2;
+                glyph = 'F';
+            } else if (unexplored == 0) {
+                kind = 0;
+                glyph = ' ';
+            } else {
+                kind = 1;
+                glyph = unexplored == blocks ? '#' : (unexplored * 2 >= blocks ? '+' : '.');
+            }
+
+            is_in_viewport = ((long long)tile_row << shift) < viewport->top + viewport->rows
+                             && ((long long)(tile_row + 1) << shift) > viewport->top
+                             && ((long long)tile_column << shift) < viewport->left + viewport->columns
+                             && ((long long)(tile_column + 1) << shift) > viewport->left;
+            style = OVERVIEW_STYLES[kind][is_in_viewport];
+
+            // 只在样式改变时输出样式序列
+            if (style != previous_style) {
+                AppendString(buffer, CLEAR_STYLE);
+                AppendString(buffer, style);
+                previous_style = style;
+            }
+            AppendBytes(buffer, &glyph, 1);
+        }
+        AppendString(buffer, CLEAR_STYLE "\n");
+    }
+
+    AppendRepeat(buffer, '\n', lines - line);
+}
+
+/**
+ * 打印以指定方块为中心、适合终端大小的地图窗口
+ *
+ * 宽度不超过终端宽度，输出的行数不超过终端行数，超大地图不会输出大量折行的内容
+ *
+ * @param map               地图指针
+ * @param row               中心方块的行下标
+ * @param column            中心方块的列下标
+ */
+void PrintMap(Map *map, int row, int column) {
+    // 终端行数、列数
+    int lines, columns;
+    // 窗口
+    Viewport window;
+
+    GetTerminalSize(&lines, &columns);
+    // 表头占2行，每行方块占2行（方块行和分隔线），至少显示1行
+    window.rows = (lines - 2) / 2;
+    if (window.rows < 1) {
+        window.rows = 1;
+    }
+    if (window.rows > map->number_of_rows) {
+        window.rows = map->number_of_rows;
+    }
+    window.columns = FitMapColumns(map, columns);
+    window.top = row - window.rows / 2;
+    window.left = column - window.columns / 2;
+    ClampViewport(&window, map);
+
+    RenderMap(&print_buffer, map, &window, columns);
+    FlushFrameBuffer(&print_buffer);
+}
+
+/**
+ * 字符串在终端中的显示宽度
+ *
+ * ASCII字符占1列，其他字符（本程序中均为中文）占2列
+ *
+ * @param string            UTF-8字符串
+ * @return                  显示宽度
+ */
+static int DisplayWidth(const char *string) {
+    // 显示宽度
+    int width = 0;
+
+    for (; *string; string++) {
+        if (((unsigned char)*string & 0x80) == 0) {
+            width++;
+        } else if (((unsigned char)*string & 0xC0) == 0xC0) {
+            width += 2;
+        }
+    }
+
+    return width;
+}
+
+/**
+ * 帧缓冲区中已有的行数
+ *
+ * @param buffer            帧缓冲区指针
+ * @return                  换行符个数
+ */
+static int CountLines(FrameBuffer *buffer) {
+    // 换行符个数
+    int lines = 0;
+    // 字节下标
+    size_t i;
+
+    for (i = 0; i < buffer->length; i++) {
+        lines += buffer->data[i] == '\n';
+    }
+
+    return lines;
+}
+
+/**
+ * 追加光标定位序列
+ *
+ * @param buffer            帧缓冲区指针
+ * @param line              行号（从1开始）
+ * @param column            列号（从1开始）
+ */
+static void AppendCursorPosition(FrameBuffer *buffer, int line, int column) {
+    // 定位序列
+    char text[32];
+    // 字节数
+    int length = snprintf(text, sizeof(text), "\033[%d;%dH", line, column);
+
+    AppendBytes(buffer, text, (size_t)length);
+}
+
+/**
+ * 初始化渲染器
+ *
+ * @param renderer          渲染器指针
+ */
+void InitializeRenderer(Renderer *renderer) {
+    renderer->buffer.data = NULL;
+    renderer->buffer.length = 0;
+    renderer->buffer.capacity = 0;
+    renderer->blocks = NULL;
+    renderer->map = NULL;
+    renderer->viewport.top = 0;
+    renderer->viewport.left = 0;
+    renderer->viewport.rows = 0;
+    renderer->viewport.columns = 0;
+    renderer->terminal_lines = 0;
+    renderer->terminal_columns = 0;
+    renderer->is_overview = 0;
+    renderer->is_drawn = 0;
+}
+
+/**
+ * 销毁渲染器
+ *
+ * @param renderer          渲染器指针
+ */
+void DestroyRenderer(Renderer *renderer) {
+    DestroyFrameBuffer(&renderer->buffer);
+    free(renderer->blocks);
+    renderer->blocks = NULL;
+    renderer->map = NULL;
+    renderer->is_drawn = 0;
+}
+
+/**
+ * 根据终端大小计算视口的行数和列数，并将视口限制在地图范围内
+ *
+ * 地图行数较少、放不下完整的操作说明时改为显示精简的操作说明
+ *
+ * @param renderer          渲染器指针
+ * @param map               地图指针
+ */
+static void FitViewport(Renderer *renderer, Map *map) {
+    // 视口
+    Viewport *viewport = &renderer->viewport;
+    // 完整显示操作说明时能容纳的行数
+    int rows;
+
+    GetTerminalSize(&renderer->terminal_lines, &renderer->terminal_columns);
+
+    rows = (renderer->terminal_lines - GAME_SCREEN_FIXED_LINES) / 2;
+    renderer->is_help_compact = rows < map->number_of_rows && rows < MIN_VIEWPORT_ROWS_WITH_HELP;
+    if (renderer->is_help_compact) {
+        rows = (renderer->terminal_lines - GAME_SCREEN_FIXED_LINES + COMPACT_HELP_SAVED_LINES) / 2;
+    }
+
+    viewport->rows = rows < 1 ? 1 : (rows > map->number_of_rows ? map->number_of_rows : rows);
+    viewport->columns = FitMapColumns(map, renderer->terminal_columns);
+    ClampViewport(viewport, map);
+}
+
+/**
+ * 将视口移动到以指定方块为中心的位置
+ *
+ * @param renderer          渲染器指针
+ * @param map               地图指针
+ * @param row               行下标
+ * @param column            列下标
+ */
+void CenterViewport(Renderer *renderer, Map *map, int row, int column) {
+    FitViewport(renderer, map);
+    renderer->viewport.top = row - renderer->viewport.rows / 2;
+    renderer->viewport.left = column - renderer->viewport.columns / 2;
+    ClampViewport(&renderer->viewport, map);
+}
+
+/**
+ * 将视口滚动指定的行数和列数
+ *
+ * @param renderer          渲染器指针
+ * @param map               地图指针
+ * @param rows              滚动的行数，负数表示向上
+ * @param columns           滚动的列数，负数表示向左
+ */
+void ScrollViewport(Renderer *renderer, Map *map, int rows, int columns) {
+    FitViewport(renderer, map);
+    // 先限制滚动量，避免下标溢出
+    rows = rows > map->number_of_rows ? map->number_of_rows : (rows < -map->number_of_rows ? -map->number_of_rows : rows);
+    columns = columns > map->number_of_columns ? map->number_of_columns : (columns < -map->number_of_columns ? -map->number_of_columns : columns);
+    renderer->viewport.top += rows;
+    renderer->viewport.left += columns;
+    ClampViewport(&renderer->viewport, map);
+}
+
+/**
+ * 必要时滚动视口，使指定方块可见
+ *
+ * 方块已在视口内时视口不变，否则只滚动到方块刚好可见
+ *
+ * @param renderer          渲染器指针
+ * @param map               地图指针
+ * @param row               行下标，超出地图范围时视口不变
+ * @param column            列下标，超出地图范围时视口不变
+ */
+void FollowViewport(Renderer *renderer, Map *map, int row, int column) {
+    // 视口
+    Viewport *viewport = &renderer->viewport;
+
+    if (row < 0 || row >= map->number_of_rows || column < 0 || column >= map->number_of_columns) {
+        return;
+    }
+
+    FitViewport(renderer, map);
+    if (row < viewport->top) {
+        viewport->top = row;
+    } else if (row >= viewport->top + viewport->rows) {
+        viewport->top = row - viewport->rows + 1;
+    }
+    if (column < viewport->left) {
+        viewport->left = column;
+    } else if (column >= viewport->left + viewport->columns) {
+        viewport->left = column - viewport->columns + 1;
+    }
+}
+
+/**
+ * 切换地图和总览图
+ *
+ * @param renderer          渲染器指针
+ * @param is_overview       是否显示总览图
+ */
+void SetOverview(Renderer *renderer, _Bool is_overview) {
+    if (renderer->is_overview != is_overview) {
+        renderer->is_overview = is_overview;
+        renderer->is_drawn = 0;
+    }
+}
+
+/**
+ * 追加一个统计字段，并记录其在屏幕上的位置
+ *
+ * @param renderer          渲染器指针
+ * @param line              当前行号
+ * @param column            当前列号指针，追加后前移
+ * @param field             字段序号
+ * @param label             标签
+ * @param conversion        转换说明
+ * @param value             值
+ */
+static void AppendStatField(Renderer *renderer, int line, int *column, int field, const char *label, const char *conversion, long long value) {
+    // 统计字段
+    StatField *stat = &renderer->stats[field];
+
+    AppendString(&renderer->buffer, label);
+    *column += DisplayWidth(label);
+
+    AppendString(&renderer->buffer, HIGHLIGHT_STYLE);
+    stat->line = line;
+    stat->column = *column;
+    stat->conversion = conversion;
+    stat->value = value;
+    stat->width = AppendInteger(&renderer->buffer, conversion, value);
+    AppendString(&renderer->buffer, CLEAR_STYLE);
+    *column += stat->width;
+}
+
+/**
+ * 地图的统计数据
+ *
+ * @param map               地图指针
+ * @param values            统计数据数组
+ */
+static void CollectStats(Map *map, long long values[NUMBER_OF_STAT_FIELDS]) {
+    values[STAT_FIELD_ROWS] = map->number_of_rows;
+    values[STAT_FIELD_COLUMNS] = map->number_of_columns;
+    values[STAT_FIELD_BLOCKS] = map->number_of_blocks;
+    values[STAT_FIELD_MINES] = map->number_of_mines;
+    values[STAT_FIELD_VISIBLE_BLOCKS] = map->number_of_visible_blocks;
+    values[STAT_FIELD_INVISIBLE_BLOCKS] = map->number_of_invisible_blocks;
+    values[STAT_FIELD_FLAGS] = map->number_of_flags;
+    values[STAT_FIELD_DOUBTS] = map->number_of_doubts;
+}
+
+/**
+ * 完整绘制游戏过程界面，并记录各部分在屏幕上的位置
+ *
+ * @param renderer          渲染器指针
+ * @param map               地图指针
+ */
+static void DrawGameScreen(Renderer *renderer, Map *map) {
+    // 帧缓冲区
+    FrameBuffer *buffer = &renderer->buffer;
+    // 行编号输出宽度
+    int row_number_width;
+    // 列编号输出宽度
+    int column_number_width;
+    // 居中前导空格数
+    int center_prefix_space_number;
+    // 统计数据
+    long long values[NUMBER_OF_STAT_FIELDS];
+    // 当前行号、列号
+    int line, column;
+    // 行下标
+    int row;
+    // 视口
+    Viewport *viewport = &renderer->viewport;
+    // 随机数种子的十进制文本：种子是64位无符号整数，不经过AppendInteger的long long参数
+    char seed_text[24];
+
+    // 清屏并回到左上角
+    AppendString(buffer, CLEAR_SCREEN);
+
+    AppendString(buffer, TITLE_STYLE "                                   [  扫雷  ]                                   \n" CLEAR_STYLE);
+    AppendString(buffer, "\n");
+
+    // 视口小于地图时显示视口范围
+    if (viewport->rows < map->number_of_rows || viewport->columns < map->number_of_columns) {
+        AppendString(buffer, "    视口: 行 " HIGHLIGHT_STYLE);
+        AppendInteger(buffer, "%lld", viewport->top + 1);
+        AppendString(buffer, " ~ ");
+        AppendInteger(buffer, "%lld", viewport->top + viewport->rows);
+        AppendString(buffer, CLEAR_STYLE " / ");
+        AppendInteger(buffer, "%lld", map->number_of_rows);
+        AppendString(buffer, "，列 " HIGHLIGHT_STYLE);
+        AppendInteger(buffer, "%lld", viewport->left + 1);
+        AppendString(buffer, " ~ ");
+        AppendInteger(buffer, "%lld", viewport->left + viewport->columns);
+        AppendString(buffer, CLEAR_STYLE " / ");
+        AppendInteger(buffer, "%lld", map->number_of_columns);
+    }
+    AppendString(buffer, "\n");
+
+    // 地图：表头占2行，之后每个方块行后跟1行标尺线
+    ComputeMapLayout(map, viewport->columns, renderer->terminal_columns, &row_number_width, &column_number_width, &center_prefix_space_number);
+    renderer->map_line = CountLines(buffer) + 1 + 2;
+    renderer->map_column = (center_prefix_space_number > 0 ? center_prefix_space_number : 0)
+                           + row_number_width + 1 + 1 + ((column_number_width - 1) / 2 - 1 > 0 ? (column_number_width - 1) / 2 - 1 : 0) + 1;
+    renderer->cell_width = 1 + column_number_width;
+    if (renderer->is_overview) {
+        // 总览图占用与地图相同的行数，不影响界面其余部分的位置
+        RenderOverview(buffer, map, viewport, 2 + viewport->rows * 2, renderer->terminal_columns);
+    } else {
+        RenderMap(buffer, map, viewport, renderer->terminal_columns);
+    }
+
+    AppendString(buffer, "\n\n");
+
+    // 统计信息
+    AppendString(buffer, SUBTITLE_STYLE "[ 统计信息 ]\n" CLEAR_STYLE);
+    CollectStats(map, values);
+
+    line = CountLines(buffer) + 1;
+    column = 1 + 4;
+    AppendString(buffer, "    ");
+    AppendStatField(renderer, line, &column, STAT_FIELD_ROWS, "行数: ", "%-13lld", values[STAT_FIELD_ROWS]);
+    AppendStatField(renderer, line, &column, STAT_FIELD_COLUMNS, "列数: ", "%-13lld", values[STAT_FIELD_COLUMNS]);
+    AppendStatField(renderer, line, &column, STAT_FIELD_BLOCKS, "方块总数: ", "%-9lld", values[STAT_FIELD_BLOCKS]);
+    AppendStatField(renderer, line, &column, STAT_FIELD_MINES, "地雷数: ", "%-11lld", values[STAT_FIELD_MINES]);
+    AppendString(buffer, "\n");
+
+    line++;
+    column = 1 + 4;
+    AppendString(buffer, "    ");
+    AppendStatField(renderer, line, &column, STAT_FIELD_VISIBLE_BLOCKS, "已翻开方块数: ", "%-5lld", values[STAT_FIELD_VISIBLE_BLOCKS]);
+    AppendStatField(renderer, line, &column, STAT_FIELD_INVISIBLE_BLOCKS, "未翻开方块数: ", "%-5lld", values[STAT_FIELD_INVISIBLE_BLOCKS]);
+    AppendStatField(renderer, line, &column, STAT_FIELD_FLAGS, "旗标数: ", "%-11lld", values[STAT_FIELD_FLAGS]);
+    AppendStatField(renderer, line, &column, STAT_FIELD_DOUBTS, "疑问标数: ", "%-9lld", values[STAT_FIELD_DOUBTS]);
+    AppendString(buffer, "\n");
+
+    AppendString(buffer, "    随机数种子: " HIGHLIGHT_STYLE);
+    snprintf(seed_text, sizeof(seed_text), "%llu", (unsigned long long)map->seed);
+    AppendString(buffer, seed_text);
+    AppendString(buffer, CLEAR_STYLE "\n\n");
+
+    // 操作说明
+    if (renderer->is_help_compact) {
+        AppendString(buffer, "    " HIGHLIGHT_STYLE "行 列 指令" CLEAR_STYLE "  V翻开 F旗标 ?疑问 C清除 G跳转 M滚动 O总览 A解机\n");
+    } else {
+        AppendString(buffer, SUBTITLE_STYLE "[ 操作说明 ]\n" CLEAR_STYLE);
+        AppendString(buffer, "    命令行格式：\n");
+        AppendString(buffer, "        " HIGHLIGHT_STYLE "行编号 列编号 方块操作指令\n" CLEAR_STYLE);
+        AppendString(buffer, "    方块操作指令：\n");
+        AppendString(buffer, "        " HIGHLIGHT_STYLE "V" CLEAR_STYLE ": 将一个未翻开的方块翻开\n");
+        AppendString(buffer, "        " HIGHLIGHT_STYLE "F" CLEAR_STYLE ": 对一个未翻开的方块设置小旗标记，表示此处确定有地雷\n");
+        AppendString(buffer, "        " HIGHLIGHT_STYLE "?" CLEAR_STYLE ": 对一个未翻开的方块设置疑问标记，表示此处可能有地雷\n");
+        AppendString(buffer, "        " HIGHLIGHT_STYLE "C" CLEAR_STYLE ": 清除一个未翻开的方块上的任何标记\n");
+        AppendString(buffer, "        " HIGHLIGHT_STYLE "G" CLEAR_STYLE ": 将视口移动到以该方块为中心的位置\n");
+        AppendString(buffer, "        " HIGHLIGHT_STYLE "M" CLEAR_STYLE ": 将视口滚动指定的行数和列数，此时行编号和列编号表示滚动量\n");
+        AppendString(buffer, "        " HIGHLIGHT_STYLE "O" CLEAR_STYLE ": 切换地图和总览图，此时行编号和列编号不起作用\n");
+        AppendString(buffer, "        " HIGHLIGHT_STYLE "A" CLEAR_STYLE ": 自动翻开和标记所有能根据数字确定的方块，此时行编号和列编号不起作用\n");
+        AppendString(buffer, "    可同时输入多个完整的命令行\n");
+    }
+    AppendString(buffer, "\n");
+    AppendString(buffer, SEPARATOR);
+
+    // 输入提示所在行
+    renderer->prompt_line = CountLines(buffer) + 1;
+
+    // 记录已绘制的视口和方块
+    for (row = 0; row < viewport->rows; row++) {
+        memcpy(renderer->blocks + (size_t)row * viewport->columns, &BLOCK_AT(map, viewport->top + row, viewport->left), (size_t)viewport->columns);
+    }
+    renderer->drawn_viewport = *viewport;
+    renderer->map = map;
+    renderer->is_drawn = 1;
+}
+
+/**
+ * 绘制游戏过程界面
+ *
+ * 第一次绘制时输出完整画面；之后只对状态发生变化的方块和统计字段
+ * 输出光标定位序列和新内容，最后把光标移到输入提示行并清除其下方的旧输入。
+ * 整个画面通过一次write写入终端，不再调用外部命令清屏。
+ * 地图只绘制视口内的方块，视口移动或终端大小改变时完整重绘。
+ *
+ * @param renderer          渲染器指针
+ * @param map               地图指针
+ */
+void RenderGameScreen(Renderer *renderer, Map *map) {
+    // 帧缓冲区
+    FrameBuffer *buffer = &renderer->buffer;
+    // 统计数据
+    long long values[NUMBER_OF_STAT_FIELDS];
+    // 行下标
+    int row;
+    // 列下标
+    int column;
+    // 字段序号
+    int field;
+    // 当前行的方块、上次绘制的方块
+    Block *current, *previous;
+    // 方块显示内容
+    const char *glyph;
+    // 方块显示内容字节数
+    size_t glyph_length;
+    // 格式化结果
+    char text[64];
+    // 视口
+    Viewport *viewport = &renderer->viewport;
+    // 上次绘制时的终端大小
+    int drawn_lines = renderer->terminal_lines, drawn_columns = renderer->terminal_columns;
+    // 是否需要完整重绘
+    _Bool is_full = ! renderer->is_drawn || renderer->map != map;
+
+    FitViewport(renderer, map);
+    // 总览图每次完整重绘，开销与屏幕大小成正比
+    is_full = is_full || renderer->is_overview
+              || renderer->terminal_lines != drawn_lines || renderer->terminal_columns != drawn_columns
+              || viewport->top != renderer->drawn_viewport.top || viewport->left != renderer->drawn_viewport.left
+              || viewport->rows != renderer->drawn_viewport.rows || viewport->columns != renderer->drawn_viewport.columns;
+
+    // 检查统计字段是否变宽，变宽会使同一行后面的字段移位，需要完整重绘
+    CollectStats(map, values);
+    for (field = 0; ! is_full && field < NUMBER_OF_STAT_FIELDS; field++) {
+        if (values[field] != renderer->stats[field].value
+            && snprintf(text, sizeof(text), renderer->stats[field].conversion, values[field]) > renderer->stats[field].width) {
+            is_full = 1;
+        }
+    }
+
+    if (is_full) {
+        free(renderer->blocks);
+        renderer->blocks = (Block *)malloc((size_t)viewport->rows * (size_t)viewport->columns);
+        if (! renderer->blocks) {
+            renderer->is_drawn = 0;
+            return;
+        }
+        DrawGameScreen(renderer, map);
+    } else {
+        // 只重绘视口内发生变化的方块
+        for (row = 0; row < viewport->rows; row++) {
+            current = &BLOCK_AT(map, viewport->top + row, viewport->left);
+            previous = renderer->blocks + (size_t)row * viewport->columns;
+            if (memcmp(current, previous, (size_t)viewport->columns) == 0) {
+                continue;
+            }
+            for (column = 0; column < viewport->columns; column++) {
+                if (current[column] != previous[column]) {
+                    glyph = BlockGlyph(current[column], &glyph_length);
+                    AppendCursorPosition(buffer, renderer->map_line + row * 2, renderer->map_column + column * renderer->cell_width);
+                    AppendBytes(buffer, glyph, glyph_length);
+                    previous[column] = current[column];
+                }
+            }
+        }
+
+        // 只重绘发生变化的统计字段
+        for (field = 0; field < NUMBER_OF_STAT_FIELDS; field++) {
+            if (values[field] != renderer->stats[field].value) {
+                AppendCursorPosition(buffer, renderer->stats[field].line, renderer->stats[field].column);
+                AppendString(buffer, HIGHLIGHT_STYLE);
+                // 左对齐输出，不足原宽度时用空格覆盖旧内容
+                snprintf(text, sizeof(text), renderer->stats[field].conversion, values[field]);
+                AppendString(buffer, text);
+                AppendRepeat(buffer, ' ', renderer->stats[field].width - (int)strlen(text));
+                AppendString(buffer, CLEAR_STYLE);
+                renderer->stats[field].value = values[field];
+            }
+        }
+    }
+
+    // 光标移到输入提示行，清除其下方的旧输入和错误信息
+    AppendCursorPosition(buffer, renderer->prompt_line, 1);
+    AppendString(buffer, "\033[J");
+
+    FlushFrameBuffer(buffer);
+}
@@ -0,0 +1,153 @@
+/**
+ * ----------------------------------------------------------------------------
+ * [头文件] 渲染
+ * ----------------------------------------------------------------------------
+ *
+ * 定义帧缓冲区和地图渲染的数据结构和函数原型
+ *
+ */
+
+
+#ifndef MINESWEEPING_RENDER_H
+#define MINESWEEPING_RENDER_H
+
+#include <stddef.h>
+
+#include "screen.h"
+
+/*
+ * 数据结构定义
+ */
+
+// 结构体：帧缓冲区
+typedef struct {
+    // 数据
+    char *data;
+    // 已用字节数
+    size_t length;
+    // 容量
+    size_t capacity;
+} FrameBuffer;
+
+// 结构体：视口，即地图中显示在屏幕上的矩形区域
+typedef struct {
+    // 第一行的行下标
+    int top;
+    // 第一列的列下标
+    int left;
+    // 行数
+    int rows;
+    // 列数
+    int columns;
+} Viewport;
+
+// 枚举：统计字段
+typedef enum {
+    // 行数
+    STAT_FIELD_ROWS,
+    // 列数
+    STAT_FIELD_COLUMNS,
+    // 方块总数
+    STAT_FIELD_BLOCKS,
+    // 地雷数
+    STAT_FIELD_MINES,
+    // 已翻开方块数
+    STAT_FIELD_VISIBLE_BLOCKS,
+    // 未翻开方块数
+    STAT_FIELD_INVISIBLE_BLOCKS,
+    // 旗标数
+    STAT_FIELD_FLAGS,
+    // 疑问标数
+    STAT_FIELD_DOUBTS,
+    // 字段个数
+    NUMBER_OF_STAT_FIELDS,
+} StatFieldIndex;
+
+// 结构体：统计字段
+typedef struct {
+    // 屏幕行号（从1开始）
+    int line;
+    // 屏幕列号（从1开始）
+    int column;
+    // 转换说明
+    const char *conversion;
+    // 上次绘制的值
+    long long value;
+    // 上次完整绘制时占用的宽度
+    int width;
+} StatField;
+
+// 结构体：渲染器，记录上次绘制的画面，用于差异重绘
+typedef struct {
+    // 帧缓冲区
+    FrameBuffer buffer;
+    // 上次绘制的地图
+    Map *map;
+    // 上次绘制的视口内的方块，按行优先存放
+    Block *blocks;
+    // 视口，行数和列数由终端大小决定
+    Viewport viewport;
+    // 上次绘制的视口
+    Viewport drawn_viewport;
+    // 终端行数、列数
+    int terminal_lines, terminal_columns;
+    // 是否只显示精简的操作说明
+    _Bool is_help_compact;
+    // 是否用总览图代替地图
+    _Bool is_overview;
+    // 第一行方块所在的屏幕行号
+    int map_line;
+    // 第一列方块显示内容所在的屏幕列号
+    int map_column;
+    // 相邻两列方块的屏幕列距
+    int cell_width;
+    // 统计字段
+    StatField stats[NUMBER_OF_STAT_FIELDS];
+    // 输入提示所在的屏幕行号
+    int prompt_line;
+    // 是否已完整绘制过
+    _Bool is_drawn;
+} Renderer;
+
+/*
+ * 函数原型
+ */
+
+// 追加字节
+void AppendBytes(FrameBuffer *buffer, const char *bytes, size_t length);
+// 追加字符串
+void AppendString(FrameBuffer *buffer, const char *string);
+// 追加若干个相同字符
+void AppendRepeat(FrameBuffer *buffer, char character, int count);
+// 追加格式化的整数
+int AppendInteger(FrameBuffer *buffer, const char *conversion, long long value);
+// 将帧缓冲区一次性写入标准输出，并清空缓冲区
+void FlushFrameBuffer(FrameBuffer *buffer);
+// 释放帧缓冲区
+void DestroyFrameBuffer(FrameBuffer *buffer);
+// 方块的显示内容（含样式）
+const char * BlockGlyph(Block block, size_t *length);
+// 获取终端大小
+void GetTerminalSize(int *lines, int *columns);
+// 将地图的一个窗口渲染到帧缓冲区
+void RenderMap(FrameBuffer *buffer, Map *map, const Viewport *window, int console_width);
+// 将地图的总览图渲染到帧缓冲区
+void RenderOverview(FrameBuffer *buffer, Map *map, const Viewport *viewport, int lines, int console_width);
+// 打印以指定方块为中心、适合终端大小的地图窗口
+void PrintMap(Map *map, int row, int column);
+// 初始化渲染器
+void InitializeRenderer(Renderer *renderer);
+// 销毁渲染器
+void DestroyRenderer(Renderer *renderer);
+// 绘制游戏过程界面
+void RenderGameScreen(Renderer *renderer, Map *map);
+// 将视口移动到以指定方块为中心的位置
+void CenterViewport(Renderer *renderer, Map *map, int row, int column);
+// 将视口滚动指定的行数和列数
+void ScrollViewport(Renderer *renderer, Map *map, int rows, int columns);
+// 必要时滚动视口，使指定方块可见
+void FollowViewport(Renderer *renderer, Map *map, int row, int column);
+// 切换地图和总览图
+void SetOverview(Renderer *renderer, _Bool is_overview);
+
+#endif //MINESWEEPING_RENDER_H
@@ -0,0 +1,344 @@
+/**
+ * ----------------------------------------------------------------------------
+ * [源文件] 界面
+ * ----------------------------------------------------------------------------
+ *
+ * 定义终端界面的各个函数
+ *
+ * 界面只通过游戏引擎的接口创建地图、处理方块和查询结果，引擎本身不做任何输入输出
+ *
+ */
+
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "screen.h"
+#include "render.h"
+#include "solver.h"
+
+
+/**
+ * 检查scanf的返回值
+ *
+ * 输入结束时退出程序；转换失败时丢弃本行剩余的输入，避免同一个错误的记号被反复读取
+ *
+ * @param count             scanf的返回值
+ * @param expected          应转换的项数
+ * @return                  是否全部转换成功
+ */
+static _Bool CheckInput(int count, int expected) {
+    // 读取的字符
+    int character;
+
+    if (count == EOF) {
+        printf(CLEAR_STYLE "\n");
+        exit(0);
+    }
+
+    if (count != expected) {
+        do {
+            character = getchar();
+        } while (character != '\n' && character != EOF);
+        return 0;
+    }
+
+    return 1;
+}
+
+/**
+ * 游戏开始界面：选择难度，确定行数、列数和地雷数
+ *
+ * @param selected_rows     行数指针
+ * @param selected_columns  列数指针
+ * @param selected_mines    地雷数指针
+ */
+void GameStartScreen(int *selected_rows, int *selected_columns, int *selected_mines) {
+    // 行数
+    int rows;
+    // 列数
+    int columns;
+    // 地雷数
+    int mines;
+    // 难度
+    GameDifficulty difficulty;
+    // 最小数
+    int min;
+    // 最大数
+    int max;
+    // 输入是否正确
+    _Bool is_valid;
+
+    // 清空控制台
+    printf(CLEAR_SCREEN);
+
+    // 输出难度信息
+    printf(TITLE_STYLE);
+    printf("                                   [  扫雷  ]                                   \n");
+    printf(CLEAR_STYLE);
+
+    printf("\n\n");
+
+    printf(SUBTITLE_STYLE);
+    printf("[ 难度 ]\n");
+    printf(CLEAR_STYLE);
+
+    printf("\n");
+
+    printf("    %d. 初级（ 9行 x  9列，10个地雷）\n", GAME_DIFFICULTY_LOW);
+    printf("    %d. 中级（16行 x 16列，40个地雷）\n", GAME_DIFFICULTY_MIDDLE);
+    printf("    %d. 高级（16行 x 30列，99个地雷）\n", GAME_DIFFICULTY_HIGH);
+    printf("    %d. 自定义\n", GAME_DIFFICULTY_CUSTOMIZED);
+
+    printf("\n");
+
+    printf(SEPARATOR);
+
+    // 选择难度
+    do {
+        printf(INPUT_PROMPT_STYLE);
+        printf("请选择难度：");
+        printf(CLEAR_STYLE);
+
+        printf(INPUT_STYLE);
+        is_valid = CheckInput(scanf("%d", (int *)&difficulty), 1);
+        printf(CLEAR_STYLE);
+
+        is_valid = is_valid && difficulty >= GAME_DIFFICULTY_CUSTOMIZED && difficulty <= GAME_DIFFICULTY_HIGH;
+
+        if (! is_valid) {
+            printf(ERROR_MESSAGE_STYLE);
+            printf("请输入正确的编号！\n");
+            printf(CLEAR_STYLE);
+        }
+    } while (! is_valid);
+
+    // 确定行数、列数和地雷数
+    // 预设难度
+    if (difficulty != GAME_DIFFICULTY_CUSTOMIZED) {
+        GetDifficultySize(difficulty, &rows, &columns, &mines);
+    }
+    // 自定义难度
+    else {
+        // 输入行数
+        do {
+            printf(INPUT_PROMPT_STYLE);
+            printf("行数：");
+            printf(CLEAR_STYLE);
+
+            printf(INPUT_STYLE);
+            is_valid = CheckInput(scanf("%d", &rows), 1);
+            printf(CLEAR_STYLE);
+
+            // 行数至少为2，方块表（含哨兵方块）不能超过最大方块数
+            min = 2;
+            max = MAX_BLOCK_TABLE_SIZE / 4 - 2;
+            is_valid = is_valid && rows >= min && rows <= max;
+
+            if (! is_valid) {
+                printf(ERROR_MESSAGE_STYLE);
+                printf("行数范围：%d ~ %d！\n", min, max);
+                printf(CLEAR_STYLE);
+            }
+        } while (! is_valid);
+
+        // 输入列数
+        do {
+            printf(INPUT_PROMPT_STYLE);
+            printf("列数：");
+            printf(CLEAR_STYLE);
+
+            printf(INPUT_STYLE);
+            is_valid = CheckInput(scanf("%d", &columns), 1);
+            printf(CLEAR_STYLE);
+
+            min = 2;
+            max = MAX_BLOCK_TABLE_SIZE / (rows + 2) - 2;
+            is_valid = is_valid && columns >= min && columns <= max;
+
+            if (! is_valid) {
+                printf(ERROR_MESSAGE_STYLE);
+                printf("列数范围：%d ~ %d！\n", min, max);
+                printf(CLEAR_STYLE);
+            }
+        } while (! is_valid);
+
+        // 输入地雷数
+        do {
+            printf(INPUT_PROMPT_STYLE);
+            printf("地雷数：");
+            printf(CLEAR_STYLE);
+
+            printf(INPUT_STYLE);
+            is_valid = CheckInput(scanf("%d", &mines), 1);
+            printf(CLEAR_STYLE);
+
+            // 合格条件：地雷数≥1，地雷比率≥5%，且≤90%
+            min = (int)((double)rows * columns * 0.05) >= 1 ? (int)((double)rows * columns * 0.05) : 1;
+            max = (int)((double)rows * columns * 0.90) >= 1 ? (int)((double)rows * columns * 0.90) : 1;
+            is_valid = is_valid && mines >= min && mines <= max;
+
+            if (! is_valid) {
+                printf(ERROR_MESSAGE_STYLE);
+                printf("地雷数范围：%d ~ %d！\n", min, max);
+                printf(CLEAR_STYLE);
+            }
+        } while (! is_valid);
+    }
+
+    *selected_rows = rows;
+    *selected_columns = columns;
+    *selected_mines = mines;
+}
+
+/**
+ * 游戏过程界面
+ *
+ * @param game              游戏指针
+ */
+void GameProcessScreen(Game *game) {
+    // 行编号
+    int row;
+    // 列编号
+    int column;
+    // 操作指令
+    char directive[100];
+    // 方块目标状态
+    BlockStatus status;
+    // 输入是否正确
+    _Bool is_valid;
+    // 是否为视口操作指令
+    _Bool is_viewport_directive;
+    // 是否为解机指令
+    _Bool is_solver_directive;
+    // 渲染器
+    Renderer renderer;
+    // 解机，第一次使用时创建
+    Solver *solver = NULL;
+
+    InitializeRenderer(&renderer);
+    // 总览图依赖密度金字塔，内存不足时总览图只显示提示
+    EnablePyramid(game->map);
+
+    // 当游戏未结束时一直执行
+    while (! game->is_finished) {
+        // 绘制界面，第一次完整绘制，之后只重绘发生变化的部分
+        RenderGameScreen(&renderer, game->map);
+
+        do {
+            printf(INPUT_PROMPT_STYLE);
+            printf("命令行：");
+            printf(CLEAR_STYLE);
+
+            printf(INPUT_STYLE);
+            is_valid = CheckInput(scanf("%d%d%99s", &row, &column, directive), 3);
+            printf(CLEAR_STYLE);
+
+            is_viewport_directive = 0;
+            is_solver_directive = 0;
+            if (! is_valid) {
+                // 格式错误，本行剩余的输入已丢弃
+            } else if (strcmp(directive, "V") == 0 || strcmp(directive, "v") == 0) {
+                is_valid = 1;
+                status = BLOCK_STATUS_VISIBLE;
+            } else if (strcmp(directive, "F") == 0 || strcmp(directive, "f") == 0) {
+                is_valid = 1;
+                status = BLOCK_STATUS_FLAG;
+            } else if (strcmp(directive, "?") == 0) {
+                is_valid = 1;
+                status = BLOCK_STATUS_DOUBT;
+            } else if (strcmp(directive, "C") == 0 || strcmp(directive, "c") == 0) {
+                is_valid = 1;
+                status = BLOCK_STATUS_INVISIBLE;
+            } else if (strcmp(directive, "G") == 0 || strcmp(directive, "g") == 0) {
+                is_valid = 1;
+                is_viewport_directive = 1;
+                SetOverview(&renderer, 0);
+                CenterViewport(&renderer, game->map, row - 1, column - 1);
+            } else if (strcmp(directive, "M") == 0 || strcmp(directive, "m") == 0) {
+                is_valid = 1;
+                is_viewport_directive = 1;
+                ScrollViewport(&renderer, game->map, row, column);
+            } else if (strcmp(directive, "O") == 0 || strcmp(directive, "o") == 0) {
+                is_valid = 1;
+                is_viewport_directive = 1;
+                SetOverview(&renderer, ! renderer.is_overview);
+            } else if (strcmp(directive, "A") == 0 || strcmp(directive, "a") == 0) {
+                is_valid = 1;
+                is_solver_directive = 1;
+            } else {
+                is_valid = 0;
+            }
+
+            if (! is_valid) {
+                printf(ERROR_MESSAGE_STYLE);
+                printf("请输入正确的命令行！\n");
+                printf(CLEAR_STYLE);
+            }
+        } while (! is_valid);
+
+        // 视口操作指令不改变地图，直接重绘
+        if (is_viewport_directive) {
+            continue;
+        }
+
+        // 解机连续走完所有能确定的步，视口跟随最后一步
+        if (is_solver_directive) {
+            if (solver || (solver = CreateSolver(game))) {
+                RunSolver(solver);
+            }
+            FollowViewport(&renderer, game->map, game->last_row, game->last_column);
+            continue;
+        }
+
+        // 处理方块并计算游戏结果，使方块保持在视口内
+        PlayMove(game, row - 1, column - 1, status);
+        FollowViewport(&renderer, game->map, row - 1, column - 1);
+    }
+
+    if (solver) {
+        DestroySolver(&solver);
+    }
+    DestroyRenderer(&renderer);
+}
+
+/**
+ * 游戏结束界面
+ *
+ * @param game              游戏指针
+ */
+void GameEndScreen(Game *game) {
+    // 清空控制台
+    printf(CLEAR_SCREEN);
+
+    // 输出结果信息
+    printf(TITLE_STYLE);
+    printf("                                   [  扫雷  ]                                   \n");
+    printf(CLEAR_STYLE);
+
+    printf("\n\n");
+
+    if (game->is_winning) {
+        printf("                       ");
+        printf(VICTORY_STYLE);
+        printf("恭喜，您已扫出所有地雷，游戏胜利！\n");
+        printf(CLEAR_STYLE);
+    } else {
+        printf("                        ");
+        printf(DEFEAT_STYLE);
+        printf("很遗憾，您踩到了地雷，游戏失败！\n");
+        printf(CLEAR_STYLE);
+    }
+
+    printf("\n");
+
+    printf(SEPARATOR);
+
+    printf("\n");
+
+    // 显示最后一次操作的方块附近的地图
+    PrintMap(game->map, game->last_row, game->last_column);
+
+    printf("\n\n");
+}
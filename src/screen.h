@@ -0,0 +1,74 @@
+/**
+ * ----------------------------------------------------------------------------
+ * [头文件] 界面
+ * ----------------------------------------------------------------------------
+ *
+ * 定义终端界面的样式和函数原型
+ *
+ */
+
+
+#ifndef MINESWEEPING_SCREEN_H
+#define MINESWEEPING_SCREEN_H
+
+#include "game.h"
+
+/*
+ * 宏定义
+ */
+
+// 控制台宽度（无法获取终端大小时使用）
+#define CONSOLE_WIDTH 80
+// 控制台高度（无法获取终端大小时使用）
+#define CONSOLE_HEIGHT 24
+
+// 标题样式
+#define TITLE_STYLE           "\033[47;30;01m"
+// 副标题样式
+#define SUBTITLE_STYLE        "\033[47;30m"
+// 输入提示样式
+#define INPUT_PROMPT_STYLE    "\033[32m"
+// 输入样式
+#define INPUT_STYLE           "\033[32;01m"
+// 错误消息样式
+#define ERROR_MESSAGE_STYLE   "\033[31m"
+// 强调样式
+#define HIGHLIGHT_STYLE       "\033[33;01m"
+// 胜利样式
+#define VICTORY_STYLE         "\033[32;01;05m\a\a\a"
+// 失败样式
+#define DEFEAT_STYLE          "\033[31;01;05m\a"
+// 方块表样式
+#define BLOCK_TABLE_STYLE     ""
+// 不可见方块样式
+#define INVISIBLE_BLOCK_STYLE "\033[44;01m"
+// 旗标方块样式
+#define FLAG_BLOCK_STYLE      "\033[44;37;01m"
+// 疑问标方块样式
+#define DOUBT_BLOCK_STYLE     "\033[44;37;01m"
+// 数字方块样式
+#define NUMBER_BLOCK_STYLE    "\033[34;01m"
+// 地雷方块样式
+#define MINE_BLOCK_STYLE      "\033[41;37;01m"
+// 总览图中视口范围的样式
+#define OVERVIEW_VIEWPORT_STYLE "\033[07m"
+// 清除样式
+#define CLEAR_STYLE           "\033[0m"
+// 清屏并将光标移到左上角
+#define CLEAR_SCREEN          "\033[H\033[2J"
+
+// 分隔线
+#define SEPARATOR             "\033[4m                                                                                \033[0m\n\n"
+
+/*
+ * 函数原型
+ */
+
+// 游戏开始界面：选择难度，确定行数、列数和地雷数
+void GameStartScreen(int *selected_rows, int *selected_columns, int *selected_mines);
+// 游戏过程界面
+void GameProcessScreen(Game *game);
+// 游戏结束界面
+void GameEndScreen(Game *game);
+
+#endif //MINESWEEPING_SCREEN_H
@@ -0,0 +1,488 @@
+/**
+ * ----------------------------------------------------------------------------
+ * [源文件] 模拟
+ * ----------------------------------------------------------------------------
+ *
+ * 定义多线程批量对局模拟的各个函数
+ *
+ * 每个工作线程拥有一段连续的批序号，起止序号打包在一个64位原子整数中：
+ * 线程从起点逐批领取自己的批，做完后从其他线程的终点一侧窃取剩余批的一半，
+ * 领取和窃取都用比较并交换完成，不需要锁。各线程只写自己的统计，结束后再汇总，
+ * 对局之间除了批区间和置换表外不共享任何可写数据，因此速度随核心数近似线性增长。
+ * 置换表中的猜测结果只取决于局面，命中与否不影响对局，结果仍与线程数无关。
+ * 某个线程创建失败时，它的批会被其他线程窃取完，结果不受影响。
+ *
+ */
+
+
+// 使用clock_gettime
+#define _DEFAULT_SOURCE
+
+#include <stdlib.h>
+#include <math.h>
+#include <time.h>
+#include <pthread.h>
+#include <stdatomic.h>
+
+#include "simulation.h"
+#include "game.h"
+#include "random.h"
+#include "solver.h"
+#include "probability.h"
+#include "generator.h"
+#include "transposition.h"
+
+
+// 95%置信区间的正态分位数
+#define SIMULATION_Z 1.959963984540054
+
+// 结构体：工作线程
+typedef struct SimulationWorker {
+    // 批区间：高32位为起点，低32位为终点（不含），独占一个缓存行，避免与其他线程的区间伪共享
+    _Alignas(64) _Atomic uint64_t range;
+    // 模拟参数
+    const SimulationOptions *options;
+    // 各线程共用的置换表，为空时不使用
+    TranspositionCache *cache;
+    // 全部工作线程
+    struct SimulationWorker *workers;
+    // 本线程序号
+    int id;
+    // 本线程的统计
+    SimulationResult result;
+} SimulationWorker;
+
+/**
+ * 单调时钟的当前时间
+ *
+ * @return                  秒
+ */
+static double Now() {
+    // 时间
+    struct timespec now;
+
+    clock_gettime(CLOCK_MONOTONIC, &now);
+
+    return (double)now.tv_sec + (double)now.tv_nsec * 1e-9;
+}
+
+/**
+ * 打包批区间
+ *
+ * @param begin             起点
+ * @param end               终点（不含）
+ * @return                  打包后的区间
+ */
+static uint64_t PackRange(uint64_t begin, uint64_t end) {
+    return begin << 32 | end;
+}
+
+/**
+ * 从自己的区间起点领取一批
+ *
+ * @param worker            工作线程指针
+ * @param batch             批序号指针
+ * @return                  是否领取成功
+ */
+static _Bool TakeBatch(SimulationWorker *worker, uint64_t *batch) {
+    // 区间
+    uint64_t range = atomic_load_explicit(&worker->range, memory_order_relaxed);
+
+    while ((range >> 32) < (range & 0xFFFFFFFFULL)) {
+        if (atomic_compare_exchange_weak(&worker->range, &range, range + ((uint64_t)1 << 32))) {
+            *batch = range >> 32;
+            return 1;
+        }
+    }
+
+    return 0;
+}
+
+/**
+ * 从其他线程的区间终点一侧窃取剩余批的一半，作为自己的新区间
+ *
+ * 自己的区间为空时其他线程不会修改它，因此可以直接写入
+ *
+ * @param worker            工作线程指针
+ * @return                  是否窃取成功
+ */
+static _Bool StealBatches(SimulationWorker *worker) {
+    // 线程数
+    int threads = worker->options->threads;
+    // 序号
+    int i;
+    // 被窃取的线程
+    SimulationWorker *victim;
+    // 区间
+    uint64_t range;
+    // 起点、终点、窃取的批数
+    uint64_t begin, end, half;
+
+    for (i = 1; i < threads; i++) {
+        victim = &worker->workers[(worker->id + i) % threads];
+        range = atomic_load_explicit(&victim->range, memory_order_relaxed);
+        while ((begin = range >> 32) < (end = range & 0xFFFFFFFFULL)) {
+            half = (end - begin + 1) / 2;
+            if (atomic_compare_exchange_weak(&victim->range, &range, PackRange(begin, end - half))) {
+                atomic_store(&worker->range, PackRange(end - half, end));
+                return 1;
+            }
+        }
+    }
+
+    return 0;
+}
+
+/**
+ * 下一步要翻开的方块：概率计算器给出的最安全方块，计算失败时取第一个未翻开的方块
+ *
+ * 结果只取决于可见局面，设置了置换表时按地图的散列值查找和保存，命中次数记在本线程的统计中
+ *
+ * @param engine            概率计算器指针
+ * @param cache             置换表指针，为空时不缓存
+ * @param result            本线程的统计指针
+ * @param row               行下标指针
+ * @param column            列下标指针
+ * @return                  是否找到
+ */
+static _Bool ChooseGuess(ProbabilityEngine *engine, TranspositionCache *cache, SimulationResult *result, int *row, int *column) {
+    // 地图指针
+    Map *map = engine->map;
+    // 置换表的键
+    uint64_t key = map->hash ^ SIMULATION_TRANSPOSITION_TAG;
+    // 置换表的数据字：猜测的方块下标（没有时为-1），其余不用
+    uint64_t data[TRANSPOSITION_DATA_WORDS] = {0};
+    // 猜测的方块下标
+    int index = -1;
+
+    if (cache) {
+        if (ProbeTransposition(cache, key, data)) {
+            result->number_of_cache_hits++;
+            index = (int)(int64_t)data[0];
+            if (index < 0) {
+                return 0;
+            }
+            *row = index / map->stride - 1;
+            *column = index % map->stride - 1;
+            return 1;
+        }
+        result->number_of_cache_misses++;
+    }
+
+    if (ComputeProbabilities(engine) && FindSafestBlock(engine, row, column)) {
+        index = BLOCK_INDEX(map, *row, *column);
+    }
+    for (*row = 0; index < 0 && *row < map->number_of_rows; (*row)++) {
+        for (*column = 0; *column < map->number_of_columns; (*column)++) {
+            if (BLOCK_STATUS_OF(BLOCK_AT(map, *row, *column)) == BLOCK_STATUS_INVISIBLE) {
+                index = BLOCK_INDEX(map, *row, *column);
+                break;
+            }
+        }
+    }
+
+    if (cache) {
+        data[0] = (uint64_t)(int64_t)index;
+        StoreTransposition(cache, key, data);
+    }
+    if (index < 0) {
+        return 0;
+    }
+    *row = index / map->stride - 1;
+    *column = index % map->stride - 1;
+
+    return 1;
+}
+
+/**
+ * 进行一局游戏
+ *
+ * 第一步一定安全：地图中心是地雷时，用由种子导出的新种子重新散布地雷，直到中心不是地雷。
+ * 这相当于在中心安全的布局中均匀抽取，对局仍只取决于种子
+ *
+ * @param game              游戏指针
+ * @param worker            工作线程指针，提供模拟参数、置换表和本线程的统计
+ * @param seed              种子
+ * @param moves             步数指针
+ * @param guesses           猜测步数指针
+ * @return                  是否胜利；内存不足时按失败计
+ */
+static _Bool PlayGame(Game *game, SimulationWorker *worker, uint64_t seed, long long *moves, long long *guesses) {
+    // 模拟参数
+    const SimulationOptions *options = worker->options;
+    // 解机
+    Solver *solver = NULL;
+    // 概率计算器
+    ProbabilityEngine *engine = NULL;
+    // 行下标、列下标
+    int row, column;
+    // 导出重新散布的种子的随机数发生器
+    Random random;
+
+    *moves = 0;
+    *guesses = 0;
+    // 种子为0时自动生成，因此导出的种子都置最低位；种子 + 序号按64位回绕到0时也改用导出的种子
+    SeedRandom(&random, seed);
+    if (seed == 0) {
+        seed = NextRandom(&random) | 1;
+    }
+    if (! StartGame(game, options->rows, options->columns, options->mines, seed)) {
+        return 0;
+    }
+
+    // 第一步翻开地图中心，中心是地雷时重新散布
+    while (GetBlockType(game->map, options->rows / 2, options->columns / 2) == BLOCK_TYPE_MINE) {
+        if (! StartGame(game, options->rows, options->columns, options->mines, NextRandom(&random) | 1)) {
+            return 0;
+        }
+    }
+    PlayMove(game, options->rows / 2, options->columns / 2, BLOCK_STATUS_VISIBLE);
+    (*moves)++;
+
+    solver = CreateSolver(game);
+    engine = CreateProbabilityEngine(game->map);
+    // 地图上的旗标都是解机插的，概率计算器按解机推出的地雷计算
+    if (solver && engine) {
+        engine->known_mines = solver->known_mines;
+    }
+    while (solver && engine && ! game->is_finished) {
+        *moves += RunSolver(solver);
+        if (game->is_finished || ! ChooseGuess(engine, worker->cache, &worker->result, &row, &column)) {
+            break;
+        }
+        PlayMove(game, row, column, BLOCK_STATUS_VISIBLE);
+        (*moves)++;
+        (*guesses)++;
+    }
+
+    if (solver) {
+        DestroySolver(&solver);
+    }
+    if (engine) {
+        DestroyProbabilityEngine(&engine);
+    }
+
+    return game->is_winning;
+}
+
+/**
+ * 工作线程：领取或窃取批，逐局进行并统计
+ *
+ * @param argument          工作线程指针
+ * @return                  空
+ */
+static void * SimulationWorkerMain(void *argument) {
+    // 工作线程
+    SimulationWorker *worker = (SimulationWorker *)argument;
+    // 模拟参数
+    const SimulationOptions *options = worker->options;
+    // 统计
+    SimulationResult *result = &worker->result;
+    // 游戏
+    Game *game = CreateGame();
+    // 批序号、对局序号、批的终点
+    uint64_t batch, index, end;
+    // 一局的步数、猜测步数，一批的步数
+    long long moves, guesses, batch_moves;
+    // 一批的开始时间、耗时
+    double start, seconds;
+
+    if (! game) {
+        return NULL;
+    }
+
+    while (TakeBatch(worker, &batch) || (StealBatches(worker) && TakeBatch(worker, &batch))) {
+        index = batch * SIMULATION_BATCH_SIZE;
+        end = index + SIMULATION_BATCH_SIZE;
+        if (end > (uint64_t)options->number_of_games) {
+            end = (uint64_t)options->number_of_games;
+        }
+
+        batch_moves = 0;
+        start = Now();
+        for (; index < end; index++) {
+            result->number_of_wins += PlayGame(game, worker, options->seed + index, &moves, &guesses);
+            result->number_of_games++;
+            result->number_of_guesses += guesses;
+            result->guess_squares += (double)guesses * (double)guesses;
+            batch_moves += moves;
+        }
+        seconds = Now() - start;
+
+        result->number_of_moves += batch_moves;
+        result->number_of_batches++;
+        result->batch_seconds += seconds;
+        result->move_squares += (double)batch_moves * (double)batch_moves;
+        result->second_squares += seconds * seconds;
+        result->move_seconds += (double)batch_moves * seconds;
+    }
+
+    if (game->map) {
+        DestroyMap(&game->map);
+    }
+    DestroyGame(&game);
+
+    return NULL;
+}
+
+/**
+ * 运行模拟
+ *
+ * 主线程也作为一个工作线程参与对局
+ *
+ * @param options           模拟参数，线程数小于1时使用处理器核心数
+ * @param result            统计指针
+ * @return                  是否成功：参数无效、批数超过32位或内存不足时失败
+ */
+_Bool RunSimulation(const SimulationOptions *options, SimulationResult *result) {
+    // 实际使用的参数
+    SimulationOptions actual = *options;
+    // 工作线程
+    SimulationWorker *workers;
+    // 线程表
+    pthread_t *threads;
+    // 置换表
+    TranspositionCache *cache = NULL;
+    // 已创建的线程数
+    int created = 0;
+    // 线程序号
+    int i;
+    // 批数
+    uint64_t batches;
+    // 开始时间
+    double start;
+
+    if (actual.number_of_games < 1 || ! IsValidGameSize(actual.rows, actual.columns, actual.mines)) {
+        return 0;
+    }
+    batches = ((uint64_t)actual.number_of_games + SIMULATION_BATCH_SIZE - 1) / SIMULATION_BATCH_SIZE;
+    if (batches > 0xFFFFFFFFULL) {
+        return 0;
+    }
+    if (actual.threads < 1) {
+        actual.threads = NumberOfProcessors();
+    }
+    if ((uint64_t)actual.threads > batches) {
+        actual.threads = (int)batches;
+    }
+
+    workers = (SimulationWorker *)aligned_alloc(_Alignof(SimulationWorker),
+                                                sizeof(SimulationWorker) * (size_t)actual.threads);
+    threads = (pthread_t *)malloc(sizeof(pthread_t) * (size_t)actual.threads);
+    if (actual.cache_size > 0) {
+        cache = CreateTranspositionCache(actual.cache_size);
+    }
+    if (! workers || ! threads || (actual.cache_size > 0 && ! cache)) {
+        free(workers);
+        free(threads);
+        if (cache) {
+            DestroyTranspositionCache(&cache);
+        }
+        return 0;
+    }
+
+    // 批平均分给各线程
+    for (i = 0; i < actual.threads; i++) {
+        atomic_init(&workers[i].range, PackRange(batches * (uint64_t)i / (uint64_t)actual.threads,
+                                                 batches * (uint64_t)(i + 1) / (uint64_t)actual.threads));
+        workers[i].options = &actual;
+        workers[i].cache = cache;
+        workers[i].workers = workers;
+        workers[i].id = i;
+        workers[i].result = (SimulationResult){0};
+    }
+
+    start = Now();
+    for (i = 1; i < actual.threads; i++) {
+        if (pthread_create(&threads[created], NULL, SimulationWorkerMain, &workers[i]) == 0) {
+            created++;
+        }
+    }
+    SimulationWorkerMain(&workers[0]);
+    for (i = 0; i < created; i++) {
+        pthread_join(threads[i], NULL);
+    }
+
+    // 汇总各线程的统计
+    *result = (SimulationResult){0};
+    result->seconds = Now() - start;
+    result->threads = created + 1;
+    for (i = 0; i < actual.threads; i++) {
+        result->number_of_games += workers[i].result.number_of_games;
+        result->number_of_wins += workers[i].result.number_of_wins;
+        result->number_of_guesses += workers[i].result.number_of_guesses;
+        result->guess_squares += workers[i].result.guess_squares;
+        result->number_of_moves += workers[i].result.number_of_moves;
+        result->number_of_batches += workers[i].result.number_of_batches;
+        result->batch_seconds += workers[i].result.batch_seconds;
+        result->move_squares += workers[i].result.move_squares;
+        result->second_squares += workers[i].result.second_squares;
+        result->move_seconds += workers[i].result.move_seconds;
+        result->number_of_cache_hits += workers[i].result.number_of_cache_hits;
+        result->number_of_cache_misses += workers[i].result.number_of_cache_misses;
+    }
+
+    free(workers);
+    free(threads);
+    if (cache) {
+        DestroyTranspositionCache(&cache);
+    }
+
+    // 某局内存不足时可能有对局未完成
+    return result->number_of_games == actual.number_of_games;
+}
+
+/**
+ * 输出模拟结果及95%置信区间
+ *
+ * 胜率用Wilson区间；每局猜测步数用正态近似；
+ * 速度按各批的步数与耗时之比估计（比率估计量），其相对误差用于总速度
+ *
+ * @param file              输出文件
+ * @param options           模拟参数
+ * @param result            统计指针
+ */
+void PrintSimulationResult(FILE *file, const SimulationOptions *options, const SimulationResult *result) {
+    // 对局数、批数
+    double n = (double)result->number_of_games, batches = (double)result->number_of_batches;
+    // 胜率及其区间的中心、半宽
+    double rate = n > 0 ? (double)result->number_of_wins / n : 0, center, half;
+    // 每局猜测步数的均值、方差
+    double mean = n > 0 ? (double)result->number_of_guesses / n : 0, variance;
+    // 单线程速度、其残差平方和、相对标准误差，总速度
+    double speed, residual, relative, total_speed;
+    // 正态分位数的平方
+    double z2 = SIMULATION_Z * SIMULATION_Z;
+
+    fprintf(file, "simulation rows=%d columns=%d mines=%d games=%lld seed=%llu threads=%d seconds=%.3f\n",
+            options->rows, options->columns, options->mines, result->number_of_games,
+            (unsigned long long)options->seed, result->threads, result->seconds);
+    if (n <= 0) {
+        return;
+    }
+
+    center = (rate + z2 / (2 * n)) / (1 + z2 / n);
+    half = SIMULATION_Z * sqrt(rate * (1 - rate) / n + z2 / (4 * n * n)) / (1 + z2 / n);
+    fprintf(file, "wins=%lld win_rate=%.5f ci95=[%.5f,%.5f]\n",
+            result->number_of_wins, rate, center - half, center + half);
+
+    variance = n > 1 ? (result->guess_squares - n * mean * mean) / (n - 1) : 0;
+    half = SIMULATION_Z * sqrt(variance > 0 ? variance / n : 0);
+    fprintf(file, "guesses_per_game=%.4f ci95=[%.4f,%.4f]\n", mean, mean - half, mean + half);
+
+    total_speed = result->seconds > 0 ? (double)result->number_of_moves / result->seconds : 0;
+    relative = 0;
+    if (batches > 1 && result->batch_seconds > 0 && result->number_of_moves > 0) {
+        speed = (double)result->number_of_moves / result->batch_seconds;
+        residual = result->move_squares - 2 * speed * result->move_seconds + speed * speed * result->second_squares;
+        relative = sqrt((residual > 0 ? residual : 0) / (batches - 1) / batches)
+                   / (result->batch_seconds / batches) / speed;
+    }
+    fprintf(file, "moves=%lld moves_per_second=%.0f ci95=[%.0f,%.0f] games_per_second=%.1f\n",
+            result->number_of_moves, total_speed,
+            total_speed * (1 - SIMULATION_Z * relative), total_speed * (1 + SIMULATION_Z * relative),
+            result->seconds > 0 ? n / result->seconds : 0);
+    if (options->cache_size > 0) {
+        fprintf(file, "cache_hits=%lld cache_misses=%lld\n", result->number_of_cache_hits, result->number_of_cache_misses);
+    }
+}
@@ -0,0 +1,89 @@
+/**
+ * ----------------------------------------------------------------------------
+ * [头文件] 模拟
+ * ----------------------------------------------------------------------------
+ *
+ * 定义多线程批量对局模拟的数据结构和函数原型
+ *
+ * 每局游戏使用自己的种子和地图：第一步翻开地图中心（中心是地雷时按由种子导出的种子重新散布，第一步总是安全），之后反复运行解机，
+ * 解机推不出确定的步时按概率计算器给出的最安全方块猜一步，直到游戏结束。
+ * 猜测的方块只取决于可见局面，按地图的散列值缓存在各线程共用的置换表中，局面重复时不再计算概率。
+ * 对局按批分配给工作线程，线程做完自己的批后从其他线程窃取剩余批的一半。
+ *
+ */
+
+
+#ifndef MINESWEEPING_SIMULATION_H
+#define MINESWEEPING_SIMULATION_H
+
+#include <stdio.h>
+#include <stddef.h>
+#include <stdint.h>
+
+/*
+ * 宏定义
+ */
+
+// 每批的对局数：工作线程每次领取或窃取的最小单位
+#define SIMULATION_BATCH_SIZE 16
+// 猜测结果在置换表中的标记，异或进地图的散列值作为键
+#define SIMULATION_TRANSPOSITION_TAG 0x53494D554C415445ULL
+
+/*
+ * 数据结构定义
+ */
+
+// 结构体：模拟参数
+typedef struct {
+    // 行数
+    int rows;
+    // 列数
+    int columns;
+    // 地雷数
+    int mines;
+    // 对局数
+    long long number_of_games;
+    // 第一局的种子，第i局（从0开始）使用 种子 + i
+    uint64_t seed;
+    // 工作线程数
+    int threads;
+    // 置换表的表项数，为0时不使用置换表
+    size_t cache_size;
+} SimulationOptions;
+
+// 结构体：模拟统计
+typedef struct {
+    // 对局数
+    long long number_of_games;
+    // 胜利局数
+    long long number_of_wins;
+    // 猜测步数之和（不含第一步）
+    long long number_of_guesses;
+    // 每局猜测步数的平方和
+    double guess_squares;
+    // 走的步数之和（翻开和插旗，含第一步）
+    long long number_of_moves;
+    // 批数
+    long long number_of_batches;
+    // 各批耗时之和（秒，线程各自计时）
+    double batch_seconds;
+    // 各批步数的平方和、耗时的平方和、步数与耗时的积之和，用于估计速度的置信区间
+    double move_squares, second_squares, move_seconds;
+    // 猜测时置换表命中、未命中的次数
+    long long number_of_cache_hits, number_of_cache_misses;
+    // 实际耗时（秒）
+    double seconds;
+    // 实际使用的工作线程数
+    int threads;
+} SimulationResult;
+
+/*
+ * 函数原型
+ */
+
+// 运行模拟
+_Bool RunSimulation(const SimulationOptions *options, SimulationResult *result);
+// 输出模拟结果及95%置信区间
+void PrintSimulationResult(FILE *file, const SimulationOptions *options, const SimulationResult *result);
+
+#endif //MINESWEEPING_SIMULATION_H
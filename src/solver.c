@@ -0,0 +1,551 @@
+/**
+ * ----------------------------------------------------------------------------
+ * [源文件] 解机
+ * ----------------------------------------------------------------------------
+ *
+ * 定义约束传播自动求解器的各个函数
+ *
+ * 每个已翻开的数字给出一条约束：周围未翻开的方块中恰好有（数字 - 周围已推出的地雷数）个地雷。
+ * 只有解机自己推出的地雷才被减去，玩家插的旗标与未翻开的方块相同，插错时不会推出错误的结果。
+ * 解机只检查约束可能发生变化的数字：初始时检查全部数字，之后从变更日志中取出
+ * 状态改变的方块，只重新检查它本身及其周围的数字，不再扫描整个地图。
+ *
+ */
+
+
+#include <stdlib.h>
+
+#include "solver.h"
+#include "pattern.h"
+
+
+/*
+ * 宏定义
+ */
+
+// 推理窗口边长：以当前数字为中心7 x 7个方块，
+// 可以容纳距离不超过2的另一个数字周围的全部方块
+#define SOLVER_WINDOW_SIZE    7
+// 推理窗口中心的位置
+#define SOLVER_WINDOW_CENTER  (SOLVER_WINDOW_SIZE / 2)
+// 推理窗口中相对位置对应的位
+#define SOLVER_WINDOW_BIT(row_offset, column_offset) \
+    ((uint64_t)1 << (((row_offset) + SOLVER_WINDOW_CENTER) * SOLVER_WINDOW_SIZE + (column_offset) + SOLVER_WINDOW_CENTER))
+
+/**
+ * 周围8个方块的行偏移量，顺序与地图的邻居下标偏移量相同
+ */
+static const int NEIGHBOR_ROW_OFFSETS[8] = {-1, -1, -1, 0, 0, 1, 1, 1};
+
+/**
+ * 周围8个方块的列偏移量，顺序与地图的邻居下标偏移量相同
+ */
+static const int NEIGHBOR_COLUMN_OFFSETS[8] = {-1, 0, 1, -1, 1, -1, 0, 1};
+
+/**
+ * 数字约束：推理窗口中未翻开的方块集合及其中剩余的地雷数
+ */
+typedef struct {
+    // 未翻开（含旗标、疑问标）且未推出是地雷的方块的位掩码
+    uint64_t unknown;
+    // 剩余地雷数
+    int remaining;
+} Constraint;
+
+
+/**
+ * 将一个下标压入栈
+ *
+ * 栈满时扩容为原来的2倍
+ *
+ * @param stack             栈内存指针的指针
+ * @param length            栈中元素数指针
+ * @param capacity          栈容量指针
+ * @param index             方块在方块表中的下标
+ * @return                  是否压入成功
+ */
+static _Bool PushIndex(int **stack, int *length, int *capacity, int index) {
+    // 新容量
+    int new_capacity;
+    // 新的栈内存
+    int *new_stack;
+
+    if (*length == *capacity) {
+        new_capacity = *capacity ? *capacity * 2 : 256;
+        new_stack = (int *)realloc(*stack, sizeof(int) * (size_t)new_capacity);
+        if (! new_stack) {
+            return 0;
+        }
+        *stack = new_stack;
+        *capacity = new_capacity;
+    }
+
+    (*stack)[(*length)++] = index;
+
+    return 1;
+}
+
+/**
+ * 将一个方块压入待检查栈
+ *
+ * 只有已翻开的数字方块才会入栈，已在栈中的方块不重复入栈，内存不足时放弃这个方块
+ *
+ * @param solver            解机指针
+ * @param index             方块在方块表中的下标
+ */
+static void PushBlock(Solver *solver, int index) {
+    // 方块
+    Block block = solver->game->map->blocks[index];
+
+    if ((solver->is_queued[index] & 1) || BLOCK_STATUS_OF(block) != BLOCK_STATUS_VISIBLE
+        || BLOCK_TYPE_OF(block) == BLOCK_TYPE_BLANK || BLOCK_TYPE_OF(block) == BLOCK_TYPE_MINE) {
+        return;
+    }
+
+    if (PushIndex(&solver->stack, &solver->stack_length, &solver->stack_capacity, index)) {
+        solver->is_queued[index] |= 1;
+    }
+}
+
+/**
+ * 将一个数字方块压入延后栈
+ *
+ * @param solver            解机指针
+ * @param index             方块在方块表中的下标
+ */
+static void DeferBlock(Solver *solver, int index) {
+    if (solver->is_queued[index] & 2) {
+        return;
+    }
+
+    if (PushIndex(&solver->deferred, &solver->deferred_length, &solver->deferred_capacity, index)) {
+        solver->is_queued[index] |= 2;
+    }
+}
+
+/**
+ * 创建解机
+ *
+ * 启用地图的变更日志，并把当前全部已翻开的数字放入待检查栈
+ *
+ * @param game              游戏指针，地图必须已创建
+ * @return                  分配的内存地址
+ */
+Solver * CreateSolver(Game *game) {
+    // 解机指针
+    Solver *solver;
+    // 地图指针
+    Map *map = game->map;
+    // 行下标（方块表中，含哨兵行）
+    int row;
+    // 列下标（方块表中，含哨兵列）
+    int column;
+
+    solver = (Solver *)malloc(sizeof(Solver));
+    if (! solver) {
+        return NULL;
+    }
+
+    solver->game = game;
+    solver->stack = NULL;
+    solver->stack_length = 0;
+    solver->stack_capacity = 0;
+    solver->deferred = NULL;
+    solver->deferred_length = 0;
+    solver->deferred_capacity = 0;
+    solver->linear = NULL;
+    solver->number_of_linear_passes = 0;
+    solver->number_of_reveals = 0;
+    solver->number_of_flags = 0;
+    solver->is_queued = (uint8_t *)calloc((size_t)(map->number_of_rows + 2) * (size_t)map->stride, sizeof(uint8_t));
+    solver->known_mines = (uint8_t *)calloc((size_t)(map->number_of_rows + 2) * (size_t)map->stride, sizeof(uint8_t));
+    if (! solver->is_queued || ! solver->known_mines || ! EnableJournal(map)) {
+        free(solver->is_queued);
+        free(solver->known_mines);
+        free(solver);
+        return NULL;
+    }
+    solver->journal_position = map->journal_length;
+    // 创建时尚未推理过，保证第一次停滞时会做一次线性方程组推理
+    solver->linear_position = (size_t)-1;
+
+    // 哨兵方块标记为已在两个栈中
+    for (column = 0; column < map->stride; column++) {
+        solver->is_queued[column] = 3;
+        solver->is_queued[(size_t)(map->number_of_rows + 1) * map->stride + column] = 3;
+    }
+    for (row = 1; row <= map->number_of_rows; row++) {
+        solver->is_queued[(size_t)row * map->stride] = 3;
+        solver->is_queued[(size_t)row * map->stride + map->stride - 1] = 3;
+    }
+
+    // 当前已翻开的数字全部需要检查
+    for (row = 1; row <= map->number_of_rows; row++) {
+        for (column = 1; column <= map->number_of_columns; column++) {
+            PushBlock(solver, row * map->stride + column);
+        }
+    }
+
+    return solver;
+}
+
+/**
+ * 销毁解机
+ *
+ * 变更日志可能还有其他使用者，因此保持启用，随地图一起释放
+ *
+ * @param solver            解机指针的指针
+ */
+void DestroySolver(Solver **solver) {
+    free((*solver)->stack);
+    free((*solver)->deferred);
+    free((*solver)->is_queued);
+    free((*solver)->known_mines);
+    if ((*solver)->linear) {
+        DestroyLinearSystem(&(*solver)->linear);
+    }
+    free(*solver);
+    *solver = NULL;
+}
+
+/**
+ * 读取变更日志中的新记录，把状态改变的方块及其周围的数字放入待检查栈
+ *
+ * @param solver            解机指针
+ */
+static void ConsumeJournal(Solver *solver) {
+    // 地图指针
+    Map *map = solver->game->map;
+    // 方块下标
+    int index;
+    // 邻居序号
+    int k;
+
+    for (; solver->journal_position < map->journal_length; solver->journal_position++) {
+        index = map->journal[solver->journal_position].index;
+        PushBlock(solver, index);
+        for (k = 0; k < 8; k++) {
+            PushBlock(solver, index + map->neighbor_offsets[k]);
+        }
+    }
+}
+
+/**
+ * 计算一个数字的约束
+ *
+ * 旗标不被当作地雷，只减去解机推出的地雷
+ *
+ * @param solver            解机指针
+ * @param index             数字方块在方块表中的下标
+ * @param row_offset        数字相对于推理窗口中心的行偏移量
+ * @param column_offset     数字相对于推理窗口中心的列偏移量
+ * @param constraint        约束指针
+ * @return                  约束是否与已推出的地雷相容（剩余地雷数不小于0，且不多于未翻开方块数）
+ */
+static _Bool GetConstraint(Solver *solver, int index, int row_offset, int column_offset, Constraint *constraint) {
+    // 地图指针
+    Map *map = solver->game->map;
+    // 邻居序号
+    int k;
+    // 邻居下标
+    int neighbor;
+    // 未翻开方块数
+    int count = 0;
+
+    constraint->unknown = 0;
+    constraint->remaining = BLOCK_TYPE_OF(map->blocks[index]);
+
+    for (k = 0; k < 8; k++) {
+        neighbor = index + map->neighbor_offsets[k];
+        if (BLOCK_STATUS_OF(map->blocks[neighbor]) == BLOCK_STATUS_VISIBLE) {
+            continue;
+        }
+        if (solver->known_mines[neighbor]) {
+            constraint->remaining--;
+        } else {
+            constraint->unknown |= SOLVER_WINDOW_BIT(row_offset + NEIGHBOR_ROW_OFFSETS[k],
+                                                     column_offset + NEIGHBOR_COLUMN_OFFSETS[k]);
+            count++;
+        }
+    }
+
+    return constraint->remaining >= 0 && constraint->remaining <= count;
+}
+
+/**
+ * 记录一个推出的地雷
+ *
+ * 玩家已在这个方块上插旗时不会再产生变更日志，因此直接把周围的数字放入待检查栈
+ *
+ * @param solver            解机指针
+ * @param index             方块在方块表中的下标
+ */
+static void MarkMine(Solver *solver, int index) {
+    // 邻居序号
+    int k;
+
+    if (solver->known_mines[index]) {
+        return;
+    }
+    solver->known_mines[index] = 1;
+    for (k = 0; k < 8; k++) {
+        PushBlock(solver, index + solver->game->map->neighbor_offsets[k]);
+    }
+}
+
+/**
+ * 对推理窗口中的一组方块走棋
+ *
+ * 翻开空白方块可能连带翻开组内的其他方块，已可见或已是目标状态的方块跳过。
+ * 插旗的方块都记为已推出的地雷，玩家已插旗的方块不再重复插旗。
+ *
+ * @param solver            解机指针
+ * @param center            推理窗口中心在方块表中的下标
+ * @param mask              方块的位掩码
+ * @param status            目标状态：可见或旗标
+ */
+static void ApplyMask(Solver *solver, int center, uint64_t mask, BlockStatus status) {
+    // 地图指针
+    Map *map = solver->game->map;
+    // 窗口中的位置
+    int position;
+    // 方块下标
+    int index;
+    // 方块当前状态
+    BlockStatus current;
+
+    while (mask && ! solver->game->is_finished) {
+        position = __builtin_ctzll(mask);
+        mask &= mask - 1;
+
+        index = center + (position / SOLVER_WINDOW_SIZE - SOLVER_WINDOW_CENTER) * map->stride
+                + position % SOLVER_WINDOW_SIZE - SOLVER_WINDOW_CENTER;
+        if (status == BLOCK_STATUS_FLAG) {
+            MarkMine(solver, index);
+        }
+        current = BLOCK_STATUS_OF(map->blocks[index]);
+        if (current == BLOCK_STATUS_VISIBLE || current == status) {
+            continue;
+        }
+
+        PlayMove(solver->game, index / map->stride - 1, index % map->stride - 1, status);
+        if (status == BLOCK_STATUS_VISIBLE) {
+            solver->number_of_reveals++;
+        } else {
+            solver->number_of_flags++;
+        }
+    }
+}
+
+/**
+ * 用局部模式查找表推理两个数字
+ *
+ * A、B的未翻开方块分为只属于A、共有、只属于B三组，按各组的方块数和两者剩余的地雷数查表，
+ * 对结论为全部安全或全部是地雷的组走棋。单个数字的规则是B为空的特例。
+ * 先插旗再翻开，翻开空白方块连带翻开的方块不会与旗标冲突。
+ *
+ * @param solver            解机指针
+ * @param center            推理窗口中心在方块表中的下标
+ * @param a                 数字A的约束指针
+ * @param b                 数字B的约束指针
+ * @return                  是否推出了结果
+ */
+static _Bool ApplyPattern(Solver *solver, int center, const Constraint *a, const Constraint *b) {
+    // 各组的方块
+    uint64_t groups[NUMBER_OF_PATTERN_GROUPS] = {
+        a->unknown & ~b->unknown, a->unknown & b->unknown, b->unknown & ~a->unknown,
+    };
+    // 表项
+    uint8_t entry = PATTERN_TABLE[PATTERN_KEY(a->remaining, __builtin_popcountll(groups[PATTERN_GROUP_ONLY_A]),
+                                              __builtin_popcountll(groups[PATTERN_GROUP_SHARED]), b->remaining,
+                                              __builtin_popcountll(groups[PATTERN_GROUP_ONLY_B]))];
+    // 组序号
+    int group;
+
+    if ((entry & PATTERN_INCONSISTENT) || ! entry) {
+        return 0;
+    }
+
+    for (group = 0; group < NUMBER_OF_PATTERN_GROUPS; group++) {
+        if (PATTERN_RESULT_OF(entry, group) == PATTERN_MINE) {
+            ApplyMask(solver, center, groups[group], BLOCK_STATUS_FLAG);
+        }
+    }
+    for (group = 0; group < NUMBER_OF_PATTERN_GROUPS; group++) {
+        if (PATTERN_RESULT_OF(entry, group) == PATTERN_SAFE) {
+            ApplyMask(solver, center, groups[group], BLOCK_STATUS_VISIBLE);
+        }
+    }
+
+    return 1;
+}
+
+/**
+ * 用单个数字的规则检查一个数字
+ *
+ * 剩余地雷数为0时周围全部安全，等于未翻开方块数时全是地雷，由查找表给出。
+ * 改变的方块会经变更日志使相关的数字重新入栈。
+ *
+ * @param solver            解机指针
+ * @param index             数字方块在方块表中的下标
+ * @return                  是否还有未确定的方块，需要用组合规则检查
+ */
+static _Bool CheckSingle(Solver *solver, int index) {
+    // 当前数字的约束
+    Constraint self;
+    // 空约束
+    Constraint empty = {0, 0};
+
+    if (! GetConstraint(solver, index, 0, 0, &self) || ! self.unknown) {
+        return 0;
+    }
+
+    return ! ApplyPattern(solver, index, &self, &empty);
+}
+
+/**
+ * 用组合规则检查一个数字
+ *
+ * 与距离不超过2、未翻开方块有交集的每个数字查找局部模式，推出结果后立即返回
+ *
+ * @param solver            解机指针
+ * @param index             数字方块在方块表中的下标
+ */
+static void CheckPairs(Solver *solver, int index) {
+    // 地图指针
+    Map *map = solver->game->map;
+    // 当前数字的约束
+    Constraint self;
+    // 另一个数字的约束
+    Constraint other;
+    // 当前数字在方块表中的行、列（含哨兵行、列）
+    int row = index / map->stride, column = index % map->stride;
+    // 另一个数字的相对行、列偏移量
+    int row_offset, column_offset;
+    // 另一个数字的下标
+    int neighbor;
+    // 另一个数字
+    Block block;
+
+    // 延后期间约束可能已经改变
+    if (! GetConstraint(solver, index, 0, 0, &self) || ! self.unknown) {
+        return;
+    }
+
+    for (row_offset = -2; row_offset <= 2; row_offset++) {
+        if (row + row_offset < 1 || row + row_offset > map->number_of_rows) {
+            continue;
+        }
+        for (column_offset = -2; column_offset <= 2; column_offset++) {
+            if (column + column_offset < 1 || column + column_offset > map->number_of_columns
+                || (row_offset == 0 && column_offset == 0)) {
+                continue;
+            }
+
+            neighbor = index + row_offset * map->stride + column_offset;
+            block = map->blocks[neighbor];
+            if (BLOCK_STATUS_OF(block) != BLOCK_STATUS_VISIBLE
+                || BLOCK_TYPE_OF(block) == BLOCK_TYPE_BLANK || BLOCK_TYPE_OF(block) == BLOCK_TYPE_MINE) {
+                continue;
+            }
+            if (! GetConstraint(solver, neighbor, row_offset, column_offset, &other)
+                || ! (other.unknown & self.unknown)) {
+                continue;
+            }
+
+            if (ApplyPattern(solver, index, &self, &other)) {
+                return;
+            }
+        }
+    }
+}
+
+/**
+ * 用线性方程组推理并走棋
+ *
+ * 代价比局部规则高得多，只在局部规则都推不出结果、且上次推理后地图有变化时调用
+ *
+ * @param solver            解机指针
+ * @return                  是否推出了结果
+ */
+static _Bool RunLinearPass(Solver *solver) {
+    // 地图指针
+    Map *map = solver->game->map;
+    // 结果序号
+    int i;
+    // 方块下标
+    int index;
+
+    if (solver->linear_position == map->journal_length) {
+        return 0;
+    }
+    solver->linear_position = map->journal_length;
+
+    if (! solver->linear) {
+        if (! (solver->linear = CreateLinearSystem(map))) {
+            return 0;
+        }
+        // 方程组只减去解机推出的地雷
+        solver->linear->known_mines = solver->known_mines;
+    }
+    SolveLinearSystem(solver->linear);
+    solver->number_of_linear_passes++;
+
+    // 先插旗再翻开，翻开空白方块连带翻开的方块不会与旗标冲突
+    for (i = 0; i < solver->linear->number_of_mine_blocks && ! solver->game->is_finished; i++) {
+        index = solver->linear->mine_blocks[i];
+        MarkMine(solver, index);
+        if (BLOCK_STATUS_OF(map->blocks[index]) != BLOCK_STATUS_FLAG) {
+            PlayMove(solver->game, index / map->stride - 1, index % map->stride - 1, BLOCK_STATUS_FLAG);
+            solver->number_of_flags++;
+        }
+    }
+    for (i = 0; i < solver->linear->number_of_safe_blocks && ! solver->game->is_finished; i++) {
+        index = solver->linear->safe_blocks[i];
+        if (BLOCK_STATUS_OF(map->blocks[index]) != BLOCK_STATUS_VISIBLE) {
+            PlayMove(solver->game, index / map->stride - 1, index % map->stride - 1, BLOCK_STATUS_VISIBLE);
+            solver->number_of_reveals++;
+        }
+    }
+
+    return solver->linear->number_of_mine_blocks + solver->linear->number_of_safe_blocks > 0;
+}
+
+/**
+ * 反复推理并走棋，直到推不出新的结果
+ *
+ * 先用开销小的单个数字的规则处理完待检查栈，推不出结果的数字延后，
+ * 待检查栈空时才对延后的数字应用组合规则，两者都推不出结果时再做线性方程组推理。
+ * 每一步都通过走一步流程完成，游戏结束时立即停止。
+ * 没有已翻开的数字时推不出任何结果，第一步需要由调用者走。
+ *
+ * @param solver            解机指针
+ * @return                  本次走的步数
+ */
+long long RunSolver(Solver *solver) {
+    // 开始时已走的步数
+    long long moves = solver->number_of_reveals + solver->number_of_flags;
+    // 数字方块下标
+    int index;
+
+    ConsumeJournal(solver);
+    while (! solver->game->is_finished) {
+        if (solver->stack_length > 0) {
+            index = solver->stack[--solver->stack_length];
+            solver->is_queued[index] &= ~1;
+            if (CheckSingle(solver, index)) {
+                DeferBlock(solver, index);
+            }
+        } else if (solver->deferred_length > 0) {
+            index = solver->deferred[--solver->deferred_length];
+            solver->is_queued[index] &= ~2;
+            CheckPairs(solver, index);
+        } else if (! RunLinearPass(solver)) {
+            break;
+        }
+
+        ConsumeJournal(solver);
+    }
+
+    return solver->number_of_reveals + solver->number_of_flags - moves;
+}
@@ -0,0 +1,76 @@
+/**
+ * ----------------------------------------------------------------------------
+ * [头文件] 解机
+ * ----------------------------------------------------------------------------
+ *
+ * 定义约束传播自动求解器的数据结构和函数原型
+ *
+ * 解机根据已翻开的数字推出一定安全的方块和一定是地雷的方块，
+ * 通过正常的走一步流程翻开或插旗，直到推不出新的结果为止。
+ * 单个数字和两个数字的规则都推不出结果时，再把整个前沿当作线性方程组消元推理。
+ * 推理只以已翻开的数字和解机自己推出的地雷为前提，玩家的旗标当作未翻开的方块，
+ * 插错的旗标不会使解机翻开地雷；推出一定安全的方块上有旗标时，解机会把它翻开。
+ *
+ */
+
+
+#ifndef MINESWEEPING_SOLVER_H
+#define MINESWEEPING_SOLVER_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include "game.h"
+#include "linear.h"
+
+/*
+ * 数据结构定义
+ */
+
+// 结构体：解机
+typedef struct {
+    // 游戏，解机不拥有游戏，游戏的地图在解机销毁前不能更换
+    Game *game;
+    // 已处理到的变更日志位置
+    size_t journal_position;
+    // 待检查的数字方块下标栈
+    int *stack;
+    // 栈中的元素数
+    int stack_length;
+    // 栈容量（元素数）
+    int stack_capacity;
+    // 单个数字推不出结果、留待组合规则检查的数字方块下标栈
+    int *deferred;
+    // 延后栈中的元素数
+    int deferred_length;
+    // 延后栈容量（元素数）
+    int deferred_capacity;
+    // 每个方块是否已在待检查栈（第0位）、延后栈（第1位）中，
+    // 哨兵方块始终标记为已在两个栈中，因此不会入栈
+    uint8_t *is_queued;
+    // 每个方块是否是解机推出的地雷，按方块表下标存放；玩家插的旗标不会被标记
+    uint8_t *known_mines;
+    // 线性方程组，第一次需要时创建
+    LinearSystem *linear;
+    // 上次线性方程组推理时的变更日志位置，之后没有变更时不再重复推理
+    size_t linear_position;
+    // 线性方程组推理的次数
+    long long number_of_linear_passes;
+    // 解机翻开的方块数
+    long long number_of_reveals;
+    // 解机插的旗标数
+    long long number_of_flags;
+} Solver;
+
+/*
+ * 函数原型
+ */
+
+// 创建解机
+Solver * CreateSolver(Game *game);
+// 销毁解机
+void DestroySolver(Solver **solver);
+// 反复推理并走棋，直到推不出新的结果
+long long RunSolver(Solver *solver);
+
+#endif //MINESWEEPING_SOLVER_H
@@ -0,0 +1,123 @@
+/**
+ * ----------------------------------------------------------------------------
+ * [源文件] 置换表
+ * ----------------------------------------------------------------------------
+ *
+ * 定义置换表的各个函数
+ *
+ * 读写都只用relaxed原子操作：写入时先写数据字再写校验字，
+ * 读取时任何新旧数据字的混合都会使校验失败（除非散列值恰好碰撞），因此不需要锁或内存屏障。
+ *
+ */
+
+
+#include <stdlib.h>
+
+#include "transposition.h"
+
+
+/**
+ * 创建置换表
+ *
+ * @param size              表项数，向上取整为2的幂，为0时使用默认值
+ * @return                  分配的内存地址
+ */
+TranspositionCache * CreateTranspositionCache(size_t size) {
+    // 置换表指针
+    TranspositionCache *cache;
+    // 表项数
+    size_t capacity = 1;
+
+    if (size == 0) {
+        size = TRANSPOSITION_DEFAULT_SIZE;
+    }
+    while (capacity < size) {
+        capacity *= 2;
+    }
+
+    cache = (TranspositionCache *)malloc(sizeof(TranspositionCache));
+    if (! cache) {
+        return NULL;
+    }
+
+    // 全0的原子整数即为0，分配时清零即完成表项的初始化
+    cache->entries = (TranspositionEntry *)calloc(capacity, sizeof(TranspositionEntry));
+    if (! cache->entries) {
+        free(cache);
+        return NULL;
+    }
+    cache->mask = capacity - 1;
+
+    return cache;
+}
+
+/**
+ * 销毁置换表
+ *
+ * 调用前所有线程都必须已经停止使用置换表
+ *
+ * @param cache             置换表指针的指针
+ */
+void DestroyTranspositionCache(TranspositionCache **cache) {
+    free((*cache)->entries);
+    free(*cache);
+    *cache = NULL;
+}
+
+/**
+ * 查找一个局面的结果
+ *
+ * @param cache             置换表指针
+ * @param key               键，为0时总是未命中
+ * @param data              数据字数组，命中时写入保存的结果
+ * @return                  是否命中
+ */
+_Bool ProbeTransposition(TranspositionCache *cache, uint64_t key, uint64_t data[TRANSPOSITION_DATA_WORDS]) {
+    // 表项指针
+    TranspositionEntry *entry = &cache->entries[key & cache->mask];
+    // 校验字
+    uint64_t check;
+    // 数据字序号
+    int i;
+
+    if (key) {
+        check = atomic_load_explicit(&entry->check, memory_order_relaxed);
+        for (i = 0; i < TRANSPOSITION_DATA_WORDS; i++) {
+            data[i] = atomic_load_explicit(&entry->data[i], memory_order_relaxed);
+            check ^= data[i];
+        }
+        if (check == key) {
+            return 1;
+        }
+    }
+
+    return 0;
+}
+
+/**
+ * 保存一个局面的结果
+ *
+ * 直接覆盖同一位置上的旧表项
+ *
+ * @param cache             置换表指针
+ * @param key               键，为0时不保存
+ * @param data              数据字数组
+ */
+void StoreTransposition(TranspositionCache *cache, uint64_t key, const uint64_t data[TRANSPOSITION_DATA_WORDS]) {
+    // 表项指针
+    TranspositionEntry *entry = &cache->entries[key & cache->mask];
+    // 校验字
+    uint64_t check = key;
+    // 数据字序号
+    int i;
+
+    if (! key) {
+        return;
+    }
+
+    for (i = 0; i < TRANSPOSITION_DATA_WORDS; i++) {
+        atomic_store_explicit(&entry->data[i], data[i], memory_order_relaxed);
+        check ^= data[i];
+    }
+    atomic_store_explicit(&entry->check, check, memory_order_relaxed);
+}
@@ -0,0 +1,66 @@
+/**
+ * ----------------------------------------------------------------------------
+ * [头文件] 置换表
+ * ----------------------------------------------------------------------------
+ *
+ * 定义按局面散列值缓存分析结果的置换表的数据结构和函数原型
+ *
+ * 置换表大小固定，按散列值直接映射，冲突时覆盖旧表项。
+ * 多个线程可以不加锁地同时读写：每个表项保存 键 ^ 各数据字 作为校验字，
+ * 读到其他线程写了一半的表项时校验失败，按未命中处理。
+ * 不同种类的结果共用一个置换表时，调用者应把各自的标记异或进键中。
+ * 置换表本身不做统计，命中次数由各线程的调用者自行记录，查找时不写任何共享数据。
+ *
+ */
+
+
+#ifndef MINESWEEPING_TRANSPOSITION_H
+#define MINESWEEPING_TRANSPOSITION_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include <stdatomic.h>
+
+/*
+ * 宏定义
+ */
+
+// 每个表项的数据字数
+#define TRANSPOSITION_DATA_WORDS   3
+// 默认的表项数
+#define TRANSPOSITION_DEFAULT_SIZE (1 << 20)
+
+/*
+ * 数据结构定义
+ */
+
+// 结构体：置换表项
+typedef struct {
+    // 校验字：键与各数据字的异或，全0表示空表项
+    _Atomic uint64_t check;
+    // 数据字
+    _Atomic uint64_t data[TRANSPOSITION_DATA_WORDS];
+} TranspositionEntry;
+
+// 结构体：置换表
+typedef struct {
+    // 表项数组
+    TranspositionEntry *entries;
+    // 表项数 - 1，表项数是2的幂
+    size_t mask;
+} TranspositionCache;
+
+/*
+ * 函数原型
+ */
+
+// 创建置换表
+TranspositionCache * CreateTranspositionCache(size_t size);
+// 销毁置换表
+void DestroyTranspositionCache(TranspositionCache **cache);
+// 查找一个局面的结果
+_Bool ProbeTransposition(TranspositionCache *cache, uint64_t key, uint64_t data[TRANSPOSITION_DATA_WORDS]);
+// 保存一个局面的结果
+void StoreTransposition(TranspositionCache *cache, uint64_t key, const uint64_t data[TRANSPOSITION_DATA_WORDS]);
+
+#endif //MINESWEEPING_TRANSPOSITION_H